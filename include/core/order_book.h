@@ -7,19 +7,52 @@
 #include <iomanip>
 #include <string>
 #include <limits>
+#include <vector>
 
 namespace core {
 
+// A book's resting orders, each level in time priority, and its id
+// counter: enough to rebuild the book in another process.
+struct BookImage {
+    struct Entry {
+        uint64_t orderId;
+        Side side;
+        double price;
+        uint32_t qty;
+    };
+    std::string symbol;
+    uint64_t nextOrderId = 1;
+    std::vector<Entry> orders;
+};
+
 class OrderBook {
 public:
+    // Orders come from a private pool of poolSize...
     explicit OrderBook(const std::string& symbol, size_t poolSize = 100000);
+    // ...or from an arena shared with other books, at most quota live.
+    OrderBook(const std::string& symbol, std::shared_ptr<OrderArena> arena, size_t quota);
 
+    // nullptr, with the book unchanged, when its quota or the arena is full.
     Order* addOrder(Side side, double price, uint32_t qty, uint64_t orderId = 0);
     bool cancelOrder(uint64_t orderId);
-    void matchOrder(Side side, double price, uint32_t qty);
+    // Returns the quantity refused: a remainder there was no room to rest.
+    // The fills before it stand.
+    uint32_t matchOrder(Side side, double price, uint32_t qty);
 
     void printSnapshot(size_t depth = 5) const;
 
+    // Sizes the id index and each side's level table up front, so growth
+    // does not rehash on the first busy seconds.
+    void reserve(size_t orders, size_t levelsPerSide);
+    // Runs synthetic orders through add, match and cancel to fault in and
+    // warm every path, then restores ids and counters: the book is left as
+    // it was. Only an empty book can be warmed; false otherwise.
+    bool shadowWarmUp(size_t orders);
+
+    BookImage image() const;
+    // Drops everything the book holds and loads the image in its place.
+    void restore(const BookImage& image);
+
     const std::unordered_map<double, PriceLevel>& bids() const noexcept { return bids_; }
     const std::unordered_map<double, PriceLevel>& asks() const noexcept { return asks_; }
     const std::unordered_map<uint64_t, Order*>& orderIndex() const noexcept { return orderIndex_; }
@@ -28,12 +61,22 @@ public:
     double bestAsk() const noexcept { return bestAsk_; }
     const std::string& symbol() const noexcept { return symbol_; }
 
+    uint64_t commandCount() const noexcept { return commandCount_; }
+    void noteCommand() noexcept { ++commandCount_; }
+
+    size_t ordersInUse() const noexcept { return orderPool_.inUse(); }
+    size_t poolCapacity() const noexcept { return orderPool_.capacity(); }
+    size_t poolQuota() const noexcept { return orderPool_.quota(); }
+    // Returns spare chunks to the arena once the book holds no orders.
+    void trimPool() { orderPool_.trim(); }
+
     const std::vector<TradeEvent>& getTradeEvents() const noexcept { return tradeEvents_; }
     void clearTradeEvents() noexcept { tradeEvents_.clear(); }
 
 private:
     std::string symbol_;
     uint64_t nextOrderId_ = 1;
+    uint64_t commandCount_ = 0;
     OrderPool orderPool_;
 
     std::unordered_map<double, PriceLevel> bids_;
@@ -43,6 +86,7 @@ private:
 
     double bestBid_ = 0.0;
     double bestAsk_ = std::numeric_limits<double>::max();
+    bool shadow_ = false;   // synthetic orders are not logged
 
     void updateBestPrices();
     void executeTrade(Order* taker, Order* maker, uint32_t tradedQty, double tradePrice);
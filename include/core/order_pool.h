@@ -1,34 +1,97 @@
 #pragma once
 #include "core/order.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <stack>
-#include <stdexcept>
 
 namespace core {
 
+// Order storage shared by every book of an engine, handed out in chunks.
+// A book holds only the chunks its live orders need, so quiet symbols cost
+// one chunk and busy ones borrow what the others are not using. Chunks
+// are taken and returned off the per-order path, so a mutex is enough;
+// books on other engines (after a migration) may still use it.
+class OrderArena {
+public:
+    static constexpr size_t CHUNK_ORDERS = 64;
+
+    // maxOrders is rounded up to whole chunks; 0 means no limit.
+    explicit OrderArena(size_t maxOrders = 0);
+
+    OrderArena(const OrderArena&) = delete;
+    OrderArena& operator=(const OrderArena&) = delete;
+
+    // CHUNK_ORDERS orders, or nullptr once the arena is at its limit.
+    Order* acquireChunk();
+    void releaseChunk(Order* chunk);
+
+    size_t chunksInUse() const;
+    size_t chunksAllocated() const;
+    size_t maxChunks() const noexcept { return maxChunks_; }
+
+private:
+    const size_t maxChunks_;
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<Order[]>> chunks_;
+    std::vector<Order*> freeChunks_;
+};
+
+// A book's orders. Grows a chunk at a time from its arena up to quota
+// orders; freed orders go on an intrusive free list through Order::next.
 class OrderPool {
 public:
-    explicit OrderPool(size_t capacity = 100000) {
-        orderPool_.resize(capacity);
-        for (size_t i = 0; i < capacity; ++i) freeList_.push(&orderPool_[i]);
+    // Standalone: a private arena, no more than quota orders.
+    explicit OrderPool(size_t quota = 100000)
+        : OrderPool(std::make_shared<OrderArena>(quota), quota) {}
+
+    OrderPool(std::shared_ptr<OrderArena> arena, size_t quota)
+        : arena_(std::move(arena)), quota_(quota) {}
+
+    ~OrderPool() {
+        for (Order* chunk : chunks_) arena_->releaseChunk(chunk);
     }
 
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // nullptr once quota orders are live or the arena has no chunk left.
     Order* allocate() {
-        if (freeList_.empty()) throw std::runtime_error("OrderPool exhausted");
-        Order* order = freeList_.top();
-        freeList_.pop();
+        if (inUse_ >= quota_) return nullptr;
+        if (!freeList_ && !grow()) return nullptr;
+        Order* order = freeList_;
+        freeList_ = order->next;
+        order->next = nullptr;
+        ++inUse_;
         return order;
     }
 
     void deallocate(Order* order) {
-        order->next = nullptr;
         order->prev = nullptr;
-        freeList_.push(order);
+        order->next = freeList_;
+        freeList_ = order;
+        --inUse_;
     }
 
+    // Hands every chunk but one back to the arena; only while empty.
+    void trim();
+
+    size_t quota() const noexcept { return quota_; }
+    // Orders backed by chunks this pool holds.
+    size_t capacity() const noexcept { return chunks_.size() * OrderArena::CHUNK_ORDERS; }
+    size_t inUse() const noexcept { return inUse_; }
+    size_t chunkCount() const noexcept { return chunks_.size(); }
+
 private:
-    std::vector<Order> orderPool_;
-    std::stack<Order*> freeList_;
+    bool grow();
+    void linkChunk(Order* chunk);
+
+    std::shared_ptr<OrderArena> arena_;
+    size_t quota_;
+    std::vector<Order*> chunks_;
+    Order* freeList_ = nullptr;
+    size_t inUse_ = 0;
 };
 
-}
\ No newline at end of file
+}
@@ -4,9 +4,21 @@
 
 namespace dispatch {
 
+// Identifies the client connection a message came from; see
+// net::ConnectionRegistry. Never reused for another connection.
+using SessionId = uint64_t;
+constexpr SessionId INVALID_SESSION = 0;
+
+// Wire format of the connection a message came from; reports go back in it.
+enum class WireProtocol : uint8_t {
+    JSON,
+    BINARY
+};
+
 enum class MsgType {
     NEW_ORDER,
     CANCEL_ORDER,
+    MODIFY_ORDER,
     QUERY_ORDER,
     TRADE_REPORT,
     CANCEL_REPORT,
@@ -15,7 +27,8 @@ enum class MsgType {
 };
 
 struct DispatchMsg {
-    int fd = -1;
+    SessionId sessionId = INVALID_SESSION;
+    WireProtocol protocol = WireProtocol::JSON;
     MsgType type = MsgType::UNKNOWN;
     std::string symbol;
     core::Side side = core::Side::BUY;
@@ -3,16 +3,21 @@
 #include <atomic>
 #include <thread>
 #include <functional>
+#include <mutex>
+#include <vector>
 #include "concurrentqueue/concurrentqueue.h"
 #include "core/order.h"
 #include "dispatch/dispatch_msg.h"
 #include "engine/matching_engine.h"
+#include "utils/metrics.h"
 
 namespace dispatch {
 
 class Dispatcher {
 public:
-    using SendFunc = std::function<bool(int fd, const std::string& payload)>;
+    using SendFunc = std::function<bool(SessionId session, const std::string& payload)>;
+    using FlushFunc = std::function<void()>;
+    using ReliefFunc = std::function<void(engine::MatchingEngine* engine)>;
 
     explicit Dispatcher(size_t queueCapacity = 1024);
     ~Dispatcher();
@@ -21,23 +26,55 @@ public:
     Dispatcher& operator=(const Dispatcher&) = delete;
 
     void setSender(SendFunc sender) { sender_ = std::move(sender); }
+    // Runs once per dispatch pass, after every ready engine was drained, so
+    // a sender that buffers can write each connection's reports together.
+    void setFlusher(FlushFunc flusher) { flusher_ = std::move(flusher); }
 
-    bool routeInbound(DispatchMsg&& msg);
+    // target, when given, receives the engine the symbol routes to, so a
+    // producer can check its backpressure state; false with a non-null
+    // target means the engine's queue was full and msg was not taken.
+    bool routeInbound(DispatchMsg&& msg, engine::MatchingEngine** target = nullptr);
+
+    // Runs on the dispatcher thread after an attached engine's inbound
+    // backlog drops back under the low watermark; the engine only queues
+    // the event. Returns an id for removal.
+    size_t addReliefListener(ReliefFunc listener);
+    void removeReliefListener(size_t id);
 
     void startDispatcher();
     void stopDispatcher();
 
     void attachEngine(engine::MatchingEngine* engine);
 
+    uint64_t notifications() const noexcept { return notifications_.load(std::memory_order_relaxed); }
+
 private:
     void dispatchLoop();
     void processOutbound(engine::MatchingEngine& eng);
+    void notifyRelief(engine::MatchingEngine* engine);
+    void registerMetrics();
+    static int nextInstanceId();
 
 private:
+    const int id_{nextInstanceId()};
     moodycamel::ConcurrentQueue<engine::MatchingEngine*> readyEngines_;
+    moodycamel::ConcurrentQueue<engine::MatchingEngine*> relievedEngines_;
     std::thread loopThread_;
     std::atomic<bool> running_{false};
+    std::atomic<uint64_t> notifications_{0};
     SendFunc sender_;
+    FlushFunc flusher_;
+    std::string encodeBuf_;
+
+    std::mutex reliefMtx_;
+    std::vector<std::pair<size_t, ReliefFunc>> reliefListeners_;
+    size_t nextReliefId_ = 1;
+
+    utils::Counter routed_;
+    utils::Counter routeFailed_;
+    utils::Counter reports_;
+    utils::Counter sendFailed_;
+    utils::MetricsScope metrics_;
 };
 
 }
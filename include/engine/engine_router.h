@@ -1,5 +1,6 @@
 #pragma once
 #include "engine/matching_engine.h"
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <mutex>
@@ -15,10 +16,16 @@ public:
     MatchingEngine* route(const std::string& symbol);
 
 private:
-    EngineRouter() = default;
+    using RouteTable = std::unordered_map<std::string, MatchingEngine*>;
 
-    std::unordered_map<std::string, MatchingEngine*> routeTable_;
-    std::mutex mutex_;
+    EngineRouter();
+    ~EngineRouter();
+
+    // Immutable snapshot, replaced wholesale on every bind. Readers never lock;
+    // the previous table is freed after an RCU grace period.
+    std::atomic<const RouteTable*> routeTable_;
+    std::atomic<uint64_t> version_{0};
+    std::mutex writeMutex_;
 };
 
 }
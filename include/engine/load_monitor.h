@@ -0,0 +1,59 @@
+#pragma once
+#include "engine/matching_engine.h"
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+struct MigrationSuggestion {
+    std::string symbol;
+    MatchingEngine* from = nullptr;
+    MatchingEngine* to = nullptr;
+    double fromUtilization = 0.0;
+    double toUtilization = 0.0;
+};
+
+class LoadMonitor {
+public:
+    struct Options {
+        double highUtilization = 0.80;
+        double minImbalance = 0.30;
+        std::chrono::milliseconds interval{1000};
+        bool autoMigrate = false;
+    };
+
+    LoadMonitor(std::vector<MatchingEngine*> engines, Options opts);
+    explicit LoadMonitor(std::vector<MatchingEngine*> engines)
+        : LoadMonitor(std::move(engines), Options{}) {}
+    ~LoadMonitor();
+
+    // Takes one utilization sample since the previous call and returns the
+    // move that best narrows the gap between the hottest and coldest engine.
+    std::optional<MigrationSuggestion> sample();
+
+    void startMonitor();
+    void stopMonitor();
+
+    const std::vector<double>& utilization() const noexcept { return utilization_; }
+
+private:
+    void monitorLoop();
+
+    std::vector<MatchingEngine*> engines_;
+    Options opts_;
+
+    std::chrono::steady_clock::time_point lastSample_;
+    std::vector<uint64_t> lastBusy_;
+    std::vector<double> utilization_;
+    std::unordered_map<std::string, uint64_t> lastCommands_;
+
+    std::thread monitorThread_;
+    std::atomic<bool> running_{false};
+};
+
+}
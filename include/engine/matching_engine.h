@@ -4,53 +4,227 @@
 #include <thread>
 #include <atomic>
 #include <functional>
-#include <boost/lockfree/spsc_queue.hpp>
+#include <future>
+#include <mutex>
+#include <vector>
 #include "core/order_book.h"
 #include "dispatch/dispatch_msg.h"
 #include "concurrentqueue/concurrentqueue.h"
+#include "utils/lock_free_queue.h"
 #include "utils/logger.h"
+#include "utils/metrics.h"
 
 namespace engine {
 
+// The default implicit-producer block index (32 blocks) caps every producer
+// at 1024 queued items when enqueueing without allocation, well below the
+// configured capacity.
+struct EngineQueueTraits : moodycamel::ConcurrentQueueDefaultTraits {
+    static const size_t IMPLICIT_INITIAL_INDEX_SIZE = 256;
+};
+
+struct SymbolLoad {
+    std::string symbol;
+    uint64_t commands = 0;
+};
+
 class MatchingEngine {
 public:
     static constexpr size_t LAT_BUF = 1 << 20;
+    // Bounded drains a migration fence waits through before it settles for
+    // whatever was queued when it ran out.
+    static constexpr int FENCE_RETRIES = 8;
+    // Warm-up sizes each book's order index for its quota, up to this.
+    static constexpr size_t WARMUP_INDEX_LIMIT = 1 << 16;
+
+    using CommandSink = std::function<void(uint64_t seq, const dispatch::DispatchMsg& msg)>;
+    using BookImages = std::vector<core::BookImage>;
+    using SnapshotSink = std::function<void(uint64_t seq, BookImages&& books)>;
 
+    // maxOrders caps the order storage shared by all of this engine's
+    // books; 0 leaves only the per-symbol quotas.
     explicit MatchingEngine(size_t inboundCap = 4096,
-                            size_t outboundCap = 4096)
-        : inboundQueue_(inboundCap),
-          outboundQueue_(outboundCap) {}
+                            size_t outboundCap = 4096,
+                            size_t maxOrders = 0)
+        : arena_(std::make_shared<core::OrderArena>(maxOrders)),
+          inboundQueue_(inboundCap),
+          outboundQueue_(outboundCap),
+          drainLimit_(inboundCap * 4),
+          highWatermark_(inboundCap * 3 / 4),
+          lowWatermark_(inboundCap / 4) { registerMetrics(); }
 
     ~MatchingEngine();
 
     void startEngine();
     void stopEngine();
 
-    bool registerSymbol(const std::string& symbol, size_t poolSize = 100000);
+    // quota: most orders the symbol may have resting at once. Storage is
+    // drawn from the engine's shared arena as the book fills, not up front.
+    bool registerSymbol(const std::string& symbol, size_t quota = 100000);
+    const core::OrderArena& orderArena() const noexcept { return *arena_; }
+
+    // Warm-up before traffic: the matching thread sizes every book's tables
+    // and runs shadowOrders synthetic orders through each book, which leave
+    // nothing behind; startEngine() returns only once that is done, and
+    // rethrows, with the engine stopped, if it failed. Off when
+    // shadowOrders is 0. Configure before startEngine().
+    void setWarmup(size_t shadowOrders, size_t levelsPerSide = 1024) {
+        warmupOrders_ = shadowOrders;
+        warmupLevels_ = levelsPerSide;
+    }
 
     bool pushInbound(dispatch::DispatchMsg&& msg);
+
+    // Inbound backpressure. The engine turns congested when a push finds
+    // the backlog at the high watermark (or the queue full), and producers
+    // that honour it stop feeding the engine. Once the matching thread has
+    // worked the backlog down to the low watermark it clears the state and
+    // runs the relief callback, which should only hand the news to another
+    // thread. Configure before startEngine().
+    void setInboundWatermarks(size_t high, size_t low) {
+        highWatermark_ = high;
+        lowWatermark_ = low;
+    }
+    void setInboundReliefCallback(std::function<void()> cb) { inboundReliefCallback_ = std::move(cb); }
+    bool inboundCongested() const noexcept { return inboundCongested_.load(std::memory_order_acquire); }
+
     bool popOutbound(dispatch::DispatchMsg& out);
     bool pushOutbound(const dispatch::DispatchMsg&& msg);
     void handleOrderMessage(dispatch::DispatchMsg&& msg);
     void setOutboundCallback(std::function<void()> cb);
+    // Doorbell: the engine rings once per batch of reports while the flag is
+    // clear; the consumer re-arms it right before draining.
+    bool clearOutboundPending() noexcept {
+        return outboundPending_.exchange(false, std::memory_order_acq_rel);
+    }
+
+    // Every order command is numbered in the order it is applied; the sink
+    // sees it just before it hits the book. Install before startEngine().
+    void setCommandSink(CommandSink sink) { commandSink_ = std::move(sink); }
+    uint64_t lastCommandSeq() const noexcept { return commandSeq_.load(std::memory_order_acquire); }
+
+    // Snapshots, for a backup that cannot be served from the command log.
+    // requestSnapshot() has the matching thread copy every book between two
+    // commands and hand the copy, with the last sequence applied, to the
+    // sink on that thread. restoreSnapshot() replaces the books with such a
+    // copy and numbers commands on from seq; call it once everything pushed
+    // so far is applied. Install the sink before startEngine().
+    void setSnapshotSink(SnapshotSink sink) { snapshotSink_ = std::move(sink); }
+    void requestSnapshot() { snapshotRequested_.store(true, std::memory_order_release); }
+    std::future<void> restoreSnapshot(uint64_t seq, BookImages books);
+
+    // Live migration handshake, driven by migrateSymbol(). Both ends are
+    // reserved first (false / an invalid future while the symbol is already
+    // migrating); the target buffers the symbol once the route flips, and
+    // the fence makes the source hand its OrderBook over after everything
+    // routed to it is applied. cancelIncoming withdraws a reservation no
+    // route points at yet. None of these wait on an inbound queue: the
+    // matching threads pick fences and handed-over books up between batches.
+    bool expectIncoming(const std::string& symbol);
+    void cancelIncoming(const std::string& symbol);
+    std::future<bool> beginMigrateOut(const std::string& symbol, MatchingEngine* target);
+    void fenceMigrateOut(const std::string& symbol);
+
+    uint64_t busyNanos() const noexcept { return busyNs_.load(std::memory_order_relaxed); }
+    std::vector<SymbolLoad> symbolLoads() const;
 
     void recordLatency(uint64_t ns);
     std::vector<uint64_t> collectLatency() const;
     std::atomic<uint64_t> inboundProcessed_{0};
 
 private:
+    using BookMap = std::unordered_map<std::string, core::OrderBook>;
+
+    struct IncomingBook {
+        bool ready = false;
+        BookMap::node_type node;
+        std::vector<dispatch::DispatchMsg> buffered;
+    };
+
+    struct PendingRestore {
+        uint64_t seq = 0;
+        BookImages books;
+        std::promise<void> done;
+    };
+
+    struct OutgoingBook {
+        MatchingEngine* target = nullptr;
+        std::promise<bool> done;
+        bool fenced = false;
+        // Set once a batch has started after the fence; only such a batch
+        // running the queue dry proves nothing routed here is left.
+        bool observed = false;
+        int retries = 0;
+    };
+
+    void warmUp();
     void matchingLoop();
+    void processInbound(dispatch::DispatchMsg&& msg);
     void handleNewOrder(const dispatch::DispatchMsg& msg, core::OrderBook& ob);
-    void handleCancelOrder(const dispatch::DispatchMsg& msg, core::OrderBook& ob);
+    bool handleCancelOrder(const dispatch::DispatchMsg& msg, core::OrderBook& ob);
+    void handleModifyOrder(const dispatch::DispatchMsg& msg, core::OrderBook& ob);
+    void serviceFences(bool drained);
+    void handOver(const std::string& symbol, bool finalDrain);
+    void adoptReadyIncoming();
+    void adoptIncoming(const std::string& symbol);
+    bool resolveMigratingSymbol(dispatch::DispatchMsg& msg);
+    void deliverIncoming(const std::string& symbol, BookMap::node_type&& node);
+    void acceptForwarded(dispatch::DispatchMsg&& msg);
+    void takeSnapshot();
+    void applyRestore();
+    void publishLoads();
+    void ringOutboundDoorbell();
+    void checkInboundRelief();
+    void registerMetrics();
+    static int nextInstanceId();
 
 private:
-    std::unordered_map<std::string, core::OrderBook> orderBooks_;
-    moodycamel::ConcurrentQueue<dispatch::DispatchMsg> inboundQueue_;
-    moodycamel::ConcurrentQueue<dispatch::DispatchMsg> outboundQueue_;
+    const int id_{nextInstanceId()};
+    std::shared_ptr<core::OrderArena> arena_;
+    BookMap orderBooks_;
+    moodycamel::ConcurrentQueue<dispatch::DispatchMsg, EngineQueueTraits> inboundQueue_;
+    moodycamel::ConcurrentQueue<dispatch::DispatchMsg, EngineQueueTraits> outboundQueue_;
     std::function<void()> outboundReadyCallback_;
+    std::atomic<bool> outboundPending_{false};
+    CommandSink commandSink_;
+    std::atomic<uint64_t> commandSeq_{0};
+    SnapshotSink snapshotSink_;
+    std::atomic<bool> snapshotRequested_{false};
+    std::mutex restoreMtx_;
+    std::unique_ptr<PendingRestore> restore_;
+    std::atomic<bool> restorePending_{false};
+    bool outboundDirty_ = false;
     std::thread matchingThread_;
     std::atomic<bool> running_{false};
-    mutable boost::lockfree::spsc_queue< uint64_t, boost::lockfree::capacity<LAT_BUF>> latencyQueue_;
+    size_t warmupOrders_ = 0;
+    size_t warmupLevels_ = 1024;
+    mutable utils::SpscQueue<uint64_t> latencyQueue_{LAT_BUF};
+
+    const size_t drainLimit_;
+    size_t highWatermark_;
+    size_t lowWatermark_;
+    std::atomic<bool> inboundCongested_{false};
+    // Fences that found a backlog; producers stay held off meanwhile.
+    size_t fencesWaiting_ = 0;
+    std::atomic<size_t> fencesPending_{0};
+    std::atomic<bool> incomingReady_{false};
+    std::function<void()> inboundReliefCallback_;
+    std::mutex migrationMtx_;
+    std::unordered_map<std::string, IncomingBook> incoming_;
+    std::unordered_map<std::string, OutgoingBook> outgoing_;
+    std::unordered_map<std::string, MatchingEngine*> forwarded_;
+
+    std::atomic<uint64_t> busyNs_{0};
+    mutable std::mutex loadMtx_;
+    std::vector<SymbolLoad> loads_;
+
+    utils::Counter rejected_;
+    utils::Counter trades_;
+    utils::Counter reports_;
+    // Pool occupancy across this engine's books, sampled with the loads.
+    std::atomic<uint64_t> ordersInUse_{0};
+    std::atomic<uint64_t> poolCapacity_{0};
+    utils::MetricsScope metrics_;
 };
 
 }
@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <sys/types.h>
+#include <boost/lockfree/spsc_queue.hpp>
+#include "dispatch/dispatch_msg.h"
+#include "engine/matching_engine.h"
+
+namespace engine {
+
+// One sequenced inbound command on the replication stream. Primary and
+// backup share a host, so records travel in host byte order.
+struct ReplRecord {
+    uint64_t seq;
+    uint64_t orderId;
+    double   price;
+    uint64_t sessionId;
+    uint32_t qty;
+    uint8_t  type;
+    uint8_t  side;
+    uint8_t  protocol;
+    uint8_t  symbolLen;
+    char     symbol[24];
+};
+static_assert(sizeof(ReplRecord) == 64, "ReplRecord must stay one cache line");
+static_assert(std::is_trivially_copyable<ReplRecord>::value, "ReplRecord is sent raw");
+
+// Record types above every MsgType: a snapshot of the primary's books at
+// seq, sent in place of the log a backup is too far behind for. BOOK
+// carries a book's id counter in orderId, ORDER one resting order.
+enum class ReplKind : uint8_t {
+    SNAPSHOT_BEGIN = 0xF0,
+    SNAPSHOT_BOOK,
+    SNAPSHOT_ORDER,
+    SNAPSHOT_END
+};
+static_assert(static_cast<int>(dispatch::MsgType::UNKNOWN) < static_cast<int>(ReplKind::SNAPSHOT_BEGIN),
+              "snapshot records must not collide with commands");
+
+bool encodeReplRecord(uint64_t seq, const dispatch::DispatchMsg& msg, ReplRecord& out);
+dispatch::DispatchMsg decodeReplRecord(const ReplRecord& rec);
+
+// Streams the primary engine's command log to one backup over a Unix domain
+// socket. The engine thread only copies a record into an SPSC ring; a sender
+// thread writes the unacked log to the socket as fast as it drains and
+// collects cumulative acks, so replication never waits on the backup. A
+// backup that stops reading, or falls out of the retained log, is dropped
+// and reconnects from the last sequence it has. One the log can no longer
+// serve (it is behind the retained records or a ring overflow) is sent a
+// snapshot of the engine's books first, then the log from there.
+class ReplicationPublisher {
+public:
+    static constexpr size_t RING_CAP = 1 << 16;
+    static constexpr size_t MAX_RETAINED = 1 << 20;
+    static constexpr std::chrono::milliseconds BACKUP_STALL{1000};
+    static constexpr std::chrono::milliseconds HANDSHAKE_TIMEOUT{1000};
+
+    explicit ReplicationPublisher(const std::string& path);
+    ~ReplicationPublisher();
+
+    ReplicationPublisher(const ReplicationPublisher&) = delete;
+    ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+
+    // Installs the engine's command sink; call before engine.startEngine().
+    void attach(MatchingEngine& engine);
+
+    bool startPublisher();
+    void stopPublisher();
+
+    bool hasBackup() const noexcept { return backupConnected_.load(std::memory_order_acquire); }
+    uint64_t publishedSeq() const noexcept { return published_.load(std::memory_order_acquire); }
+    uint64_t ackedSeq() const noexcept { return acked_.load(std::memory_order_acquire); }
+    bool waitForAck(uint64_t seq, std::chrono::milliseconds timeout) const;
+    // Records dropped because the ring was full. The stream has a hole from
+    // then on: the backup is disconnected and resyncs from a snapshot.
+    uint64_t lostRecords() const noexcept { return lost_.load(std::memory_order_relaxed); }
+    uint64_t snapshotsSent() const noexcept { return snapshotsSent_.load(std::memory_order_relaxed); }
+
+private:
+    void append(uint64_t seq, const dispatch::DispatchMsg& msg);
+    void offerSnapshot(uint64_t seq, MatchingEngine::BookImages&& books);
+    void senderLoop();
+    void acceptBackup();
+    void prepareSnapshot();
+    ssize_t sendToBackup(const char* data, size_t len, std::chrono::steady_clock::time_point now);
+    void flushBackup();
+    bool sendPending() const;
+    void readAcks();
+    void dropBackup();
+
+    std::string path_;
+    MatchingEngine* engine_ = nullptr;
+    int listenFd_ = -1;
+    int backupFd_ = -1;
+
+    // Sender thread only.
+    boost::lockfree::spsc_queue<ReplRecord> ring_;
+    std::deque<ReplRecord> retained_;
+    std::vector<ReplRecord> sendBuf_;
+    uint64_t sentSeq_ = 0;
+    size_t sentBytes_ = 0;
+    std::chrono::steady_clock::time_point lastProgress_;
+    uint64_t resyncFrom_ = 0;
+    uint64_t lastTaken_ = 0;
+    int pendingFd_ = -1;
+    char handshakeBuf_[sizeof(uint64_t)];
+    size_t handshakeLen_ = 0;
+    std::chrono::steady_clock::time_point handshakeDeadline_;
+    char ackBuf_[sizeof(uint64_t)];
+    size_t ackLen_ = 0;
+    bool awaitingSnapshot_ = false;
+    std::vector<ReplRecord> snapshotRecs_;
+    size_t snapshotSentBytes_ = 0;
+
+    // Handed over by the engine thread.
+    std::mutex snapshotMtx_;
+    uint64_t snapshotSeq_ = 0;
+    MatchingEngine::BookImages snapshotBooks_;
+    std::atomic<bool> snapshotReady_{false};
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> acked_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> lastLostSeq_{0};
+    std::atomic<uint64_t> snapshotsSent_{0};
+    std::atomic<bool> backupConnected_{false};
+    std::thread senderThread_;
+    std::atomic<bool> running_{false};
+};
+
+// Backup side: applies the primary's commands to a local engine in sequence
+// and acks once per received batch. On a sequence gap, or when the primary
+// closes the stream, it stops applying, reconnects and asks for the stream
+// again from the first missing record; a snapshot that comes back instead
+// replaces the engine's books. promote() turns the backup into a primary at
+// the last sequence it received.
+class ReplicationFollower {
+public:
+    using ReportHandler = std::function<void(const dispatch::DispatchMsg&)>;
+
+    // RESYNCING: loading a snapshot; PRIMARY_LOST: the primary cannot be
+    // reached, the only state to promote from; DIVERGED: a snapshot could
+    // not be applied and the backup must be rebuilt, never promoted.
+    enum class State {
+        FOLLOWING,
+        RESYNCING,
+        PRIMARY_LOST,
+        DIVERGED
+    };
+
+    ReplicationFollower(MatchingEngine& engine, const std::string& path);
+    ~ReplicationFollower();
+
+    ReplicationFollower(const ReplicationFollower&) = delete;
+    ReplicationFollower& operator=(const ReplicationFollower&) = delete;
+
+    // Reports produced while following go nowhere unless a handler is set.
+    void setReportHandler(ReportHandler handler) { reportHandler_ = std::move(handler); }
+
+    bool startFollower(std::chrono::milliseconds connectTimeout = std::chrono::seconds(5));
+    uint64_t promote();
+
+    State state() const noexcept { return state_.load(std::memory_order_acquire); }
+    bool primaryLost() const noexcept { return state() == State::PRIMARY_LOST; }
+    uint64_t receivedSeq() const noexcept { return received_.load(std::memory_order_acquire); }
+    uint64_t resyncCount() const noexcept { return resyncs_.load(std::memory_order_relaxed); }
+
+private:
+    bool connectPrimary();
+    bool reconnectPrimary();
+    void followLoop();
+    bool onSnapshotRecord(const ReplRecord& rec);
+    bool applySnapshot();
+    void sendAck();
+    void drainReports();
+
+    MatchingEngine& engine_;
+    std::string path_;
+    int fd_ = -1;
+    std::chrono::milliseconds connectTimeout_{0};
+    ReportHandler reportHandler_;
+    uint64_t snapshotSeq_ = 0;
+    MatchingEngine::BookImages snapshot_;
+
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> resyncs_{0};
+    std::atomic<State> state_{State::FOLLOWING};
+    std::thread followThread_;
+    std::atomic<bool> running_{false};
+};
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "engine/matching_engine.h"
+#include <chrono>
+#include <string>
+
+namespace engine {
+
+// Moves a symbol's OrderBook from one running engine to another without
+// dropping or reordering its inbound flow. Blocks until the book has been
+// handed over or the timeout expires; on timeout the handover still
+// completes asynchronously. Fails without side effects while another
+// migration of the symbol is in flight.
+bool migrateSymbol(const std::string& symbol,
+                   MatchingEngine& from,
+                   MatchingEngine& to,
+                   std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "dispatch/dispatch_msg.h"
+#include "net/tcp_connection.h"
+#include "utils/rcu.h"
+
+namespace net {
+
+using dispatch::SessionId;
+
+// Live connections by session id: the slot index in the low 32 bits and the
+// slot's generation in the high 32. Closing a connection bumps the
+// generation, so an id outlives its connection harmlessly: lookups for it
+// fail even after the slot has been handed to a new client.
+//
+// Lookups are lock-free and may run on any thread inside an Rcu read
+// section; add() and remove() serialise on a mutex. A removed connection
+// is released only after every reader that could have seen it has left.
+class ConnectionRegistry {
+public:
+    // Ids use slot indices firstIndex .. firstIndex + capacity - 1, so
+    // registries with disjoint ranges never issue the same id.
+    explicit ConnectionRegistry(size_t capacity = 65536, uint32_t firstIndex = 0);
+    ~ConnectionRegistry();
+
+    ConnectionRegistry(const ConnectionRegistry&) = delete;
+    ConnectionRegistry& operator=(const ConnectionRegistry&) = delete;
+
+    // INVALID_SESSION when the registry is full.
+    SessionId add(std::shared_ptr<TcpConnection> conn);
+    bool remove(SessionId id);
+
+    // Caller holds an Rcu::ReadGuard; the pointer is valid until it is
+    // released.
+    TcpConnection* lookup(SessionId id) const {
+        uint32_t index = static_cast<uint32_t>(id) - firstIndex_;
+        uint32_t gen = static_cast<uint32_t>(id >> 32);
+        if (index >= slots_.size()) return nullptr;
+        const Slot& s = slots_[index];
+        if (s.gen.load(std::memory_order_acquire) != gen) return nullptr;
+        TcpConnection* conn = s.conn.load(std::memory_order_acquire);
+        // Re-check: the slot may have been recycled between the two loads.
+        if (s.gen.load(std::memory_order_acquire) != gen) return nullptr;
+        return conn;
+    }
+
+    size_t size() const;
+    // Connections removed but still waiting for their grace period.
+    size_t retiredCount() const;
+
+    // Releases retired connections whose grace period is over. add() and
+    // remove() call it as well.
+    void reclaim();
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> gen{1};
+        std::atomic<TcpConnection*> conn{nullptr};
+        std::shared_ptr<TcpConnection> owner;
+    };
+
+    struct Retired {
+        uint64_t ticket;
+        std::shared_ptr<TcpConnection> conn;
+    };
+
+    void reclaimLocked();
+
+    std::vector<Slot> slots_;
+    uint32_t firstIndex_;
+    mutable std::mutex mtx_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<Retired> retired_;
+    std::atomic<bool> hasRetired_{false};
+    size_t live_ = 0;
+};
+
+}
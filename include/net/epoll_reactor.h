@@ -1,5 +1,6 @@
 #pragma once
 #include "net/reactor.h"
+#include <atomic>
 #include <vector>
 #include <sys/epoll.h>
 
@@ -10,7 +11,8 @@ public:
     explicit EpollReactor(int maxEvents = 1024, int timeoutMs = -1);
     ~EpollReactor();
 
-    bool registerEventHandler(int fd, uint32_t events, const EventCallback& cb) override;
+    using Reactor::registerEventHandler;
+    bool registerEventHandler(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) override;
     bool updateEventMask(int fd, uint32_t events) override;
     bool unregisterEventHandler(int fd) override;
     void runEventLoop() override;
@@ -19,7 +21,7 @@ public:
 private:
     int epfd_ = -1;
     int timeoutMs_ = -1;
-    bool reactorRunning_ = false;
+    std::atomic<bool> stopRequested_{false};
     std::vector<struct epoll_event> events_;
 };
 
@@ -0,0 +1,153 @@
+#pragma once
+#include "net/reactor.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/io_uring.h>
+
+namespace net {
+
+// Reactor on io_uring, driven through the raw syscalls. All arming,
+// re-arming and cancellation for one loop iteration reaches the kernel in
+// the same io_uring_enter() that waits for the next batch of completions.
+//
+// Readiness: each registered fd has one POLL_ADD in flight, re-armed after
+// its callback runs, which keeps EpollReactor's level-triggered contract (a
+// handler that stops short of EAGAIN is called again).
+//
+// Completions, where the kernel has multishot recv: a listener registered
+// with registerAcceptor() has one multishot ACCEPT in flight, and a
+// receiver one multishot RECV that picks its buffers from a provided-buffer
+// ring (PROVIDE_BUFFERS where the ring does not work), so input arrives without a readiness round trip or a read() per
+// event. handleData() copies each buffer out and it goes straight back to
+// the ring. Bytes the handler did not take are kept here and the RECV is
+// cancelled; the next mask update for the fd hands them over again and
+// re-arms it. A receiver's poll covers the rest of its mask (EPOLLOUT) and
+// is not armed while that is empty. Sends stay with the caller's writev().
+//
+// Only the loop thread touches the rings. updateEventMask() from another
+// thread queues the change under a lock and wakes the loop through an
+// eventfd; registration and removal stay on the loop thread, as they do for
+// EpollReactor.
+class IoUringReactor final : public Reactor {
+public:
+    explicit IoUringReactor(unsigned entries = 4096, int timeoutMs = -1);
+    ~IoUringReactor();
+
+    // False when the kernel (or a seccomp policy) does not offer io_uring
+    // with the features this reactor needs.
+    static bool supported();
+
+    using Reactor::registerEventHandler;
+    bool registerEventHandler(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) override;
+    bool updateEventMask(int fd, uint32_t events) override;
+    bool unregisterEventHandler(int fd) override;
+    void runEventLoop() override;
+    void stopEventLoop() override;
+
+    bool completesReads() const override { return completions_; }
+    bool registerReceiver(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) override;
+    bool registerAcceptor(int listenFd, AcceptCallback onAccept) override;
+
+    static constexpr unsigned RECV_BUFFERS = 256;
+    static constexpr unsigned RECV_BUFFER_SIZE = 16 * 1024;
+
+private:
+    struct Watch {
+        uint32_t events = 0;
+        uint32_t gen = 0;           // current poll
+        uint32_t regGen = 0;        // registration; tags its RECV or ACCEPT
+        bool armed = false;         // poll in flight
+        bool registered = false;
+        bool receiver = false;
+        bool shotArmed = false;     // RECV or ACCEPT, until a CQE without F_MORE
+        bool shotCancelled = false;
+        bool eof = false;
+        bool eofDelivered = false;
+        bool redeliver = false;     // listed in redeliver_
+        std::string held;           // received, not yet taken
+        std::shared_ptr<AcceptCallback> onAccept;
+    };
+
+    io_uring_sqe* nextSqe();
+    void pushSqe();
+    void armPoll(int fd, Watch& w);
+    void removePoll(int fd, const Watch& w);
+    void armWake();
+    void armRecv(int fd, Watch& w);
+    void armAccept(int fd, Watch& w);
+    void cancel(uint64_t tag);
+    uint32_t pollMask(const Watch& w) const;
+    void syncPoll(int fd, Watch& w);
+    void syncRecv(int fd, Watch& w);
+    bool completeNow(io_uring_cqe& out);
+    bool setupBuffers();
+    bool setupBufferRing();
+    void recycleBuffer(uint16_t bid);
+    Watch* addWatch(int fd, uint32_t events);
+    Watch* findWatch(int fd);
+    Watch* findWatch(int fd, uint32_t regGen);
+    bool onLoopThread() const;
+    bool applyEventMask(int fd, uint32_t events);
+    void applyPendingMasks();
+    int submitAndWait();
+    void handleCompletion(const io_uring_cqe& cqe);
+    void handlePoll(int fd, uint32_t gen, const io_uring_cqe& cqe);
+    void handleRecv(int fd, uint32_t regGen, const io_uring_cqe& cqe);
+    void handleAccepted(int fd, uint32_t regGen, const io_uring_cqe& cqe);
+    // Returns how much the handler took; a throwing handler counts as
+    // having taken everything.
+    size_t deliver(int fd, const char* data, size_t len);
+    // Reports a pending end of stream once nothing is held, then re-arms
+    // the RECV if it is wanted.
+    void settleRecv(int fd, uint32_t regGen);
+    void redeliverHeld();
+
+    int ringFd_ = -1;
+    int wakeFd_ = -1;
+    int timeoutMs_;
+
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    void* sqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    void* cqRing_ = nullptr;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+
+    // Provided buffers for multishot RECV, one group; bufRing_ is null
+    // where they are handed back by PROVIDE_BUFFERS instead.
+    bool completions_ = false;
+    io_uring_buf_ring* bufRing_ = nullptr;
+    size_t bufRingSize_ = 0;
+    char* bufBase_ = nullptr;
+    uint16_t bufTail_ = 0;
+
+    // Indexed by fd, loop thread only; grows to the highest fd registered.
+    std::vector<Watch> watches_;
+    uint32_t nextGen_ = 1;
+    uint64_t wakeValue_ = 0;
+
+    std::mutex pendingMtx_;
+    std::vector<std::pair<int, uint32_t>> pendingMasks_;
+    std::vector<io_uring_cqe> batch_;
+    std::vector<int> redeliver_;
+    std::atomic<std::thread::id> loopThread_{};
+    std::atomic<bool> stopRequested_{false};
+};
+
+}
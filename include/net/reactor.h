@@ -1,23 +1,118 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
 namespace net {
 
 using EventCallback = std::function<void(int fd, uint32_t events)>;
+using AcceptCallback = std::function<void(int connFd)>;
+
+class EventHandler {
+public:
+    virtual ~EventHandler() = default;
+    virtual void handleEvent(int fd, uint32_t events) = 0;
+    // Receivers only (Reactor::registerReceiver): bytes the reactor already
+    // read from fd, or len 0 once the stream has ended or failed. Returns
+    // how many it took; the reactor keeps the rest and stops reading fd
+    // until its event mask is applied again.
+    virtual size_t handleData(int fd, const char* data, size_t len) {
+        (void)fd;
+        (void)data;
+        return len;
+    }
+};
+
+// fd-indexed registrations. A reactor hands the Slot pointer to the kernel
+// as the event's user data, so dispatch is one dereference and a virtual
+// call. An unregistered slot is only emptied, and is recycled after the
+// current batch has been dispatched: an event already fetched for a closed
+// fd then lands on the dead slot, never on a connection that reused the
+// number, and a handler may unregister itself from inside handleEvent().
+class HandlerTable {
+public:
+    struct Slot {
+        int fd = -1;
+        uint32_t events = 0;
+        std::unique_ptr<EventHandler> handler;
+        bool live = false;
+    };
+
+    HandlerTable() = default;
+    ~HandlerTable();
+    HandlerTable(const HandlerTable&) = delete;
+    HandlerTable& operator=(const HandlerTable&) = delete;
+
+    // Reactor thread.
+    Slot* add(int fd, uint32_t events, std::unique_ptr<EventHandler> handler);
+    bool remove(int fd);
+    // Between batches.
+    void releaseRetired();
+
+    // Any thread: the fd index is split into chunks that are never moved,
+    // so a lookup can race with registration of another fd.
+    Slot* find(int fd) const {
+        if (fd < 0 || static_cast<size_t>(fd) >= CHUNK_SIZE * MAX_CHUNKS) return nullptr;
+        Entry* chunk = chunks_[fd / CHUNK_SIZE].load(std::memory_order_acquire);
+        return chunk ? chunk[fd % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+    }
+
+private:
+    using Entry = std::atomic<Slot*>;
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_CHUNKS = 1024;
+
+    Entry* entry(int fd);
+
+    std::atomic<Entry*> chunks_[MAX_CHUNKS] = {};
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<Slot*> retired_;
+    std::vector<Slot*> free_;
+};
+
+inline void dispatchEvent(HandlerTable::Slot* slot, uint32_t events) {
+    if (slot->live) slot->handler->handleEvent(slot->fd, events);
+}
 
 class Reactor {
 public:
     virtual ~Reactor() = default;
-    virtual bool registerEventHandler(int fd, uint32_t events, const EventCallback& cb) = 0;
+
+    // The reactor owns the handler until unregisterEventHandler() and the
+    // end of the batch it was called from.
+    virtual bool registerEventHandler(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) = 0;
+    bool registerEventHandler(int fd, uint32_t events, const EventCallback& cb);
     virtual bool updateEventMask(int fd, uint32_t events) = 0;
     virtual bool unregisterEventHandler(int fd) = 0;
     virtual void runEventLoop() = 0;
     virtual void stopEventLoop() = 0;
 
+    // Completion reads: a receiver gets its input through handleData()
+    // instead of EPOLLIN events; other bits, such as EPOLLOUT, still arrive
+    // through handleEvent(). Where completesReads() is false a receiver is
+    // an ordinary registration.
+    virtual bool completesReads() const { return false; }
+    virtual bool registerReceiver(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) {
+        return registerEventHandler(fd, events, std::move(handler));
+    }
+    // Hands every connection accepted on listenFd, already non-blocking, to
+    // onAccept on the loop thread. The default accepts on readiness;
+    // unregisterEventHandler(listenFd) stops it.
+    virtual bool registerAcceptor(int listenFd, AcceptCallback onAccept);
+
 protected:
-    std::unordered_map<int, EventCallback> callbacks_;
+    HandlerTable handlers_;
+};
+
+enum class ReactorKind {
+    EPOLL,
+    IO_URING
 };
 
+// IO_URING falls back to epoll, with a warning, where the kernel lacks it.
+std::unique_ptr<Reactor> makeReactor(ReactorKind kind, int timeoutMs = -1);
+
 }
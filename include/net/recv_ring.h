@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <sys/types.h>
+
+namespace net {
+
+// Single-producer/single-consumer byte ring for one connection's input. The
+// reactor thread recv()s into the free space, or copies in what a
+// completion-based reactor received, and the connection's worker
+// parses frames in place, releasing bytes only once they have been handled.
+class RecvRing {
+public:
+    explicit RecvRing(size_t capacity = 64 * 1024);
+
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+    // Producer side.
+    size_t writable() const noexcept {
+        return capacity() - (tail_.load(std::memory_order_relaxed) -
+                             head_.load(std::memory_order_acquire));
+    }
+    // One readv() into the free space (both segments when it wraps).
+    // Returns what readv() returns; call only while writable() > 0.
+    ssize_t readFrom(int fd);
+    // Copies what fits of bytes received elsewhere; returns how many.
+    size_t write(const char* data, size_t len);
+
+    // Consumer side; offsets are relative to the oldest unconsumed byte.
+    size_t readable() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed);
+    }
+    const char* at(size_t off) const noexcept {
+        return buf_.get() + ((head_.load(std::memory_order_relaxed) + off) & mask_);
+    }
+    // Bytes from off up to the physical end of the buffer.
+    size_t contiguous(size_t off) const noexcept {
+        return capacity() - ((head_.load(std::memory_order_relaxed) + off) & mask_);
+    }
+    void copyOut(size_t off, size_t len, char* dst) const noexcept {
+        size_t first = len < contiguous(off) ? len : contiguous(off);
+        std::memcpy(dst, at(off), first);
+        std::memcpy(dst + first, at(off + first), len - first);
+    }
+    void consume(size_t n) noexcept {
+        head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<char[]> buf_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <sys/types.h>
+
+namespace net {
+
+// Outbound bytes for one connection, kept as a list of fixed-size chunks so
+// appends never move earlier data and a flush can hand every pending chunk
+// to one gathered write. Not thread-safe; TcpConnection guards it.
+class SendBuffer {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr int MAX_IOV = 64;
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void append(const char* data, size_t len);
+    void clear();
+
+    // One gathered write of up to MAX_IOV pending chunks; consumes whatever
+    // was written. Returns what the syscall returns.
+    ssize_t writeTo(int fd);
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    Chunk takeChunk();
+
+    std::deque<Chunk> chunks_;
+    std::vector<Chunk> spare_;
+    size_t size_ = 0;
+};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "dispatch/dispatch_msg.h"
+#include "net/shm_ring.h"
+
+namespace net {
+
+// Client side of ShmGateway, for strategy processes on the gateway's host.
+// Orders and reports use the binary protocol's messages; submit() and
+// poll() never block and never enter the kernel. One thread may submit
+// while another polls.
+class ShmClient {
+public:
+    ShmClient() = default;
+    ~ShmClient();
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    // False if no gateway serves name or all of its client blocks are taken.
+    bool attach(const std::string& name);
+    // Reports not yet polled are discarded.
+    void detach();
+    bool attached() const noexcept { return client_ != nullptr; }
+
+    dispatch::SessionId sessionId() const noexcept { return sessionId_; }
+
+    // False if msg has no binary encoding or the request ring is full.
+    bool submit(const dispatch::DispatchMsg& msg);
+    // False when no report is waiting.
+    bool poll(dispatch::DispatchMsg& report);
+
+private:
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    ShmLayout layout_{};
+    ShmClientHeader* client_ = nullptr;
+    ShmRing requests_;
+    ShmRing responses_;
+    dispatch::SessionId sessionId_ = dispatch::INVALID_SESSION;
+};
+
+}
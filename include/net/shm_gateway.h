@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dispatch/dispatcher.h"
+#include "net/shm_ring.h"
+
+namespace net {
+
+// Order entry for clients on the same host. Creates the /dev/shm segment
+// described in shm_ring.h and runs one thread that polls every attached
+// client's request ring, decoding binary frames straight into the
+// dispatcher's inbound path. A frame an engine refuses stays in its ring
+// until the engine has room, so a busy engine stalls the client's ring
+// rather than losing orders.
+//
+// Reports come back through queueSend() on the dispatcher thread, which is
+// the only producer of every response ring.
+class ShmGateway {
+public:
+    ShmGateway(dispatch::Dispatcher& dispatcher,
+               std::string name,
+               uint32_t maxClients = 16,
+               uint32_t ringSlots = 4096);
+    ~ShmGateway();
+
+    ShmGateway(const ShmGateway&) = delete;
+    ShmGateway& operator=(const ShmGateway&) = delete;
+
+    // Creates the segment, replacing a stale one left by a crashed gateway,
+    // and starts polling.
+    bool startGateway();
+    // Stops polling and unlinks the segment.
+    void stopGateway();
+
+    // False for an unknown or closed session, or when the client has let
+    // its response ring fill up; the report is dropped in both cases.
+    bool queueSend(dispatch::SessionId session, const std::string& payload);
+
+    const std::string& name() const noexcept { return name_; }
+    size_t activeClients() const noexcept { return activeClients_.load(std::memory_order_relaxed); }
+    uint64_t droppedReports() const noexcept { return droppedReports_.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        ShmClientHeader* hdr = nullptr;
+        ShmRing requests;
+        // Guards responses and generation against a concurrent recycle.
+        std::mutex sendMtx;
+        ShmRing responses;
+        uint32_t generation = 0;
+        bool active = false;
+        // Seen ATTACHING at the previous owner check.
+        bool attachingSeen = false;
+    };
+
+    void pollLoop();
+    bool pollClient(Client& client, uint32_t index, bool checkOwner);
+    void activateClient(Client& client);
+    void recycleClient(Client& client, uint32_t index);
+    void unmapSegment();
+
+    dispatch::Dispatcher& dispatcher_;
+    std::string name_;
+    ShmLayout layout_;
+    void* base_ = nullptr;
+    std::vector<std::unique_ptr<Client>> clients_;
+
+    std::thread pollThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> activeClients_{0};
+    std::atomic<uint64_t> droppedReports_{0};
+};
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "utils/binary_protocol.h"
+
+namespace net {
+
+// Layout of the shared-memory order entry segment. The gateway creates it
+// in /dev/shm; each colocated client claims one client block and talks to
+// the gateway through its two rings of binary protocol frames:
+//
+//   ShmSegmentHeader
+//   maxClients x (ShmClientHeader, request ring, response ring)
+//
+// Everything shared is either plain data written before `ready`/`state` is
+// published or a lock-free atomic, so the two processes need nothing else
+// to agree on.
+constexpr uint32_t SHM_MAGIC = 0x4F424753;
+constexpr uint32_t SHM_VERSION = 1;
+// One frame per slot; every binary template fits.
+constexpr size_t SHM_SLOT_SIZE = 64;
+
+static_assert(sizeof(utils::BinTradeReport) <= SHM_SLOT_SIZE &&
+              sizeof(utils::BinModifyOrder) <= SHM_SLOT_SIZE, "frames must fit a slot");
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free, "atomics are shared across processes");
+
+struct ShmRingHeader {
+    alignas(64) std::atomic<uint64_t> head{0};   // next slot the consumer reads
+    alignas(64) std::atomic<uint64_t> tail{0};   // next slot the producer writes
+};
+
+// Single-producer/single-consumer view of one ring. Only the two indices
+// are shared; each side caches the other's index and reloads it only when
+// the ring looks full (producer) or empty (consumer).
+class ShmRing {
+public:
+    ShmRing() = default;
+    // hdr is followed by `slots` slots; slots is a power of two.
+    ShmRing(ShmRingHeader* hdr, uint32_t slots)
+        : hdr_(hdr),
+          slots_(reinterpret_cast<char*>(hdr + 1)),
+          mask_(slots - 1),
+          cachedHead_(hdr->head.load(std::memory_order_acquire)),
+          cachedTail_(hdr->tail.load(std::memory_order_acquire)) {}
+
+    static constexpr size_t bytesFor(uint32_t slots) { return sizeof(ShmRingHeader) + slots * SHM_SLOT_SIZE; }
+
+    // Producer side. False when the ring is full.
+    bool tryPush(const char* frame, size_t len) {
+        if (len > SHM_SLOT_SIZE) return false;
+        uint64_t tail = hdr_->tail.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = hdr_->head.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) return false;
+        }
+        std::memcpy(slot(tail), frame, len);
+        hdr_->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Null when empty; the frame stays put until pop(),
+    // which may only follow a non-null front().
+    const char* front() {
+        uint64_t head = hdr_->head.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = hdr_->tail.load(std::memory_order_acquire);
+            if (head == cachedTail_) return nullptr;
+        }
+        return slot(head);
+    }
+    void pop() {
+        hdr_->head.store(hdr_->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t size() const {
+        return hdr_->tail.load(std::memory_order_acquire) - hdr_->head.load(std::memory_order_acquire);
+    }
+
+private:
+    char* slot(uint64_t index) const { return slots_ + (index & mask_) * SHM_SLOT_SIZE; }
+
+    ShmRingHeader* hdr_ = nullptr;
+    char* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t cachedHead_ = 0;
+    uint64_t cachedTail_ = 0;
+};
+
+enum class ShmClientState : uint32_t {
+    FREE,
+    ATTACHING,   // claimed by a client that is still setting up
+    ACTIVE,
+    CLOSING      // client detached; the gateway recycles the block
+};
+
+struct ShmClientHeader {
+    alignas(64) std::atomic<uint32_t> state{static_cast<uint32_t>(ShmClientState::FREE)};
+    // Bumped each time the block is recycled; part of the session id.
+    std::atomic<uint32_t> generation{1};
+    std::atomic<int32_t> pid{0};
+};
+
+struct ShmSegmentHeader {
+    alignas(64) uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t maxClients = 0;
+    uint32_t ringSlots = 0;
+    // Set by the gateway once every block is initialised.
+    std::atomic<uint32_t> ready{0};
+};
+
+struct ShmLayout {
+    uint32_t maxClients;
+    uint32_t ringSlots;
+
+    size_t clientBytes() const { return sizeof(ShmClientHeader) + 2 * ShmRing::bytesFor(ringSlots); }
+    size_t segmentBytes() const { return sizeof(ShmSegmentHeader) + maxClients * clientBytes(); }
+
+    ShmClientHeader* client(void* base, uint32_t index) const {
+        return reinterpret_cast<ShmClientHeader*>(static_cast<char*>(base) + sizeof(ShmSegmentHeader) +
+                                                  index * clientBytes());
+    }
+    ShmRingHeader* requestRing(ShmClientHeader* client) const {
+        return reinterpret_cast<ShmRingHeader*>(client + 1);
+    }
+    ShmRingHeader* responseRing(ShmClientHeader* client) const {
+        return reinterpret_cast<ShmRingHeader*>(reinterpret_cast<char*>(requestRing(client)) +
+                                                ShmRing::bytesFor(ringSlots));
+    }
+};
+
+// Shared-memory sessions set this bit in the low word, which TCP session
+// ids (shard * 65536 + slot) never reach.
+constexpr uint32_t SHM_SESSION_FLAG = 0x80000000u;
+
+inline uint64_t shmSessionId(uint32_t generation, uint32_t index) {
+    return (static_cast<uint64_t>(generation) << 32) | SHM_SESSION_FLAG | index;
+}
+
+inline bool isShmSession(uint64_t session) {
+    return (static_cast<uint32_t>(session) & SHM_SESSION_FLAG) != 0;
+}
+
+}
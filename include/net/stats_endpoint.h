@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "net/reactor.h"
+
+namespace net {
+
+// Plain-text metrics over HTTP, served from an existing reactor: every GET
+// gets utils::MetricsRegistry::renderText() and the connection closes.
+// Meant for scrapers and curl, not for load.
+class StatsEndpoint {
+public:
+    StatsEndpoint(Reactor& reactor, const std::string& host, uint16_t port);
+    ~StatsEndpoint();
+
+    StatsEndpoint(const StatsEndpoint&) = delete;
+    StatsEndpoint& operator=(const StatsEndpoint&) = delete;
+
+    // Before the reactor's loop starts, or on its thread.
+    bool startEndpoint();
+
+private:
+    class Client;
+
+    void handleAccept(int listenFd);
+
+    Reactor& reactor_;
+    int listenFd_{-1};
+};
+
+}
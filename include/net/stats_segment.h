@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/metrics.h"
+
+namespace net {
+
+constexpr uint32_t STATS_MAGIC   = 0x4F425354;   // "OBST"
+constexpr uint32_t STATS_VERSION = 1;
+constexpr size_t STATS_NAME_LEN  = 112;
+
+// Layout of the segment: this header, then capacity entries. The whole
+// snapshot is rewritten under a sequence lock (odd while writing), so a
+// reader copies it and retries if seq moved.
+struct StatsSegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t count;
+    alignas(64) std::atomic<uint64_t> seq;
+    int64_t updatedNs;   // CLOCK_REALTIME of the last publish
+};
+
+struct StatsEntry {
+    char name[STATS_NAME_LEN];   // NUL-terminated, truncated if longer
+    int64_t value;
+    uint8_t kind;                // utils::MetricKind
+    uint8_t reserved[7];
+};
+static_assert(sizeof(StatsEntry) == 128, "two cache lines per entry");
+
+// Copies the metrics registry into a POSIX shared-memory segment every
+// interval, for monitoring tools on the same host to poll without a
+// socket round trip or any work in the server.
+class StatsPublisher {
+public:
+    explicit StatsPublisher(std::string name,
+                            uint32_t capacity = 1024,
+                            std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+    ~StatsPublisher();
+
+    StatsPublisher(const StatsPublisher&) = delete;
+    StatsPublisher& operator=(const StatsPublisher&) = delete;
+
+    bool startPublisher();
+    void stopPublisher();
+    // Publishes a snapshot now, on the calling thread.
+    void publishNow();
+
+private:
+    void publish();
+
+    std::string name_;
+    uint32_t capacity_;
+    std::chrono::milliseconds interval_;
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex waitMtx_;   // also serialises writers
+    std::condition_variable waitCv_;
+};
+
+// Read side, for tools and tests.
+class StatsReader {
+public:
+    StatsReader() = default;
+    ~StatsReader() { detach(); }
+
+    StatsReader(const StatsReader&) = delete;
+    StatsReader& operator=(const StatsReader&) = delete;
+
+    bool attach(const std::string& name);
+    void detach();
+    // A consistent copy of the last snapshot; false before the first one.
+    bool read(std::vector<utils::MetricSample>& out, int64_t* updatedNs = nullptr) const;
+
+private:
+    void* base_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+}
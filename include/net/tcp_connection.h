@@ -1,20 +1,139 @@
 #pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include "dispatch/dispatch_msg.h"
+#include "net/recv_ring.h"
+#include "net/send_buffer.h"
 
 namespace net {
 
-class TcpConnection {
+class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
 public:
-    explicit TcpConnection(int fd) : fd_(fd) {}
+    // Returns how many frames, from the front, it took; the rest stay in
+    // the ring for the next drain.
+    using FrameBatchHandler = std::function<size_t(const std::vector<std::string_view>& frames)>;
+    using InterestFunc = std::function<void(uint32_t events)>;
+
+    enum class SendResult { QUEUED, DROPPED, OVERFLOW, CLOSED };
+    enum class FlushResult { DONE, PENDING, FAILED };
+
+    // Above the soft limit droppable data (market data) is discarded; above
+    // the hard limit the peer is too slow to keep and gets disconnected.
+    static constexpr size_t SEND_SOFT_LIMIT = 256 * 1024;
+    static constexpr size_t SEND_HARD_LIMIT = 4 * 1024 * 1024;
+
+    explicit TcpConnection(int fd, size_t recvCapacity = 64 * 1024)
+        : fd_(fd), rx_(recvCapacity) {}
     ~TcpConnection() { if (fd_ >= 0) ::close(fd_); }
 
     int socketFd() const { return fd_; }
-    std::string read();
-    bool send(const std::string& data);
+    // Set once by the server before the connection is published.
+    dispatch::SessionId sessionId() const { return sessionId_; }
+    void setSessionId(dispatch::SessionId id) { sessionId_ = id; }
+
+    // Any thread: appends to the output buffer without touching the socket,
+    // so a slow reader never stalls the caller.
+    SendResult queueSend(const char* data, size_t len, bool droppable = false);
+    // Writes as much as the socket takes. PENDING means bytes remain for an
+    // EPOLLOUT-driven flush, and apply is handed the new reactor interest
+    // whenever that need changes.
+    FlushResult flush(const InterestFunc& apply);
+    size_t pendingSendBytes() const;
+    void setSendLimits(size_t softLimit, size_t hardLimit) {
+        softLimit_ = softLimit;
+        hardLimit_ = hardLimit;
+    }
+
+    // Dispatcher thread only: set while the connection sits in the
+    // server's flush list.
+    bool markFlushQueued() {
+        if (flushQueued_) return false;
+        flushQueued_ = true;
+        return true;
+    }
+    void clearFlushQueued() { flushQueued_ = false; }
+
+    // Reactor thread: reads until EAGAIN or the receive ring is full. False
+    // once the peer has closed or the socket failed.
+    bool fillRecvRing();
+    // Reads are edge-triggered, so a fill that stopped at a full ring gets
+    // no further event for the bytes left in the socket. The worker that
+    // frees ring space takes this flag and re-arms the socket.
+    bool takeRecvStarved() { return rxStarved_.exchange(false, std::memory_order_acq_rel); }
+    // Reactor thread, completion reads: copies in what fits of bytes the
+    // reactor already received and returns how many. A short copy starves
+    // the connection just like a fill that stopped at a full ring.
+    size_t takeReceived(const char* data, size_t len);
+
+    // Reactor interest: edge-triggered EPOLLIN unless reading is paused for
+    // backpressure, plus EPOLLOUT while sends are pending. The send path,
+    // the workers and the engines' relief callbacks change it from
+    // different threads, so apply runs under a lock with the combined mask
+    // and updates cannot reorder.
+    uint32_t interest() const;
+    // True if this call changed the state.
+    bool pauseReading(const InterestFunc& apply);
+    bool resumeReading(const InterestFunc& apply);
+    bool readPaused() const { return readPaused_.load(std::memory_order_acquire); }
+    // Re-applies the current mask; epoll reports a still-ready socket again.
+    void rearm(const InterestFunc& apply);
+
+    // Reactor thread: decided from the first byte received, fixed for the
+    // connection's life. Worker tasks see it through the task queue.
+    bool protocolKnown() const { return protocolKnown_; }
+    dispatch::WireProtocol protocol() const { return protocol_; }
+    void detectProtocol();
+
+    // Drain doorbell: requestDrain() is true when the caller must schedule
+    // a drain; the worker calls beginDrain() before drainFrames() so input
+    // arriving mid-drain schedules another one.
+    bool requestDrain() { return !drainPending_.exchange(true, std::memory_order_acq_rel); }
+    void beginDrain() { drainPending_.exchange(false, std::memory_order_acq_rel); }
+
+    // Worker thread: hands every complete frame (newline-delimited JSON or
+    // length-prefixed binary) to handler in one batch, as views into the
+    // ring, then releases them. False on input that can never frame.
+    bool drainFrames(const FrameBatchHandler& handler);
+
+    void shutdownSocket();
 
 private:
+    uint32_t interestLocked() const;
+    void setWriteInterest(bool want, const InterestFunc& apply);
+
+    bool nextJsonFrame(size_t off, size_t avail, std::string_view& frame, size_t& used);
+    bool nextBinaryFrame(size_t off, size_t avail, std::string_view& frame, size_t& used, bool& bad);
+
     int fd_;
+    dispatch::SessionId sessionId_ = dispatch::INVALID_SESSION;
+    RecvRing rx_;
+    bool protocolKnown_ = false;
+    dispatch::WireProtocol protocol_ = dispatch::WireProtocol::JSON;
+    std::atomic<bool> drainPending_{false};
+    std::atomic<bool> rxStarved_{false};
+
+    mutable std::mutex interestMtx_;
+    std::atomic<bool> readPaused_{false};
+    bool writeInterest_ = false;
+
+    mutable std::mutex txMtx_;
+    SendBuffer tx_;
+    bool txClosed_ = false;
+    size_t softLimit_ = SEND_SOFT_LIMIT;
+    size_t hardLimit_ = SEND_HARD_LIMIT;
+    bool flushQueued_ = false;
+
+    // Worker-owned; reused across drains.
+    std::vector<std::string_view> frames_;
+    std::vector<size_t> frameEnds_;
+    std::string wrapped_;
 };
 
 }
@@ -1,41 +1,100 @@
 #pragma once
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "utils/thread_pool.h"
 #include "net/epoll_reactor.h"
 #include "net/tcp_connection.h"
+#include "net/connection_registry.h"
 #include "utils/socketops.h"
 #include "dispatch/dispatcher.h"
+#include "utils/metrics.h"
 
 namespace net {
 
 class TcpServer {
 public:
-    explicit TcpServer(EpollReactor& reactor,
+    explicit TcpServer(Reactor& reactor,
                     dispatch::Dispatcher& dispatcher,
                     const std::string& host,
                     uint16_t port,
-                    size_t threadCount = std::thread::hardware_concurrency());
+                    size_t threadCount = std::thread::hardware_concurrency(),
+                    ConnectionRegistry* registry = nullptr);
 
     ~TcpServer();
 
     bool startServer();
     void shutdownServer();
 
-    TcpConnection* getConnection (int fd);
-    const TcpConnection* getConnection (int fd) const;
+    // Shared with the other shards of a TcpServerGroup, or owned.
+    ConnectionRegistry& registry() { return *registry_; }
+
+    // Dispatcher thread: queueSend() appends a report to the connection's
+    // output buffer; flushPending() writes every connection touched since
+    // the last flush, one gathered write each. A session that has closed
+    // is refused, even if its fd now belongs to a new client.
+    bool queueSend(dispatch::SessionId session, const std::string& payload);
+    void flushPending();
 
 protected:
     bool startListening();
-    virtual void handleAccept(int listenFd, uint32_t events);
-    virtual void handleRead(int connFd, uint32_t events);
+    virtual void handleAccept(int connFd);
+    // Readiness reactors: read conn until EAGAIN or a full ring.
+    virtual void handleRead(const std::shared_ptr<TcpConnection>& conn, uint32_t events);
+    // Completion reactors: bytes already read for conn, len 0 at its end.
+    // Returns how many fit in its ring.
+    virtual size_t handleData(const std::shared_ptr<TcpConnection>& conn, const char* data, size_t len);
+    void afterReceive(const std::shared_ptr<TcpConnection>& conn, bool open);
+    void handleWrite(TcpConnection& conn);
+    TcpConnection::InterestFunc interestUpdater(int connFd);
+    void scheduleDrain(const std::shared_ptr<TcpConnection>& conn);
+    // Returns how many frames were taken; stops at the first one an engine
+    // refused or that left its engine congested.
+    size_t routeFrames(const std::shared_ptr<TcpConnection>& conn,
+                       const std::vector<std::string_view>& frames);
+    // Backpressure: stop reading conn until engine has drained.
+    void pauseForEngine(const std::shared_ptr<TcpConnection>& conn, engine::MatchingEngine* engine);
+    void resumeForEngine(engine::MatchingEngine* engine);
 
 private:
-    EpollReactor& reactor_;
+    void registerMetrics();
+
+    // Registered per connection, so a ready event reaches its connection
+    // through the reactor's slot without a table lookup.
+    class ConnectionHandler final : public EventHandler {
+    public:
+        ConnectionHandler(TcpServer& server, std::shared_ptr<TcpConnection> conn)
+            : server_(server), conn_(std::move(conn)) {}
+        void handleEvent(int fd, uint32_t events) override;
+        size_t handleData(int fd, const char* data, size_t len) override;
+
+    private:
+        TcpServer& server_;
+        std::shared_ptr<TcpConnection> conn_;
+    };
+
+    Reactor& reactor_;
     utils::ThreadPool threadPool_;
     dispatch::Dispatcher& dispatcher_;
 
     int listenFd_{-1};
-    std::unordered_map<int, TcpConnection> conns_;
+    std::unique_ptr<ConnectionRegistry> ownedRegistry_;
+    ConnectionRegistry* registry_;
+    std::vector<std::shared_ptr<TcpConnection>> flushList_;
+
+    std::mutex pausedMtx_;
+    std::unordered_map<engine::MatchingEngine*, std::vector<std::shared_ptr<TcpConnection>>> paused_;
+    size_t reliefListenerId_ = 0;
+
+    utils::Counter accepted_;
+    utils::Counter closed_;
+    utils::Counter rejected_;
+    utils::Counter frames_;
+    utils::Counter badFrames_;
+    utils::Counter slowConsumers_;
+    utils::Counter pauses_;
+    utils::MetricsScope metrics_;
 };
 
 }
@@ -0,0 +1,66 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "net/reactor.h"
+#include "net/tcp_server.h"
+#include "dispatch/dispatcher.h"
+
+namespace net {
+
+// N independent network shards. Each runs its own reactor on its own
+// thread with its own SO_REUSEPORT listen socket, so the kernel spreads
+// incoming connections and every connection lives on one shard from accept
+// to close.
+class TcpServerGroup {
+public:
+    // Every shard gets its own connection registry with a disjoint id range,
+    // so a session id alone names its shard.
+    using ServerFactory = std::function<std::unique_ptr<TcpServer>(Reactor& reactor,
+                                                                   ConnectionRegistry& registry)>;
+
+    TcpServerGroup(dispatch::Dispatcher& dispatcher,
+                   const std::string& host,
+                   uint16_t port,
+                   size_t reactorCount,
+                   size_t workersPerReactor = 1,
+                   ReactorKind kind = ReactorKind::EPOLL);
+    // For TcpServer subclasses; the factory is called once per shard.
+    TcpServerGroup(size_t reactorCount, ServerFactory factory,
+                   ReactorKind kind = ReactorKind::EPOLL);
+    ~TcpServerGroup();
+
+    TcpServerGroup(const TcpServerGroup&) = delete;
+    TcpServerGroup& operator=(const TcpServerGroup&) = delete;
+
+    bool startGroup();
+    void stopGroup();
+    // Blocks until stopGroup() is called from another thread.
+    void joinGroup();
+
+    size_t shardCount() const noexcept { return shards_.size(); }
+    // For side services that share a shard's loop; register before startGroup().
+    Reactor& reactor(size_t shard) { return *shards_[shard]->reactor; }
+
+    // Dispatcher thread; same contract as TcpServer's.
+    bool queueSend(dispatch::SessionId session, const std::string& payload);
+    void flushPending();
+
+private:
+    struct Shard {
+        std::unique_ptr<Reactor> reactor;
+        std::unique_ptr<ConnectionRegistry> registry;
+        std::unique_ptr<TcpServer> server;
+        std::thread loop;
+    };
+
+    static constexpr int REACTOR_TIMEOUT_MS = 100;
+    static constexpr uint32_t SESSIONS_PER_SHARD = 65536;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    bool started_ = false;
+};
+
+}
@@ -0,0 +1,309 @@
+#pragma once
+#include "dispatch/dispatch_msg.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace utils {
+
+// Fixed-layout order entry protocol. Every frame starts with BinHeader and
+// `length` covers the whole frame; fields are little-endian at the offsets
+// of the structs below. A connection whose first byte is BIN_MAGIC speaks
+// this protocol for its lifetime, anything else is treated as JSON.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "binary frames are read and written with plain loads and stores");
+
+constexpr uint8_t BIN_MAGIC = 0xB5;
+constexpr size_t BIN_SYMBOL_LEN = 16;
+constexpr size_t BIN_MAX_FRAME = 256;
+
+enum class BinTemplate : uint8_t {
+    NEW_ORDER     = 1,
+    CANCEL_ORDER  = 2,
+    MODIFY_ORDER  = 3,
+    ACK           = 101,
+    CANCEL_REPORT = 102,
+    TRADE_REPORT  = 103,
+    REJECT        = 104
+};
+
+enum class BinStatus : uint8_t {
+    NONE,
+    RECEIVED,
+    CANCEL_OK,
+    NOT_FOUND,
+    UNKNOWN_SYMBOL,
+    UNKNOWN_MSGTYPE,
+    BOOK_FULL,
+    OTHER = 255
+};
+
+struct BinHeader {
+    uint8_t  magic;
+    uint8_t  templateId;
+    uint16_t length;
+};
+
+struct BinNewOrder {
+    BinHeader hdr;
+    uint8_t   side;
+    uint8_t   reserved[3];
+    double    price;
+    uint32_t  qty;
+    uint32_t  reserved2;
+    char      symbol[BIN_SYMBOL_LEN];
+};
+
+struct BinCancelOrder {
+    BinHeader hdr;
+    uint32_t  reserved;
+    uint64_t  orderId;
+    char      symbol[BIN_SYMBOL_LEN];
+};
+
+struct BinModifyOrder {
+    BinHeader hdr;
+    uint8_t   side;
+    uint8_t   reserved[3];
+    uint64_t  orderId;
+    double    price;
+    uint32_t  qty;
+    uint32_t  reserved2;
+    char      symbol[BIN_SYMBOL_LEN];
+};
+
+// ACK, CANCEL_REPORT and REJECT.
+struct BinStatusReport {
+    BinHeader hdr;
+    uint8_t   status;
+    uint8_t   reserved[3];
+    uint64_t  orderId;
+    char      symbol[BIN_SYMBOL_LEN];
+};
+
+struct BinTradeReport {
+    BinHeader hdr;
+    uint32_t  qty;
+    double    price;
+    uint64_t  makerId;
+    uint64_t  takerId;
+    char      symbol[BIN_SYMBOL_LEN];
+};
+
+static_assert(sizeof(BinHeader) == 4, "wire layout");
+static_assert(sizeof(BinNewOrder) == 40, "wire layout");
+static_assert(sizeof(BinCancelOrder) == 32, "wire layout");
+static_assert(sizeof(BinModifyOrder) == 48, "wire layout");
+static_assert(sizeof(BinStatusReport) == 32, "wire layout");
+static_assert(sizeof(BinTradeReport) == 48, "wire layout");
+
+namespace detail {
+
+inline bool putSymbol(char (&dst)[BIN_SYMBOL_LEN], const std::string& symbol) {
+    if (symbol.size() > BIN_SYMBOL_LEN) return false;
+    std::memset(dst, 0, BIN_SYMBOL_LEN);
+    std::memcpy(dst, symbol.data(), symbol.size());
+    return true;
+}
+
+inline void getSymbol(const char (&src)[BIN_SYMBOL_LEN], std::string& symbol) {
+    symbol.assign(src, strnlen(src, BIN_SYMBOL_LEN));
+}
+
+template<typename T>
+inline size_t writeFrame(T& frame, BinTemplate tpl, char* buf, size_t cap) {
+    static_assert(std::is_trivially_copyable<T>::value, "frames are copied raw");
+    if (cap < sizeof(T)) return 0;
+    frame.hdr.magic = BIN_MAGIC;
+    frame.hdr.templateId = static_cast<uint8_t>(tpl);
+    frame.hdr.length = static_cast<uint16_t>(sizeof(T));
+    std::memcpy(buf, &frame, sizeof(T));
+    return sizeof(T);
+}
+
+// Later template versions may append fields, so only a short frame is an error.
+template<typename T>
+inline bool readFrame(const char* frame, size_t len, T& out) {
+    if (len < sizeof(T)) return false;
+    std::memcpy(&out, frame, sizeof(T));
+    return true;
+}
+
+inline BinStatus statusCode(const std::string& status) {
+    if (status.empty())                return BinStatus::NONE;
+    if (status == "RECEIVED")          return BinStatus::RECEIVED;
+    if (status == "CANCEL_OK")         return BinStatus::CANCEL_OK;
+    if (status == "NOT_FOUND")         return BinStatus::NOT_FOUND;
+    if (status == "UNKNOWN_SYMBOL")    return BinStatus::UNKNOWN_SYMBOL;
+    if (status == "UNKNOWN_MSGTYPE")   return BinStatus::UNKNOWN_MSGTYPE;
+    if (status == "BOOK_FULL")         return BinStatus::BOOK_FULL;
+    return BinStatus::OTHER;
+}
+
+inline const char* statusText(BinStatus status) {
+    switch (status) {
+        case BinStatus::NONE:            return "";
+        case BinStatus::RECEIVED:        return "RECEIVED";
+        case BinStatus::CANCEL_OK:       return "CANCEL_OK";
+        case BinStatus::NOT_FOUND:       return "NOT_FOUND";
+        case BinStatus::UNKNOWN_SYMBOL:  return "UNKNOWN_SYMBOL";
+        case BinStatus::UNKNOWN_MSGTYPE: return "UNKNOWN_MSGTYPE";
+        case BinStatus::BOOK_FULL:       return "BOOK_FULL";
+        default:                         return "OTHER";
+    }
+}
+
+}
+
+// Size of the complete frame at the front of buf, 0 if more bytes are
+// needed, -1 if the bytes cannot start a frame.
+inline int binFrameLength(const char* buf, size_t avail) {
+    if (avail < sizeof(BinHeader)) {
+        return (avail > 0 && static_cast<uint8_t>(buf[0]) != BIN_MAGIC) ? -1 : 0;
+    }
+    BinHeader hdr;
+    std::memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.magic != BIN_MAGIC || hdr.length < sizeof(BinHeader) || hdr.length > BIN_MAX_FRAME) {
+        return -1;
+    }
+    return avail < hdr.length ? 0 : hdr.length;
+}
+
+// Gateway side: one complete inbound frame to an order message.
+inline bool decodeBinaryOrder(const char* frame, size_t len, dispatch::DispatchMsg& msg) {
+    if (len < sizeof(BinHeader)) return false;
+    msg.protocol = dispatch::WireProtocol::BINARY;
+
+    switch (static_cast<BinTemplate>(frame[1])) {
+        case BinTemplate::NEW_ORDER: {
+            BinNewOrder m;
+            if (!detail::readFrame(frame, len, m)) return false;
+            msg.type  = dispatch::MsgType::NEW_ORDER;
+            msg.side  = m.side ? core::Side::SELL : core::Side::BUY;
+            msg.price = m.price;
+            msg.qty   = m.qty;
+            detail::getSymbol(m.symbol, msg.symbol);
+            return true;
+        }
+        case BinTemplate::CANCEL_ORDER: {
+            BinCancelOrder m;
+            if (!detail::readFrame(frame, len, m)) return false;
+            msg.type    = dispatch::MsgType::CANCEL_ORDER;
+            msg.orderId = m.orderId;
+            detail::getSymbol(m.symbol, msg.symbol);
+            return true;
+        }
+        case BinTemplate::MODIFY_ORDER: {
+            BinModifyOrder m;
+            if (!detail::readFrame(frame, len, m)) return false;
+            msg.type    = dispatch::MsgType::MODIFY_ORDER;
+            msg.side    = m.side ? core::Side::SELL : core::Side::BUY;
+            msg.orderId = m.orderId;
+            msg.price   = m.price;
+            msg.qty     = m.qty;
+            detail::getSymbol(m.symbol, msg.symbol);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// Gateway side: writes the report frame for msg into buf. Returns the frame
+// size, or 0 if buf is too small or the symbol does not fit the layout.
+inline size_t encodeBinaryReport(const dispatch::DispatchMsg& msg, char* buf, size_t cap) {
+    if (msg.type == dispatch::MsgType::TRADE_REPORT) {
+        BinTradeReport r{};
+        if (!detail::putSymbol(r.symbol, msg.symbol)) return 0;
+        r.qty     = msg.qty;
+        r.price   = msg.price;
+        r.makerId = msg.makerId;
+        r.takerId = msg.takerId;
+        return detail::writeFrame(r, BinTemplate::TRADE_REPORT, buf, cap);
+    }
+
+    BinTemplate tpl;
+    switch (msg.type) {
+        case dispatch::MsgType::ACK:           tpl = BinTemplate::ACK; break;
+        case dispatch::MsgType::CANCEL_REPORT: tpl = BinTemplate::CANCEL_REPORT; break;
+        default:                               tpl = BinTemplate::REJECT; break;
+    }
+    BinStatusReport r{};
+    if (!detail::putSymbol(r.symbol, msg.symbol)) return 0;
+    r.status  = static_cast<uint8_t>(detail::statusCode(msg.status));
+    r.orderId = msg.orderId;
+    return detail::writeFrame(r, tpl, buf, cap);
+}
+
+inline size_t encodeBinaryReport(const dispatch::DispatchMsg& msg, std::string& out) {
+    out.resize(sizeof(BinTradeReport));
+    out.resize(encodeBinaryReport(msg, out.data(), out.size()));
+    return out.size();
+}
+
+// Client side: order message to a frame.
+inline size_t encodeBinaryOrder(const dispatch::DispatchMsg& msg, char* buf, size_t cap) {
+    uint8_t side = msg.side == core::Side::SELL ? 1 : 0;
+    switch (msg.type) {
+        case dispatch::MsgType::NEW_ORDER: {
+            BinNewOrder m{};
+            if (!detail::putSymbol(m.symbol, msg.symbol)) return 0;
+            m.side  = side;
+            m.price = msg.price;
+            m.qty   = msg.qty;
+            return detail::writeFrame(m, BinTemplate::NEW_ORDER, buf, cap);
+        }
+        case dispatch::MsgType::CANCEL_ORDER: {
+            BinCancelOrder m{};
+            if (!detail::putSymbol(m.symbol, msg.symbol)) return 0;
+            m.orderId = msg.orderId;
+            return detail::writeFrame(m, BinTemplate::CANCEL_ORDER, buf, cap);
+        }
+        case dispatch::MsgType::MODIFY_ORDER: {
+            BinModifyOrder m{};
+            if (!detail::putSymbol(m.symbol, msg.symbol)) return 0;
+            m.side    = side;
+            m.orderId = msg.orderId;
+            m.price   = msg.price;
+            m.qty     = msg.qty;
+            return detail::writeFrame(m, BinTemplate::MODIFY_ORDER, buf, cap);
+        }
+        default:
+            return 0;
+    }
+}
+
+// Client side: one complete report frame back to a message.
+inline bool decodeBinaryReport(const char* frame, size_t len, dispatch::DispatchMsg& msg) {
+    if (len < sizeof(BinHeader)) return false;
+    msg.protocol = dispatch::WireProtocol::BINARY;
+
+    auto tpl = static_cast<BinTemplate>(frame[1]);
+    if (tpl == BinTemplate::TRADE_REPORT) {
+        BinTradeReport r;
+        if (!detail::readFrame(frame, len, r)) return false;
+        msg.type    = dispatch::MsgType::TRADE_REPORT;
+        msg.qty     = r.qty;
+        msg.price   = r.price;
+        msg.makerId = r.makerId;
+        msg.takerId = r.takerId;
+        detail::getSymbol(r.symbol, msg.symbol);
+        return true;
+    }
+
+    switch (tpl) {
+        case BinTemplate::ACK:           msg.type = dispatch::MsgType::ACK; break;
+        case BinTemplate::CANCEL_REPORT: msg.type = dispatch::MsgType::CANCEL_REPORT; break;
+        case BinTemplate::REJECT:        msg.type = dispatch::MsgType::UNKNOWN; break;
+        default:                         return false;
+    }
+    BinStatusReport r;
+    if (!detail::readFrame(frame, len, r)) return false;
+    msg.orderId = r.orderId;
+    msg.status  = detail::statusText(static_cast<BinStatus>(r.status));
+    detail::getSymbol(r.symbol, msg.symbol);
+    return true;
+}
+
+}
@@ -1,88 +1,348 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
-#include <vector>
+#include <chrono>
 #include <cstddef>
+#include <memory>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Bounded rings for a fixed number of producers and consumers:
+//   SpscQueue      one producer, one consumer
+//   MpscQueue      many producers, one consumer
+//   LockFreeQueue  many producers, many consumers
+// Capacity is rounded up to a power of two. push fails rather than blocks
+// on a full ring; pushWait/popWait spin, then yield, until they succeed or
+// the timeout passes. The batch calls move as many items as fit and
+// return how many that was.
 
 namespace utils {
 
+namespace lfq {
+
+constexpr size_t CACHE_LINE = 64;
+
+inline size_t roundUpPow2(size_t x) {
+    size_t cap = 2;
+    while (cap < x) cap <<= 1;
+    return cap;
+}
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#endif
+}
+
+template<typename Fn, typename Rep, typename Period>
+bool retryFor(Fn&& attempt, std::chrono::duration<Rep, Period> timeout) {
+    for (int i = 0; i < 64; ++i) {
+        if (attempt()) return true;
+        cpuRelax();
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!attempt()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+// A slot tagged with a sequence number: seq == pos means free for the
+// producer at pos, seq == pos + 1 means filled for the consumer at pos.
+// Padded so neighbouring producers do not share a line.
 template<typename T>
-class LockFreeQueue {
+struct alignas(CACHE_LINE) SeqCell {
+    std::atomic<size_t> seq;
+    T value;
+};
+
+}
+
+template<typename T>
+class SpscQueue {
 public:
-    explicit LockFreeQueue(size_t capacityPow2 = 1024)
-        : cap_(roundUpPow2(capacityPow2)),
-          mask_(cap_ - 1),
-          buffer_(cap_),
-          head_(0),
-          tail_(0)
-    {
-        for (size_t i = 0; i < cap_; ++i) {
-            buffer_[i].seq.store(i, std::memory_order_relaxed);
-        }
-    }
+    // Value-initialised, so the ring is faulted in here rather than by the
+    // first pushes on the hot path.
+    explicit SpscQueue(size_t capacityPow2 = 1024)
+        : cap_(lfq::roundUpPow2(capacityPow2)), mask_(cap_ - 1), buffer_(new T[cap_]()) {}
 
     bool push(const T& v) { return emplace(v); }
     bool push(T&& v)      { return emplace(std::move(v)); }
 
+    template<typename U>
+    bool emplace(U&& v) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == cap_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == cap_) return false;
+        }
+        buffer_[tail & mask_] = std::forward<U>(v);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
     bool pop(T& out) {
-        size_t head = head_.load(std::memory_order_acquire);
-        Cell& c = buffer_[head & mask_];
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+        out = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t pushBatch(const T* items, size_t n) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (cap_ - (tail - cachedHead_) < n) cachedHead_ = head_.load(std::memory_order_acquire);
+        size_t k = std::min(n, cap_ - (tail - cachedHead_));
+        for (size_t i = 0; i < k; ++i) buffer_[(tail + i) & mask_] = items[i];
+        if (k) tail_.store(tail + k, std::memory_order_release);
+        return k;
+    }
+
+    size_t popBatch(T* out, size_t max) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ - head < max) cachedTail_ = tail_.load(std::memory_order_acquire);
+        size_t k = std::min(max, cachedTail_ - head);
+        for (size_t i = 0; i < k; ++i) out[i] = std::move(buffer_[(head + i) & mask_]);
+        if (k) head_.store(head + k, std::memory_order_release);
+        return k;
+    }
+
+    template<typename Rep, typename Period>
+    bool pushWait(const T& v, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return push(v); }, timeout);
+    }
+    template<typename Rep, typename Period>
+    bool popWait(T& out, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return pop(out); }, timeout);
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const noexcept { return cap_; }
+
+private:
+    const size_t cap_;
+    const size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+
+    // Producer line: its index and its last view of the consumer's.
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cachedHead_ = 0;
+    // Consumer line.
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cachedTail_ = 0;
+};
+
+template<typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacityPow2 = 1024)
+        : cap_(lfq::roundUpPow2(capacityPow2)), mask_(cap_ - 1), buffer_(new Cell[cap_]) {
+        for (size_t i = 0; i < cap_; ++i) buffer_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& v) { return emplace(v); }
+    bool push(T&& v)      { return emplace(std::move(v)); }
 
-        size_t expected = head + 1;
-        size_t seq = c.seq.load(std::memory_order_acquire);
+    template<typename U>
+    bool emplace(U&& v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = buffer_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::forward<U>(v);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-        if (seq != expected) {
-            return false;
+    // Claims a run of slots with one CAS; the consumer sees each item as
+    // soon as it is written.
+    size_t pushBatch(const T* items, size_t n) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        size_t k;
+        for (;;) {
+            size_t head = head_.load(std::memory_order_acquire);
+            auto used = static_cast<intptr_t>(pos) - static_cast<intptr_t>(head);
+            if (used < 0) {
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            k = std::min(n, cap_ - static_cast<size_t>(used));
+            if (k == 0) return 0;
+            if (tail_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) break;
         }
+        for (size_t i = 0; i < k; ++i) {
+            Cell& c = buffer_[(pos + i) & mask_];
+            c.value = items[i];
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+    }
 
+    bool pop(T& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        Cell& c = buffer_[head & mask_];
+        if (c.seq.load(std::memory_order_acquire) != head + 1) return false;
         out = std::move(c.value);
         c.seq.store(head + cap_, std::memory_order_release);
-        head_.store(head + 1, std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
         return true;
     }
 
+    // Stops at the first slot not yet published, even if later ones are.
+    size_t popBatch(T* out, size_t max) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t k = 0;
+        for (; k < max; ++k) {
+            Cell& c = buffer_[(head + k) & mask_];
+            if (c.seq.load(std::memory_order_acquire) != head + k + 1) break;
+            out[k] = std::move(c.value);
+            c.seq.store(head + k + cap_, std::memory_order_release);
+        }
+        if (k) head_.store(head + k, std::memory_order_release);
+        return k;
+    }
+
+    template<typename Rep, typename Period>
+    bool pushWait(const T& v, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return push(v); }, timeout);
+    }
+    template<typename Rep, typename Period>
+    bool popWait(T& out, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return pop(out); }, timeout);
+    }
+
+    size_t size() const {
+        auto n = static_cast<intptr_t>(tail_.load(std::memory_order_acquire)) -
+                 static_cast<intptr_t>(head_.load(std::memory_order_acquire));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const noexcept { return cap_; }
+
 private:
-    struct Cell {
-        std::atomic<size_t> seq;
-        T value;
-    };
+    using Cell = lfq::SeqCell<T>;
+
+    const size_t cap_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> buffer_;
 
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> tail_{0};
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> head_{0};
+};
+
+template<typename T>
+class LockFreeQueue {
+public:
+    explicit LockFreeQueue(size_t capacityPow2 = 1024)
+        : cap_(lfq::roundUpPow2(capacityPow2)), mask_(cap_ - 1), buffer_(new Cell[cap_]) {
+        for (size_t i = 0; i < cap_; ++i) buffer_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(const T& v) { return emplace(v); }
+    bool push(T&& v)      { return emplace(std::move(v)); }
+
+    // The slot is claimed only once it is known to be free, so a failed
+    // push leaves nothing behind.
     template<typename U>
     bool emplace(U&& v) {
-        size_t pos = tail_.fetch_add(1, std::memory_order_acq_rel);
-        Cell& c = buffer_[pos & mask_];
-
-        size_t expected = pos;
-        size_t seq = c.seq.load(std::memory_order_acquire);
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = buffer_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (dif == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::forward<U>(v);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-        if (seq != expected) {
-            return false;
+    bool pop(T& out) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = buffer_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (dif == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(c.value);
+                    c.seq.store(pos + cap_, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
         }
+    }
 
-        c.value = std::forward<U>(v);
+    size_t pushBatch(const T* items, size_t n) {
+        size_t k = 0;
+        while (k < n && emplace(items[k])) ++k;
+        return k;
+    }
 
-        c.seq.store(pos + 1, std::memory_order_release);
-        return true;
+    size_t popBatch(T* out, size_t max) {
+        size_t k = 0;
+        while (k < max && pop(out[k])) ++k;
+        return k;
     }
 
-    static size_t roundUpPow2(size_t x) {
-        if (x < 2) return 2;
-        --x;
-        x |= x>>1;
-        x |= x>>2;
-        x |= x>>4;
-        x |= x>>8;
-        x |= x>>16;
-        x |= x>>32;
-        return x+1;
+    template<typename Rep, typename Period>
+    bool pushWait(const T& v, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return push(v); }, timeout);
     }
+    template<typename Rep, typename Period>
+    bool popWait(T& out, std::chrono::duration<Rep, Period> timeout) {
+        return lfq::retryFor([&] { return pop(out); }, timeout);
+    }
+
+    size_t size() const {
+        auto n = static_cast<intptr_t>(tail_.load(std::memory_order_acquire)) -
+                 static_cast<intptr_t>(head_.load(std::memory_order_acquire));
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const noexcept { return cap_; }
+
+private:
+    using Cell = lfq::SeqCell<T>;
 
     const size_t cap_;
     const size_t mask_;
-    std::vector<Cell> buffer_;
+    std::unique_ptr<Cell[]> buffer_;
 
-    std::atomic<size_t> head_;
-    std::atomic<size_t> tail_;
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> tail_{0};
+    alignas(lfq::CACHE_LINE) std::atomic<size_t> head_{0};
 };
 
 }
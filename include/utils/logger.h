@@ -1,9 +1,17 @@
 #pragma once
-#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <chrono>
-#include <iostream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "utils/clock.h"
 
 #ifdef UNIT_TEST
 #undef LOG_LEVEL
@@ -14,35 +22,250 @@
 #endif
 #endif
 
+// Each library is built with its own LOG_COMPONENT; code outside them logs
+// as APP.
+#ifndef LOG_COMPONENT
+#define LOG_COMPONENT APP
+#endif
+
 
 namespace utils {
 
+enum class LogLevel : uint8_t {
+    OFF   = 0,
+    ERROR = 1,
+    WARN  = 2,
+    INFO  = 3
+};
+
+enum class LogComponent : uint8_t {
+    CORE,
+    ENGINE,
+    DISPATCH,
+    NET,
+    UTILS,
+    APP,
+    COUNT
+};
+
+class Logger;
+
+namespace logdetail {
+
+// Runtime level per component. LOG_LEVEL stays the compile-time ceiling.
+extern std::atomic<uint8_t> componentLevels[static_cast<size_t>(LogComponent::COUNT)];
+
+enum class ArgType : uint8_t { I64, U64, F64, CHAR, BOOL, STR };
+
+// Arguments are stored raw, a type byte ahead of each; strings are copied.
+inline size_t argSize(bool) { return 2; }
+inline size_t argSize(char) { return 2; }
+inline size_t argSize(std::string_view s) { return 5 + s.size(); }
+// Without these a pointer would convert to bool ahead of string_view.
+inline size_t argSize(const char* s) { return argSize(std::string_view(s ? s : "(null)")); }
+template<typename T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, int> = 0>
+inline size_t argSize(T) { return 9; }
+
+inline char* putArg(char* p, bool v) {
+    *p++ = static_cast<char>(ArgType::BOOL);
+    *p++ = v;
+    return p;
+}
+inline char* putArg(char* p, char v) {
+    *p++ = static_cast<char>(ArgType::CHAR);
+    *p++ = v;
+    return p;
+}
+inline char* putArg(char* p, std::string_view s) {
+    *p++ = static_cast<char>(ArgType::STR);
+    uint32_t len = static_cast<uint32_t>(s.size());
+    std::memcpy(p, &len, 4);
+    std::memcpy(p + 4, s.data(), len);
+    return p + 4 + len;
+}
+inline char* putArg(char* p, const char* s) { return putArg(p, std::string_view(s ? s : "(null)")); }
+template<typename T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value, int> = 0>
+inline char* putArg(char* p, T v) {
+    if constexpr (std::is_enum<T>::value) {
+        return putArg(p, static_cast<uint64_t>(v));
+    } else if constexpr (std::is_floating_point<T>::value) {
+        double d = v;
+        *p++ = static_cast<char>(ArgType::F64);
+        std::memcpy(p, &d, 8);
+    } else if constexpr (std::is_signed<T>::value) {
+        int64_t i = v;
+        *p++ = static_cast<char>(ArgType::I64);
+        std::memcpy(p, &i, 8);
+    } else {
+        uint64_t u = v;
+        *p++ = static_cast<char>(ArgType::U64);
+        std::memcpy(p, &u, 8);
+    }
+    return p + 8;
+}
+
+struct RecordHeader {
+    uint32_t size;      // whole record, padded to 8; level 0 marks wrap padding
+    uint8_t  level;
+    uint8_t  argc;
+    uint16_t reserved;
+    const char* fmt;
+    uint64_t tsc;
+};
+
+// Per-thread single-producer ring of records; the logger's backend is the
+// consumer. A record never wraps: the producer pads to the end instead.
+class LogRing {
+public:
+    static constexpr size_t CAPACITY = 256 * 1024;
+
+    LogRing() : buf_(new char[CAPACITY]) {}
+
+    // Contiguous room for n bytes (a multiple of 8), null when full.
+    char* reserve(size_t n) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        size_t off = tail & (CAPACITY - 1);
+        size_t pad = CAPACITY - off < n ? CAPACITY - off : 0;
+        if (tail + pad + n - cachedHead_ > CAPACITY) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail + pad + n - cachedHead_ > CAPACITY) return nullptr;
+        }
+        // A tail too short for a header is skipped without one.
+        if (pad >= sizeof(RecordHeader)) {
+            RecordHeader h{static_cast<uint32_t>(pad), 0, 0, 0, nullptr, 0};
+            std::memcpy(buf_.get() + off, &h, sizeof(h));
+        }
+        pendingPad_ = pad;
+        return buf_.get() + ((tail + pad) & (CAPACITY - 1));
+    }
+    void commit(size_t n) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + pendingPad_ + n, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> closed{false};
+
+private:
+    friend class ::utils::Logger;
+
+    std::unique_ptr<char[]> buf_;
+    size_t pendingPad_ = 0;
+    uint64_t cachedHead_ = 0;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+};
+
+}
+
+// The whole cost of a disabled log call: one relaxed load, taken before
+// any argument is evaluated.
+inline bool logEnabled(LogComponent component, LogLevel level) {
+    return logdetail::componentLevels[static_cast<size_t>(component)].load(std::memory_order_relaxed) >=
+           static_cast<uint8_t>(level);
+}
+
+// Log calls copy the format's address and the raw arguments into the
+// calling thread's ring and return; a background thread formats ("{}" is
+// replaced by the next argument) and writes in batches. Formats must be
+// string literals. A message that is already a std::string is copied as
+// one argument. When a ring is full the record is dropped and counted.
 class Logger {
 public:
     static Logger& instance();
 
     void setLogFile(const std::string& filename);
     void disableFileLogging();
-    void info(const std::string& msg);
-    void warn(const std::string& msg);
-    void error(const std::string& msg);
+    void info(const std::string& msg)  { log(LogLevel::INFO, msg); }
+    void warn(const std::string& msg)  { log(LogLevel::WARN, msg); }
+    void error(const std::string& msg) { log(LogLevel::ERROR, msg); }
+
+    template<size_t N, typename... Args>
+    void log(LogLevel level, const char (&fmt)[N], const Args&... args) {
+        size_t n = sizeof(logdetail::RecordHeader) + (logdetail::argSize(args) + ... + 0);
+        n = (n + 7) & ~size_t{7};
+        logdetail::LogRing* ring = tlsRing_ ? tlsRing_ : attachThread();
+        char* p = ring->reserve(n);
+        if (!p) {
+            ring->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        logdetail::RecordHeader h{static_cast<uint32_t>(n), static_cast<uint8_t>(level),
+                                  static_cast<uint8_t>(sizeof...(Args)), 0, fmt, Clock::now()};
+        std::memcpy(p, &h, sizeof(h));
+        char* q = p + sizeof(h);
+        ((q = logdetail::putArg(q, args)), ...);
+        (void)q;
+        ring->commit(n);
+        if (stopped_.load(std::memory_order_relaxed)) flush();
+    }
+    void log(LogLevel level, const std::string& msg) { log(level, "{}", std::string_view(msg)); }
+
+    // Formats and writes everything logged so far, on the calling thread.
+    void flush();
+    // Drains the rings and stops the backend; later calls write synchronously.
+    void shutdown();
+    uint64_t droppedMessages() const noexcept { return droppedTotal_.load(std::memory_order_relaxed); }
+
+    static void setLevel(LogComponent component, LogLevel level);
+    static LogLevel level(LogComponent component);
+    // Applies a spec such as "engine=warn,net=info" or "all=error"; entries
+    // are separated by commas or whitespace and '#' starts a comment.
+    // Levels are off, error, warn, info. Nothing changes if any entry is bad.
+    static bool setLevels(const std::string& spec);
+    // Loads levels from path now and again on every SIGHUP (applied by the
+    // backend thread, not in the handler).
+    bool watchLevelFile(const std::string& path);
 
 private:
-    Logger() = default;
-    ~Logger();
+    Logger();
+    ~Logger() = default;
 
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    logdetail::LogRing* attachThread();
+    void backendLoop();
+    size_t drainLocked();
+    void formatRecord(const logdetail::RecordHeader& h, const char* args, std::string& out);
+    void appendTimestamp(uint64_t tsc, std::string& out);
+    void reloadLevelFile();
+    static void onReloadSignal(int);
+
+    inline static thread_local logdetail::LogRing* tlsRing_ = nullptr;
+
+    std::mutex ringsMtx_;
+    std::vector<std::unique_ptr<logdetail::LogRing>> rings_;
+
+    // Consumer side: one drainer at a time.
+    std::mutex drainMtx_;
+    std::string outBuf_;
+    std::string errBuf_;
+    int64_t cachedSec_ = -1;
+    char cachedSecText_[32] = {};
+
     std::mutex mtx_;
     std::ofstream file_;
-    bool toFile_ = false;
+    std::atomic<bool> toFile_{false};
 
-    std::string timestamp();
+    std::thread backend_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopped_{false};
+    std::atomic<uint64_t> droppedTotal_{0};
+
+    std::mutex levelFileMtx_;
+    std::string levelFile_;
+    inline static std::atomic<bool> reloadRequested_{false};
 };
 
 }
 
-#define LOG_ERROR(msg) do { if (LOG_LEVEL >= 1) Logger::instance().error(msg); } while(0)
-#define LOG_WARN(msg)  do { if (LOG_LEVEL >= 2)  Logger::instance().warn(msg);  } while(0)
-#define LOG_INFO(msg)  do { if (LOG_LEVEL >= 3)  Logger::instance().info(msg);  } while(0)
+#define LOG_AT(level, ceiling, ...)                                                          \
+    do {                                                                                     \
+        if (LOG_LEVEL >= ceiling &&                                                          \
+            ::utils::logEnabled(::utils::LogComponent::LOG_COMPONENT, ::utils::LogLevel::level)) \
+            ::utils::Logger::instance().log(::utils::LogLevel::level, __VA_ARGS__);          \
+    } while(0)
+
+#define LOG_ERROR(...) LOG_AT(ERROR, 1, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(WARN, 2, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(INFO, 3, __VA_ARGS__)
@@ -1,19 +1,28 @@
 #pragma once
 #include "dispatch/dispatch_msg.h"
 #include <nlohmann/json.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <string_view>
 
 namespace utils {
 
-inline std::string encodeMsg(const dispatch::DispatchMsg& msg) {
+inline const char* msgTypeName(dispatch::MsgType type) {
+    switch (type) {
+        case dispatch::MsgType::TRADE_REPORT:  return "TRADE_REPORT";
+        case dispatch::MsgType::CANCEL_REPORT: return "CANCEL_REPORT";
+        case dispatch::MsgType::ACK:           return "ACK";
+        default:                               return "UNKNOWN";
+    }
+}
+
+// Reference encoder: builds a DOM and dumps it. Kept for compatibility
+// tests and benchmarks; the hot path uses encodeMsgTo().
+inline std::string encodeMsgJson(const dispatch::DispatchMsg& msg) {
     nlohmann::json j;
-    j["type"] = [msg]() {
-        switch (msg.type) {
-            case dispatch::MsgType::TRADE_REPORT:  return "TRADE_REPORT";
-            case dispatch::MsgType::CANCEL_REPORT: return "CANCEL_REPORT";
-            case dispatch::MsgType::ACK:           return "ACK";
-            default:                               return "UNKNOWN";
-        }
-    }();
+    j["type"] = msgTypeName(msg.type);
 
     if (!msg.symbol.empty()) j["symbol"] = msg.symbol;
     if (msg.price > 0)       j["price"]  = msg.price;
@@ -27,4 +36,116 @@ inline std::string encodeMsg(const dispatch::DispatchMsg& msg) {
     return j.dump();
 }
 
-}
\ No newline at end of file
+namespace detail {
+
+class JsonWriter {
+public:
+    JsonWriter(char* buf, size_t cap) : p_(buf), end_(buf + cap) {}
+
+    bool ok() const noexcept { return ok_; }
+    char* pos() const noexcept { return p_; }
+
+    // Emits `"key":`, preceded by a comma for every field after the first.
+    // The key literal carries both quotes and the colon.
+    void key(std::string_view quotedKeyColon) {
+        if (!first_) put(',');
+        first_ = false;
+        raw(quotedKeyColon);
+    }
+
+    void put(char c) {
+        if (p_ == end_) { ok_ = false; return; }
+        *p_++ = c;
+    }
+
+    void raw(std::string_view s) {
+        if (static_cast<size_t>(end_ - p_) < s.size()) { ok_ = false; p_ = end_; return; }
+        std::memcpy(p_, s.data(), s.size());
+        p_ += s.size();
+    }
+
+    void number(uint64_t v) {
+        auto r = std::to_chars(p_, end_, v);
+        if (r.ec != std::errc()) { ok_ = false; p_ = end_; return; }
+        p_ = r.ptr;
+    }
+
+    // Same grisu2 formatting nlohmann::json::dump() uses, so output stays
+    // byte-identical for every double, not just the shortest-roundtrip ones.
+    void number(double v) {
+        if (!std::isfinite(v)) { raw("null"); return; }
+        if (end_ - p_ < 32) { ok_ = false; p_ = end_; return; }
+        p_ = nlohmann::detail::to_chars(p_, end_, v);
+    }
+
+    void string(std::string_view s) {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (unsigned char c : s) {
+            switch (c) {
+                case '"':  raw("\\\""); break;
+                case '\\': raw("\\\\"); break;
+                case '\b': raw("\\b"); break;
+                case '\f': raw("\\f"); break;
+                case '\n': raw("\\n"); break;
+                case '\r': raw("\\r"); break;
+                case '\t': raw("\\t"); break;
+                default:
+                    if (c < 0x20) {
+                        char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                        raw(std::string_view(esc, sizeof(esc)));
+                    } else {
+                        put(static_cast<char>(c));
+                    }
+            }
+        }
+        put('"');
+    }
+
+private:
+    char* p_;
+    char* end_;
+    bool first_ = true;
+    bool ok_ = true;
+};
+
+}
+
+// Upper bound on the encoded size of msg.
+inline size_t encodedMsgBound(const dispatch::DispatchMsg& msg) {
+    return 256 + 6 * (msg.symbol.size() + msg.status.size() + msg.msg.size());
+}
+
+// Writes the report straight into buf, byte-for-byte what encodeMsgJson()
+// produces (keys in the DOM's sorted order). Returns the number of bytes
+// written, or 0 if buf is too small.
+inline size_t encodeMsgTo(const dispatch::DispatchMsg& msg, char* buf, size_t cap) {
+    detail::JsonWriter w(buf, cap);
+    w.put('{');
+    if (msg.makerId > 0)     { w.key("\"makerId\":"); w.number(msg.makerId); }
+    if (!msg.msg.empty())    { w.key("\"msg\":");     w.string(msg.msg); }
+    if (msg.orderId > 0)     { w.key("\"orderId\":"); w.number(msg.orderId); }
+    if (msg.price > 0)       { w.key("\"price\":");   w.number(msg.price); }
+    if (msg.qty > 0)         { w.key("\"qty\":");     w.number(static_cast<uint64_t>(msg.qty)); }
+    if (!msg.status.empty()) { w.key("\"status\":");  w.string(msg.status); }
+    if (!msg.symbol.empty()) { w.key("\"symbol\":");  w.string(msg.symbol); }
+    if (msg.takerId > 0)     { w.key("\"takerId\":"); w.number(msg.takerId); }
+    w.key("\"type\":");
+    w.string(msgTypeName(msg.type));
+    w.put('}');
+    return w.ok() ? static_cast<size_t>(w.pos() - buf) : 0;
+}
+
+// Reuses out's capacity; no allocation once it has grown to a typical report.
+inline void encodeMsg(const dispatch::DispatchMsg& msg, std::string& out) {
+    out.resize(encodedMsgBound(msg));
+    out.resize(encodeMsgTo(msg, out.data(), out.size()));
+}
+
+inline std::string encodeMsg(const dispatch::DispatchMsg& msg) {
+    std::string out;
+    encodeMsg(msg, out);
+    return out;
+}
+
+}
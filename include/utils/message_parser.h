@@ -3,17 +3,20 @@
 #include "core/order.h"
 #include "utils/logger.h"
 #include <nlohmann/json.hpp>
+#include <string_view>
 
 namespace utils {
 
-inline dispatch::DispatchMsg parseMsg(const std::string& data) {
+// Generic path: full DOM parse. Handles any valid JSON.
+inline dispatch::DispatchMsg parseMsgJson(std::string_view data) {
     dispatch::DispatchMsg msg;
     try {
-        auto j = nlohmann::json::parse(data);
+        auto j = nlohmann::json::parse(data.begin(), data.end());
         std::string type = j.value("type", "UNKNOWN");
 
         if (type == "NEW_ORDER") msg.type = dispatch::MsgType::NEW_ORDER;
         else if (type == "CANCEL_ORDER") msg.type = dispatch::MsgType::CANCEL_ORDER;
+        else if (type == "MODIFY_ORDER") msg.type = dispatch::MsgType::MODIFY_ORDER;
         else if (type == "QUERY_ORDER") msg.type = dispatch::MsgType::QUERY_ORDER;
         else msg.type = dispatch::MsgType::UNKNOWN;
 
@@ -29,4 +32,16 @@ inline dispatch::DispatchMsg parseMsg(const std::string& data) {
     return msg;
 }
 
+// Fast path for flat order objects: scans the payload in place and fills msg
+// exactly as parseMsgJson() would. Returns false, leaving msg untouched, for
+// anything outside that shape (escapes, non-ASCII, nested values, numbers the
+// generic path would coerce, malformed input).
+bool parseOrderFast(std::string_view data, dispatch::DispatchMsg& msg);
+
+inline dispatch::DispatchMsg parseMsg(std::string_view data) {
+    dispatch::DispatchMsg msg;
+    if (parseOrderFast(data, msg)) return msg;
+    return parseMsgJson(data);
+}
+
 }
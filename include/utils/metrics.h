@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+namespace detail {
+// Each thread's counter shard, assigned on its first increment.
+size_t assignMetricShard();
+inline thread_local size_t metricShard = SIZE_MAX;
+}
+
+// Monotonic count, sharded by thread so writers on different threads never
+// share a cache line; value() sums the shards. inc() is a relaxed add on
+// the caller's own line.
+class Counter {
+public:
+    static constexpr size_t SHARDS = 16;
+
+    void inc(uint64_t n = 1) noexcept {
+        size_t s = detail::metricShard;
+        if (s == SIZE_MAX) s = detail::metricShard = detail::assignMetricShard();
+        shards_[s].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const noexcept {
+        uint64_t sum = 0;
+        for (const auto& s : shards_) sum += s.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[SHARDS];
+};
+
+enum class MetricKind : uint8_t {
+    COUNTER,
+    GAUGE
+};
+
+struct MetricSample {
+    std::string name;
+    MetricKind kind;
+    int64_t value;
+};
+
+// Process-wide list of what to report. Components register counters they
+// own and gauges as callbacks sampled on read, so queue depths and pool
+// occupancy cost nothing until someone asks. Names follow Prometheus and
+// may carry labels: engine_inbound_total{engine="0"}. Registration and
+// reads take a lock; updates never touch the registry.
+class MetricsRegistry {
+public:
+    using GaugeFunc = std::function<int64_t()>;
+
+    static MetricsRegistry& instance();
+
+    uint64_t addCounter(std::string name, const Counter& counter);
+    // A count the component already keeps elsewhere.
+    uint64_t addCounter(std::string name, GaugeFunc sample);
+    uint64_t addGauge(std::string name, GaugeFunc sample);
+    // Once this returns no read is still using the metric.
+    void remove(uint64_t id);
+
+    // Grouped by metric name, then sorted by labels.
+    std::vector<MetricSample> snapshot() const;
+    // Prometheus text exposition format.
+    std::string renderText() const;
+
+private:
+    struct Entry {
+        uint64_t id;
+        std::string name;
+        MetricKind kind;
+        const Counter* counter;
+        GaugeFunc sample;
+    };
+
+    uint64_t add(Entry entry);
+
+    mutable std::mutex mtx_;
+    std::vector<Entry> entries_;
+    uint64_t nextId_ = 1;
+};
+
+// A component's registrations, dropped together. Declare it after every
+// member its metrics read, so it is destroyed first.
+class MetricsScope {
+public:
+    MetricsScope() = default;
+    ~MetricsScope() { clear(); }
+
+    MetricsScope(const MetricsScope&) = delete;
+    MetricsScope& operator=(const MetricsScope&) = delete;
+
+    void counter(std::string name, const Counter& counter) {
+        ids_.push_back(MetricsRegistry::instance().addCounter(std::move(name), counter));
+    }
+    void counter(std::string name, MetricsRegistry::GaugeFunc sample) {
+        ids_.push_back(MetricsRegistry::instance().addCounter(std::move(name), std::move(sample)));
+    }
+    void gauge(std::string name, MetricsRegistry::GaugeFunc sample) {
+        ids_.push_back(MetricsRegistry::instance().addGauge(std::move(name), std::move(sample)));
+    }
+    void clear() {
+        for (uint64_t id : ids_) MetricsRegistry::instance().remove(id);
+        ids_.clear();
+    }
+
+private:
+    std::vector<uint64_t> ids_;
+};
+
+// name{label="value"}
+inline std::string labelled(const std::string& name, const std::string& label, const std::string& value) {
+    return name + "{" + label + "=\"" + value + "\"}";
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace utils {
+
+// Where each thread role runs. The spec lists cpus per role:
+//   "engine=2,dispatcher=3,reactor=4-5,pool=6-9,logger=0"
+// The n-th thread of a role takes the n-th listed cpu, wrapping around.
+// Unlisted roles are left to the scheduler. Roles used in the tree:
+// engine, dispatcher, reactor, pool, shm, logger, clock, stats, monitor,
+// replication.
+class Placement {
+public:
+    // False on a malformed spec, which leaves the previous one in place.
+    static bool configure(const std::string& spec);
+    static std::vector<int> cpusFor(const std::string& role);
+
+    // Names the calling thread "<role>-<index>" and pins it if the role
+    // has cpus. Returns the cpu it was pinned to, or -1.
+    static int placeThread(const std::string& role, size_t index = 0);
+
+    // NUMA node of a cpu, or -1 when the machine does not say.
+    static int nodeOfCpu(int cpu);
+    // Node placeThread(role, index) will run on, or -1 if unpinned.
+    static int nodeFor(const std::string& role, size_t index = 0);
+    static int currentNode();
+};
+
+bool pinThread(int cpu);
+// mlockall: every mapped page is faulted in and stays resident. Future
+// mappings are locked too when RLIMIT_MEMLOCK allows it, so a later
+// allocation cannot fail on the limit. False if nothing could be locked.
+bool lockMemory();
+// Truncated to the 15 characters the kernel keeps.
+void nameThread(const std::string& name);
+
+// Pages the calling thread faults in while this is alive come from node,
+// preferring it rather than failing when it is full. Wrap the construction
+// of anything a pinned thread will own, so its memory is local to it.
+class ScopedMemoryNode {
+public:
+    explicit ScopedMemoryNode(int node);
+    ~ScopedMemoryNode();
+
+    ScopedMemoryNode(const ScopedMemoryNode&) = delete;
+    ScopedMemoryNode& operator=(const ScopedMemoryNode&) = delete;
+
+    bool active() const noexcept { return active_; }
+
+private:
+    bool active_ = false;
+};
+
+}
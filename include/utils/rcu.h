@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace utils {
+
+namespace detail {
+
+struct alignas(64) RcuReaderSlot {
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> owned{false};
+};
+
+struct RcuReaderState {
+    RcuReaderSlot* slot = nullptr;
+    uint32_t depth = 0;
+    ~RcuReaderState();
+};
+
+}
+
+// Epoch-based read-copy-update. Readers publish the epoch they entered at in a
+// per-thread slot; writers swap in a new snapshot, then synchronize() waits
+// until every reader that could still see the old one has left.
+class Rcu {
+public:
+    static constexpr size_t MAX_READERS = 512;
+
+    static Rcu& instance();
+
+    class ReadGuard {
+    public:
+        ReadGuard() { Rcu::instance().readLock(); }
+        ~ReadGuard() { Rcu::instance().readUnlock(); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    void readLock() {
+        ReaderState& st = tls_;
+        if (st.depth++ != 0) return;
+        if (!st.slot) st.slot = acquireSlot();
+        st.slot->epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void readUnlock() {
+        ReaderState& st = tls_;
+        if (--st.depth != 0) return;
+        st.slot->epoch.store(0, std::memory_order_release);
+    }
+
+    // Must not be called from inside a read-side critical section.
+    void synchronize();
+
+    // Non-blocking grace periods for deferred reclamation: retire() returns
+    // a ticket after the caller has unpublished an object, and the object
+    // may be freed once elapsed(ticket) is true.
+    uint64_t retire();
+    bool elapsed(uint64_t ticket) const;
+
+private:
+    using ReaderSlot = detail::RcuReaderSlot;
+    using ReaderState = detail::RcuReaderState;
+
+    Rcu() = default;
+
+    ReaderSlot* acquireSlot();
+
+    alignas(64) std::atomic<uint64_t> epoch_{1};
+    ReaderSlot slots_[MAX_READERS];
+
+    static inline thread_local ReaderState tls_;
+};
+
+}
@@ -5,6 +5,8 @@
 namespace utils {
 
 int createListenSocket(const std::string& host, uint16_t port, int backlog = 128);
+int createUnixListenSocket(const std::string& path, int backlog = 8);
+int connectUnixSocket(const std::string& path);
 bool setNonBlocking(int fd);
 bool setReuseAddr(int fd);
 bool setReusePort(int fd);
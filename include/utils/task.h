@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace utils {
+
+// Move-only void() callable. Callables of up to INLINE_SIZE bytes (a
+// pointer, a shared_ptr and a std::string, say) live inside the Task;
+// larger ones go to the heap. Unlike std::function it accepts move-only
+// captures and, for the common case, never allocates.
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 56;
+
+    Task() noexcept = default;
+
+    template<typename F, typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same<Fn, Task>::value>>
+    Task(F&& fn) {
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void*>(buf_)) Fn(std::forward<F>(fn));
+            ops_ = &InlineOps<Fn>::table;
+        } else {
+            *reinterpret_cast<Fn**>(buf_) = new Fn(std::forward<F>(fn));
+            ops_ = &HeapOps<Fn>::table;
+        }
+    }
+
+    Task(Task&& other) noexcept { moveFrom(other); }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+    void operator()() { ops_->invoke(buf_); }
+
+    void reset() noexcept {
+        if (ops_) {
+            ops_->destroy(buf_);
+            ops_ = nullptr;
+        }
+    }
+
+    template<typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Fn>::value;
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*move)(void* dst, void* src) noexcept;   // leaves src destroyed
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template<typename Fn>
+    struct InlineOps {
+        static void invoke(void* self) { (*static_cast<Fn*>(self))(); }
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        }
+        static void destroy(void* self) noexcept { static_cast<Fn*>(self)->~Fn(); }
+        static constexpr Ops table{&invoke, &move, &destroy};
+    };
+
+    template<typename Fn>
+    struct HeapOps {
+        static void invoke(void* self) { (**static_cast<Fn**>(self))(); }
+        static void move(void* dst, void* src) noexcept {
+            *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+        }
+        static void destroy(void* self) noexcept { delete *static_cast<Fn**>(self); }
+        static constexpr Ops table{&invoke, &move, &destroy};
+    };
+
+    void moveFrom(Task& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(buf_, other.buf_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buf_[INLINE_SIZE];
+    const Ops* ops_ = nullptr;
+};
+
+static_assert(sizeof(Task) == 64, "one cache line per task");
+
+}
@@ -2,41 +2,77 @@
 #include <vector>
 #include <thread>
 #include <atomic>
-#include <functional>
-#include <condition_variable>
-#include <queue>
-#include <mutex>
+#include <memory>
+#include "utils/metrics.h"
+#include "utils/task.h"
 
 namespace utils {
 
+// Each worker owns two bounded lock-free queues: a pinned one for keyed
+// tasks, which only that worker runs, and a shared one that idle workers
+// steal from. An idle worker spins, then yields, then parks until a submit
+// wakes it. A full queue spills to an unbounded overflow list that only its
+// owner drains, so a submit never waits: the submitter may be the very
+// worker (or the only thread feeding it) that would have to make room.
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t nThreads = std::thread::hardware_concurrency());
+    explicit ThreadPool(size_t nThreads = std::thread::hardware_concurrency(),
+                        size_t queueCapacity = 1024);
     ~ThreadPool();
 
     void startWorkers();
     void shutdown();
 
+    size_t workerCount() const noexcept { return nThreads_; }
+
+    // Any worker; spreads load round-robin and may be stolen.
     template<typename F>
     bool submitTask(F&& fn) {
-        if (!poolRunning_) return false;
-        {
-            std::lock_guard<std::mutex> lock(mtx_);
-            tasks_.emplace(std::forward<F>(fn));
-        }
-        cv_.notify_one();
-        return true;
+        size_t idx = nextWorker_.fetch_add(1, std::memory_order_relaxed) % nThreads_;
+        return enqueue(idx, false, Task(std::forward<F>(fn)));
+    }
+
+    // Tasks with the same key always run on the same worker, in submission
+    // order. Used to keep a connection's reads ordered and its state warm.
+    template<typename F>
+    bool submitTask(size_t key, F&& fn) {
+        return enqueue(workerFor(key), true, Task(std::forward<F>(fn)));
     }
 
+    size_t workerFor(size_t key) const noexcept {
+        key *= 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>((key >> 32) % nThreads_);
+    }
+
+    // Tasks a worker took from another worker's shared queue.
+    uint64_t stolenTasks() const noexcept { return stolen_.value(); }
+    // Tasks that found their queue full and went to the overflow list.
+    uint64_t spilledTasks() const noexcept { return spilled_.value(); }
+
 private:
+    struct Worker;
+
+    bool enqueue(size_t idx, bool pinned, Task&& task);
+    bool findTask(size_t id, Task& out);
+    bool popOverflow(Worker& w, Task& out);
+    bool hasWork(size_t id) const;
+    void park(size_t id);
+    void wake(Worker& w);
     void runWorkerLoop(size_t id);
+    void registerMetrics();
+    static int nextInstanceId();
 
+    const int id_{nextInstanceId()};
     size_t nThreads_;
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex mtx_;
-    std::condition_variable cv_;
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> nextWorker_{0};
+    std::atomic<size_t> parkedWorkers_{0};
     std::atomic<bool> poolRunning_{false};
+    Counter executed_;
+    Counter stolen_;
+    Counter spilled_;
+    MetricsScope metrics_;
 };
 
 }
@@ -1,6 +1,8 @@
 #include "core/order_book.h"
+#include "utils/clock.h"
 #include "utils/logger.h"
 #include <algorithm>
+#include <stdexcept>
 
 using namespace utils;
 
@@ -9,18 +11,25 @@ namespace core {
 OrderBook::OrderBook(const std::string& symbol, size_t poolSize)
     : symbol_(symbol), orderPool_(poolSize) {}
 
+OrderBook::OrderBook(const std::string& symbol, std::shared_ptr<OrderArena> arena, size_t quota)
+    : symbol_(symbol), orderPool_(std::move(arena), quota) {}
+
 Order* OrderBook::addOrder(Side side, double price, uint32_t qty, uint64_t orderId) {
     Order* order = orderPool_.allocate();
+    if (!order) {
+        LOG_WARN("[OrderBook][{}] order pool full, {} {}@{} not added",
+                 symbol_, side == Side::BUY ? "BUY" : "SELL", qty, price);
+        return nullptr;
+    }
     order->orderId = (orderId == 0) ? nextOrderId_++ : orderId;
     order->side = side;
     order->price = price;
     order->quantity = qty;
 
-    LOG_INFO("[OrderBook][" + symbol_ + "] ADD " +
-                std::string(side == Side::BUY ? "BUY " : "SELL ") +
-                "id=" + std::to_string(order->orderId) +
-                " price=" + std::to_string(price) +
-                " qty=" + std::to_string(qty));
+    if (!shadow_) {
+        LOG_INFO("[OrderBook][{}] ADD {} id={} price={} qty={}",
+                 symbol_, side == Side::BUY ? "BUY" : "SELL", order->orderId, price, qty);
+    }
 
     auto& book = (side == Side::BUY) ? bids_ : asks_;
     auto& level = book[price];
@@ -35,7 +44,7 @@ Order* OrderBook::addOrder(Side side, double price, uint32_t qty, uint64_t order
 bool OrderBook::cancelOrder(uint64_t orderId) {
     auto it = orderIndex_.find(orderId);
     if (it == orderIndex_.end()) {
-        LOG_WARN("[OrderBook][" + symbol_ + "] CANCEL FAIL: order#" + std::to_string(orderId) + " not found");
+        LOG_WARN("[OrderBook][{}] CANCEL FAIL: order#{} not found", symbol_, orderId);
         return false;
     }
 
@@ -43,12 +52,12 @@ bool OrderBook::cancelOrder(uint64_t orderId) {
     auto& book = (order->side == Side::BUY) ? bids_ : asks_;
     auto levelIt = book.find(order->price);
     if (levelIt == book.end()) {
-        LOG_ERROR("[OrderBook][" + symbol_ + "] CANCEL FAIL: price level " + std::to_string(order->price) +
-                  " missing for order#" + std::to_string(orderId));
+        LOG_ERROR("[OrderBook][{}] CANCEL FAIL: price level {} missing for order#{}",
+                  symbol_, order->price, orderId);
         return false;
     }
 
-    LOG_INFO("[OrderBook][" + symbol_ + "] CANCEL order#" + std::to_string(orderId));
+    if (!shadow_) LOG_INFO("[OrderBook][{}] CANCEL order#{}", symbol_, orderId);
 
     levelIt->second.remove(order);
     if (levelIt->second.empty()) book.erase(levelIt);
@@ -59,10 +68,8 @@ bool OrderBook::cancelOrder(uint64_t orderId) {
     return true;
 }
 
-void OrderBook::matchOrder(Side side, double price, uint32_t qty) {
-    LOG_INFO("[OrderBook][" + symbol_ + "] NEW " +
-             std::string(side == Side::BUY ? "BUY " : "SELL ") +
-             std::to_string(qty) + "@" + std::to_string(price));
+uint32_t OrderBook::matchOrder(Side side, double price, uint32_t qty) {
+    if (!shadow_) LOG_INFO("[OrderBook][{}] NEW {} {}@{}", symbol_, side == Side::BUY ? "BUY" : "SELL", qty, price);
 
     Order taker{};
     taker.orderId = nextOrderId_++;
@@ -111,19 +118,23 @@ void OrderBook::matchOrder(Side side, double price, uint32_t qty) {
         if (level.empty()) opposite.erase(bestPrice);
     }
 
+    uint32_t refused = 0;
     if (remaining > 0) {
-        addOrder(side, price, remaining, taker.orderId);
-        LOG_INFO("[OrderBook][" + symbol_ + "] REMAIN " +
-                 std::to_string(remaining) + "@" + std::to_string(price) + " added to book");
+        if (addOrder(side, price, remaining, taker.orderId)) {
+            if (!shadow_) LOG_INFO("[OrderBook][{}] REMAIN {}@{} added to book", symbol_, remaining, price);
+        } else {
+            refused = remaining;
+        }
     }
 
     updateBestPrices();
+    return refused;
 }
 
 void OrderBook::executeTrade(Order* taker, Order* maker, uint32_t tradedQty, double tradePrice)
 {
     if (!maker || !taker || tradedQty == 0) {
-        LOG_WARN("[OrderBook][" + symbol_ + "] executeTrade called with invalid params");
+        LOG_WARN("[OrderBook][{}] executeTrade called with invalid params", symbol_);
         return;
     }
 
@@ -133,18 +144,99 @@ void OrderBook::executeTrade(Order* taker, Order* maker, uint32_t tradedQty, dou
     evt.takerOrderId = taker->orderId;
     evt.price = tradePrice;
     evt.qty = tradedQty;
-    evt.timestamp = static_cast<uint64_t>(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count());
+    evt.timestamp = static_cast<uint64_t>(Clock::wallNs());
 
     tradeEvents_.push_back(std::move(evt));
 
-    LOG_INFO("[OrderBook][" + symbol_ + "] TRADE " +
-                std::to_string(tradedQty) + "@" + std::to_string(tradePrice) +
-                " maker#" + std::to_string(maker->orderId) +
-                " taker#" + std::to_string(taker->orderId));
+    if (!shadow_) {
+        LOG_INFO("[OrderBook][{}] TRADE {}@{} maker#{} taker#{}",
+                 symbol_, tradedQty, tradePrice, maker->orderId, taker->orderId);
+    }
+}
+
+
+void OrderBook::reserve(size_t orders, size_t levelsPerSide) {
+    orderIndex_.reserve(orders);
+    bids_.reserve(levelsPerSide);
+    asks_.reserve(levelsPerSide);
+}
+
+bool OrderBook::shadowWarmUp(size_t orders) {
+    constexpr size_t DEPTH = 16;
+    constexpr double BASE = 1000.0;
+    if (!orderIndex_.empty() || !bids_.empty() || !asks_.empty()) return false;
+    if (orderPool_.quota() < 2 * DEPTH + 2) return false;
+
+    const uint64_t savedNextId = nextOrderId_;
+    const uint64_t savedCommands = commandCount_;
+    shadow_ = true;
+
+    // Each round rests a ladder of asks and bids, cancels one of each, then
+    // sweeps both sides with partial and full fills, leaving them empty.
+    for (size_t done = 0; done < orders; done += 4 * DEPTH + 4) {
+        double offset = static_cast<double>(done % 64) * 0.01;
+        for (size_t i = 0; i < DEPTH; ++i) {
+            matchOrder(Side::SELL, BASE + offset + static_cast<double>(i), 10);
+            matchOrder(Side::BUY, BASE + offset - 1.0 - static_cast<double>(i), 10);
+        }
+        // Null when another book has the arena's last chunks.
+        Order* ask = addOrder(Side::SELL, BASE + offset + DEPTH, 5);
+        Order* bid = addOrder(Side::BUY, BASE + offset - 1.0 - DEPTH, 5);
+        if (ask) cancelOrder(ask->orderId);
+        if (bid) cancelOrder(bid->orderId);
+        for (size_t i = 0; i < DEPTH; ++i) {
+            matchOrder(Side::BUY, BASE + offset + DEPTH, 4);
+            matchOrder(Side::SELL, BASE + offset - 1.0 - DEPTH, 4);
+        }
+        matchOrder(Side::BUY, BASE + offset + DEPTH, 6 * DEPTH);
+        matchOrder(Side::SELL, BASE + offset - 1.0 - DEPTH, 6 * DEPTH);
+        tradeEvents_.clear();
+    }
+
+    shadow_ = false;
+    nextOrderId_ = savedNextId;
+    commandCount_ = savedCommands;
+    updateBestPrices();
+    return orderIndex_.empty() && bids_.empty() && asks_.empty();
+}
+
+BookImage OrderBook::image() const {
+    BookImage img;
+    img.symbol = symbol_;
+    img.nextOrderId = nextOrderId_;
+    img.orders.reserve(orderIndex_.size());
+    for (const auto* book : {&bids_, &asks_}) {
+        for (const auto& [price, level] : *book) {
+            for (const Order* o = level.head; o; o = o->next) {
+                img.orders.push_back({o->orderId, o->side, o->price, o->quantity});
+            }
+        }
+    }
+    return img;
 }
 
+void OrderBook::restore(const BookImage& image) {
+    // Order by order, as shadowWarmUp() does, without logging each one.
+    shadow_ = true;
+    std::vector<uint64_t> ids;
+    ids.reserve(orderIndex_.size());
+    for (const auto& entry : orderIndex_) ids.push_back(entry.first);
+    for (uint64_t id : ids) cancelOrder(id);
+    try {
+        for (const auto& e : image.orders) {
+            if (!addOrder(e.side, e.price, e.qty, e.orderId)) {
+                throw std::runtime_error("order pool too small to restore " + symbol_);
+            }
+        }
+    } catch (...) {
+        shadow_ = false;
+        throw;
+    }
+    shadow_ = false;
+    nextOrderId_ = image.nextOrderId;
+    tradeEvents_.clear();
+    LOG_INFO("[OrderBook][{}] restored {} order(s), next id={}", symbol_, image.orders.size(), nextOrderId_);
+}
 
 void OrderBook::updateBestPrices() {
     bestBid_ = 0.0;
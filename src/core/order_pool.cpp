@@ -0,0 +1,61 @@
+#include "core/order_pool.h"
+
+namespace core {
+
+OrderArena::OrderArena(size_t maxOrders)
+    : maxChunks_(maxOrders ? (maxOrders + CHUNK_ORDERS - 1) / CHUNK_ORDERS : SIZE_MAX) {}
+
+Order* OrderArena::acquireChunk() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!freeChunks_.empty()) {
+        Order* chunk = freeChunks_.back();
+        freeChunks_.pop_back();
+        return chunk;
+    }
+    if (chunks_.size() >= maxChunks_) return nullptr;
+    // Value-initialised: the chunk is faulted in here, by the book's thread.
+    chunks_.push_back(std::make_unique<Order[]>(CHUNK_ORDERS));
+    return chunks_.back().get();
+}
+
+void OrderArena::releaseChunk(Order* chunk) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    freeChunks_.push_back(chunk);
+}
+
+size_t OrderArena::chunksInUse() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return chunks_.size() - freeChunks_.size();
+}
+
+size_t OrderArena::chunksAllocated() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return chunks_.size();
+}
+
+bool OrderPool::grow() {
+    Order* chunk = arena_->acquireChunk();
+    if (!chunk) return false;
+    chunks_.push_back(chunk);
+    linkChunk(chunk);
+    return true;
+}
+
+void OrderPool::linkChunk(Order* chunk) {
+    // Reversed so orders come out in address order.
+    for (size_t i = OrderArena::CHUNK_ORDERS; i-- > 0;) {
+        chunk[i].prev = nullptr;
+        chunk[i].next = freeList_;
+        freeList_ = &chunk[i];
+    }
+}
+
+void OrderPool::trim() {
+    if (inUse_ != 0 || chunks_.size() <= 1) return;
+    for (size_t i = 1; i < chunks_.size(); ++i) arena_->releaseChunk(chunks_[i]);
+    chunks_.resize(1);
+    freeList_ = nullptr;
+    linkChunk(chunks_[0]);
+}
+
+}
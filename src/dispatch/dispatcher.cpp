@@ -2,7 +2,10 @@
 #include "dispatch/dispatcher.h"
 #include "engine/engine_router.h"
 #include "utils/logger.h"
+#include "utils/binary_protocol.h"
 #include "utils/message_encoder.h"
+#include "utils/placement.h"
+#include "utils/rcu.h"
 
 using namespace std::chrono_literals;
 using namespace utils;
@@ -10,26 +13,76 @@ using namespace utils;
 namespace dispatch {
 
 Dispatcher::Dispatcher(size_t queueCapacity)
-    : readyEngines_(queueCapacity) {}
+    : readyEngines_(queueCapacity) { registerMetrics(); }
 
 Dispatcher::~Dispatcher() { stopDispatcher(); }
 
-bool Dispatcher::routeInbound(DispatchMsg&& msg) {
+int Dispatcher::nextInstanceId() {
+    static std::atomic<int> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Dispatcher::registerMetrics() {
+    std::string id = std::to_string(id_);
+    auto name = [&id](const char* metric) { return labelled(metric, "dispatcher", id); };
+
+    metrics_.counter(name("dispatcher_routed_total"), routed_);
+    metrics_.counter(name("dispatcher_route_failed_total"), routeFailed_);
+    metrics_.counter(name("dispatcher_reports_total"), reports_);
+    metrics_.counter(name("dispatcher_send_failed_total"), sendFailed_);
+    metrics_.counter(name("dispatcher_wakeups_total"), [this] { return static_cast<int64_t>(notifications()); });
+    metrics_.gauge(name("dispatcher_ready_engines"), [this] {
+        return static_cast<int64_t>(readyEngines_.size_approx());
+    });
+}
+
+bool Dispatcher::routeInbound(DispatchMsg&& msg, engine::MatchingEngine** target) {
+    // Route and push form one read-side section so a symbol migration can
+    // wait for in-flight pushes to the old engine before fencing it.
+    Rcu::ReadGuard guard;
     auto* engine = engine::EngineRouter::instance().route(msg.symbol);
+    if (target) *target = engine;
     if (!engine) {
         LOG_WARN("[Dispatcher] No engine found for symbol=" + msg.symbol);
+        routeFailed_.inc();
         return false;
     }
-    return engine->pushInbound(std::move(msg));
+    bool ok = engine->pushInbound(std::move(msg));
+    (ok ? routed_ : routeFailed_).inc();
+    return ok;
 }
 
 void Dispatcher::attachEngine(engine::MatchingEngine* engine) {
     engine->setOutboundCallback([this, engine]() {
-        readyEngines_.try_enqueue(engine);
+        readyEngines_.enqueue(engine);
     });
+    // Listeners re-arm sockets and schedule reads; keep that off the
+    // matching thread.
+    engine->setInboundReliefCallback([this, engine]() { relievedEngines_.enqueue(engine); });
     LOG_INFO("[Dispatcher] Registered outbound callback for engine");
 }
 
+size_t Dispatcher::addReliefListener(ReliefFunc listener) {
+    std::lock_guard<std::mutex> lock(reliefMtx_);
+    reliefListeners_.emplace_back(nextReliefId_, std::move(listener));
+    return nextReliefId_++;
+}
+
+void Dispatcher::removeReliefListener(size_t id) {
+    std::lock_guard<std::mutex> lock(reliefMtx_);
+    for (auto it = reliefListeners_.begin(); it != reliefListeners_.end(); ++it) {
+        if (it->first == id) {
+            reliefListeners_.erase(it);
+            return;
+        }
+    }
+}
+
+void Dispatcher::notifyRelief(engine::MatchingEngine* engine) {
+    std::lock_guard<std::mutex> lock(reliefMtx_);
+    for (auto& l : reliefListeners_) l.second(engine);
+}
+
 void Dispatcher::startDispatcher() {
     if (running_.exchange(true)) return;
     loopThread_ = std::thread([this] { dispatchLoop(); });
@@ -43,14 +96,24 @@ void Dispatcher::stopDispatcher() {
 }
 
 void Dispatcher::dispatchLoop() {
+    int cpu = Placement::placeThread("dispatcher", static_cast<size_t>(id_));
+    if (cpu >= 0) LOG_INFO("[Dispatcher] loop pinned to cpu {}", cpu);
     engine::MatchingEngine* eng = nullptr;
     int idleSpins = 0;
     while (running_) {
         bool progressed = false;
         while (readyEngines_.try_dequeue(eng)) {
             progressed = true;
+            notifications_.store(notifications_.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
             processOutbound(*eng);
         }
+        if (progressed && flusher_) flusher_();
+
+        while (relievedEngines_.try_dequeue(eng)) {
+            progressed = true;
+            notifyRelief(eng);
+        }
 
         if (!progressed) {
             if (++idleSpins > 64) {
@@ -64,12 +127,24 @@ void Dispatcher::dispatchLoop() {
 }
 
 void Dispatcher::processOutbound(engine::MatchingEngine& eng) {
+    // Re-arm before draining so a report pushed mid-drain rings again.
+    eng.clearOutboundPending();
     if (!sender_) return;
 
     DispatchMsg msg;
     while (eng.popOutbound(msg)) {
-        std::string encoded = encodeMsg(msg);
-        sender_(msg.fd, encoded);
+        if (msg.protocol == WireProtocol::BINARY) {
+            if (encodeBinaryReport(msg, encodeBuf_) == 0) {
+                LOG_WARN("[Dispatcher] report not encodable in binary, symbol=" + msg.symbol);
+                continue;
+            }
+        } else {
+            // Newline-delimited on the wire, like inbound JSON.
+            encodeMsg(msg, encodeBuf_);
+            encodeBuf_.push_back('\n');
+        }
+        reports_.inc();
+        if (!sender_(msg.sessionId, encodeBuf_)) sendFailed_.inc();
     }
 }
 
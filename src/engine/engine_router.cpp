@@ -1,28 +1,76 @@
 #include "engine/engine_router.h"
 #include "utils/logger.h"
+#include "utils/rcu.h"
 
 using namespace utils;
 
 namespace engine {
 
+namespace {
+
+struct LocalRouteCache {
+    uint64_t version = ~0ull;
+    std::unordered_map<std::string, MatchingEngine*> routes;
+};
+
+LocalRouteCache& localCache() {
+    static thread_local LocalRouteCache cache;
+    return cache;
+}
+
+}
+
 EngineRouter& EngineRouter::instance() {
     static EngineRouter router;
     return router;
 }
 
+EngineRouter::EngineRouter() : routeTable_(new RouteTable()) {}
+
+EngineRouter::~EngineRouter() {
+    delete routeTable_.load(std::memory_order_relaxed);
+}
+
 void EngineRouter::bindSymbolToEngine(const std::string& symbol, MatchingEngine* engine) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    routeTable_[symbol] = engine;
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    auto* next = new RouteTable(*routeTable_.load(std::memory_order_relaxed));
+    (*next)[symbol] = engine;
+
+    const RouteTable* prev = routeTable_.exchange(next, std::memory_order_acq_rel);
+    version_.fetch_add(1, std::memory_order_release);
+
+    Rcu::instance().synchronize();
+    delete prev;
 }
 
 MatchingEngine* EngineRouter::route(const std::string& symbol) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = routeTable_.find(symbol);
-    if (it != routeTable_.end()) {
-        return it->second;
+    auto& cache = localCache();
+    uint64_t v = version_.load(std::memory_order_acquire);
+    if (cache.version != v) {
+        cache.routes.clear();
+        cache.version = v;
+    }
+
+    MatchingEngine* engine = nullptr;
+    auto it = cache.routes.find(symbol);
+    if (it != cache.routes.end()) {
+        engine = it->second;
+    } else {
+        Rcu::ReadGuard guard;
+        const RouteTable* table = routeTable_.load(std::memory_order_acquire);
+        auto rit = table->find(symbol);
+        // Misses are not cached: unknown symbols come from clients, and
+        // caching them would let a client grow every reader's cache.
+        if (rit != table->end()) {
+            engine = rit->second;
+            cache.routes.emplace(symbol, engine);
+        }
+    }
+
+    if (!engine) {
+        LOG_WARN("[EngineRouter] No engine found for symbol=" + symbol);
     }
-    LOG_WARN("[EngineRouter] No engine found for symbol=" + symbol);
-    return nullptr;
+    return engine;
 }
 
 }
@@ -0,0 +1,111 @@
+#include "engine/load_monitor.h"
+#include "engine/symbol_migration.h"
+#include "utils/logger.h"
+#include "utils/placement.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std::chrono;
+using namespace utils;
+
+namespace engine {
+
+LoadMonitor::LoadMonitor(std::vector<MatchingEngine*> engines, Options opts)
+    : engines_(std::move(engines)),
+      opts_(opts),
+      lastSample_(steady_clock::now()),
+      lastBusy_(engines_.size()),
+      utilization_(engines_.size(), 0.0)
+{
+    for (size_t i = 0; i < engines_.size(); ++i) lastBusy_[i] = engines_[i]->busyNanos();
+}
+
+LoadMonitor::~LoadMonitor() { stopMonitor(); }
+
+std::optional<MigrationSuggestion> LoadMonitor::sample() {
+    auto now = steady_clock::now();
+    double wallNs = static_cast<double>(duration_cast<nanoseconds>(now - lastSample_).count());
+    lastSample_ = now;
+    if (engines_.size() < 2 || wallNs <= 0) return std::nullopt;
+
+    std::vector<std::vector<std::pair<std::string, uint64_t>>> deltas(engines_.size());
+    for (size_t i = 0; i < engines_.size(); ++i) {
+        uint64_t busy = engines_[i]->busyNanos();
+        utilization_[i] = std::min(1.0, (busy - lastBusy_[i]) / wallNs);
+        lastBusy_[i] = busy;
+
+        for (auto& load : engines_[i]->symbolLoads()) {
+            uint64_t& prev = lastCommands_[load.symbol];
+            uint64_t delta = load.commands >= prev ? load.commands - prev : load.commands;
+            prev = load.commands;
+            deltas[i].emplace_back(std::move(load.symbol), delta);
+        }
+    }
+
+    auto [coldIt, hotIt] = std::minmax_element(utilization_.begin(), utilization_.end());
+    size_t hot = hotIt - utilization_.begin();
+    size_t cold = coldIt - utilization_.begin();
+    double gap = utilization_[hot] - utilization_[cold];
+    if (utilization_[hot] < opts_.highUtilization || gap < opts_.minImbalance) return std::nullopt;
+
+    // Moving the only symbol of an engine just moves the hotspot.
+    const auto& candidates = deltas[hot];
+    if (candidates.size() < 2) return std::nullopt;
+
+    uint64_t total = 0;
+    for (auto& [sym, d] : candidates) total += d;
+    if (total == 0) return std::nullopt;
+
+    const std::string* best = nullptr;
+    double bestResidual = gap;
+    for (auto& [sym, d] : candidates) {
+        double share = utilization_[hot] * static_cast<double>(d) / total;
+        double residual = std::fabs(gap - 2 * share);
+        if (residual < bestResidual) {
+            bestResidual = residual;
+            best = &sym;
+        }
+    }
+    if (!best) return std::nullopt;
+
+    MigrationSuggestion s;
+    s.symbol = *best;
+    s.from = engines_[hot];
+    s.to = engines_[cold];
+    s.fromUtilization = utilization_[hot];
+    s.toUtilization = utilization_[cold];
+    return s;
+}
+
+void LoadMonitor::startMonitor() {
+    if (running_.exchange(true)) return;
+    monitorThread_ = std::thread([this] { monitorLoop(); });
+}
+
+void LoadMonitor::stopMonitor() {
+    if (!running_.exchange(false)) return;
+    if (monitorThread_.joinable()) monitorThread_.join();
+}
+
+void LoadMonitor::monitorLoop() {
+    Placement::placeThread("monitor");
+    while (running_) {
+        auto deadline = steady_clock::now() + opts_.interval;
+        while (running_ && steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(milliseconds(10));
+        }
+        if (!running_) break;
+
+        auto s = sample();
+        if (!s) continue;
+
+        LOG_INFO("[LoadMonitor] suggest moving symbol=" + s->symbol +
+                 " util " + std::to_string(s->fromUtilization) +
+                 " -> " + std::to_string(s->toUtilization));
+        if (opts_.autoMigrate) {
+            migrateSymbol(s->symbol, *s->from, *s->to);
+        }
+    }
+}
+
+}
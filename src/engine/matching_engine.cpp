@@ -1,4 +1,7 @@
 #include "engine/matching_engine.h"
+#include "utils/clock.h"
+#include "utils/placement.h"
+#include <algorithm>
 #include <chrono>
 
 using namespace std::chrono;
@@ -7,10 +10,44 @@ using namespace dispatch;
 
 namespace engine {
 
+int MatchingEngine::nextInstanceId() {
+    static std::atomic<int> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
 MatchingEngine::~MatchingEngine() { stopEngine(); }
 
-bool MatchingEngine::registerSymbol(const std::string& symbol, size_t poolSize) {
-    auto [it, ok] = orderBooks_.try_emplace(symbol, symbol, poolSize);
+void MatchingEngine::registerMetrics() {
+    std::string id = std::to_string(id_);
+    auto name = [&id](const char* metric) { return labelled(metric, "engine", id); };
+
+    metrics_.counter(name("engine_inbound_total"), [this] {
+        return static_cast<int64_t>(inboundProcessed_.load(std::memory_order_relaxed));
+    });
+    metrics_.counter(name("engine_inbound_rejected_total"), rejected_);
+    metrics_.counter(name("engine_trades_total"), trades_);
+    metrics_.counter(name("engine_reports_total"), reports_);
+    metrics_.counter(name("engine_busy_ns_total"), [this] { return static_cast<int64_t>(busyNanos()); });
+    metrics_.gauge(name("engine_inbound_depth"), [this] {
+        return static_cast<int64_t>(inboundQueue_.size_approx());
+    });
+    metrics_.gauge(name("engine_outbound_depth"), [this] {
+        return static_cast<int64_t>(outboundQueue_.size_approx());
+    });
+    metrics_.gauge(name("engine_congested"), [this] { return inboundCongested() ? 1 : 0; });
+    metrics_.gauge(name("engine_orders_live"), [this] {
+        return static_cast<int64_t>(ordersInUse_.load(std::memory_order_relaxed));
+    });
+    metrics_.gauge(name("engine_order_pool_capacity"), [this] {
+        return static_cast<int64_t>(poolCapacity_.load(std::memory_order_relaxed));
+    });
+    metrics_.gauge(name("engine_order_arena_chunks"), [this] {
+        return static_cast<int64_t>(arena_->chunksInUse());
+    });
+}
+
+bool MatchingEngine::registerSymbol(const std::string& symbol, size_t quota) {
+    auto [it, ok] = orderBooks_.try_emplace(symbol, symbol, arena_, quota);
     if (ok) {
         LOG_INFO("[MatchingEngine] registered symbol=" + symbol);
     } else {
@@ -21,7 +58,46 @@ bool MatchingEngine::registerSymbol(const std::string& symbol, size_t poolSize)
 
 void MatchingEngine::startEngine() {
     if (running_.exchange(true)) return;
-    matchingThread_ = std::thread([this]{ matchingLoop(); });
+    // Calibration blocks ~10 ms; pay it here, not on the first order.
+    Clock::init();
+    std::promise<void> warm;
+    std::future<void> ready = warm.get_future();
+    matchingThread_ = std::thread([this, &warm] {
+        int cpu = Placement::placeThread("engine", static_cast<size_t>(id_));
+        if (cpu >= 0) LOG_INFO("[MatchingEngine] pinned to cpu={} node={}", cpu, Placement::currentNode());
+        try {
+            warmUp();
+        } catch (...) {
+            warm.set_exception(std::current_exception());
+            return;
+        }
+        warm.set_value();
+        matchingLoop();
+    });
+    try {
+        ready.get();
+    } catch (...) {
+        matchingThread_.join();
+        running_.store(false);
+        throw;
+    }
+}
+
+void MatchingEngine::warmUp() {
+    if (warmupOrders_ == 0) return;
+    uint64_t t0 = Clock::now();
+    for (auto& [symbol, ob] : orderBooks_) {
+        if (!ob.shadowWarmUp(warmupOrders_)) {
+            LOG_WARN("[MatchingEngine] book {} not empty, warm-up skipped", symbol);
+        }
+        // Keep the one chunk the book starts trading with. Storage grows
+        // from the arena later, but the index is sized now for what the
+        // quota allows, so it does not rehash as the book fills.
+        ob.trimPool();
+        ob.reserve(std::min(ob.poolQuota(), WARMUP_INDEX_LIMIT), warmupLevels_);
+    }
+    LOG_INFO("[MatchingEngine] warmed {} book(s) with {} shadow orders each in {}us",
+             orderBooks_.size(), warmupOrders_, Clock::toNanos(Clock::now() - t0) / 1000);
 }
 
 void MatchingEngine::stopEngine() {
@@ -30,7 +106,20 @@ void MatchingEngine::stopEngine() {
 }
 
 bool MatchingEngine::pushInbound(DispatchMsg&& msg) {
-    return inboundQueue_.try_enqueue(std::move(msg));
+    bool ok = inboundQueue_.try_enqueue(std::move(msg));
+    if (!ok || (!inboundCongested_.load(std::memory_order_relaxed) &&
+                inboundQueue_.size_approx() >= highWatermark_)) {
+        inboundCongested_.store(true, std::memory_order_release);
+    }
+    return ok;
+}
+
+void MatchingEngine::checkInboundRelief() {
+    if (fencesWaiting_ > 0) return;
+    if (!inboundCongested_.load(std::memory_order_acquire)) return;
+    if (inboundQueue_.size_approx() > lowWatermark_) return;
+    inboundCongested_.store(false, std::memory_order_release);
+    if (inboundReliefCallback_) inboundReliefCallback_();
 }
 
 bool MatchingEngine::popOutbound(DispatchMsg& out) {
@@ -38,22 +127,41 @@ bool MatchingEngine::popOutbound(DispatchMsg& out) {
 }
 
 void MatchingEngine::matchingLoop() {
-    LOG_INFO("[MatchingEngine] thread started, symbols=" + std::to_string(orderBooks_.size()));
+    LOG_INFO("[MatchingEngine] thread started, symbols={}", orderBooks_.size());
     DispatchMsg msg;
     int idleSpins = 0;
+    const uint64_t publishEvery = Clock::fromNanos(100000000);
+    uint64_t lastPublish = Clock::now();
 
     while (running_) {
+        if (restorePending_.load(std::memory_order_acquire)) applyRestore();
+        if (snapshotRequested_.load(std::memory_order_acquire) &&
+            snapshotRequested_.exchange(false, std::memory_order_acq_rel)) {
+            takeSnapshot();
+        }
+        if (incomingReady_.load(std::memory_order_acquire) &&
+            incomingReady_.exchange(false, std::memory_order_acq_rel)) {
+            adoptReadyIncoming();
+        }
+        bool fenced = fencesPending_.load(std::memory_order_acquire) > 0;
+
         bool progressed = false;
-        while (inboundQueue_.try_dequeue(msg)) {
-            inboundProcessed_.fetch_add(1, std::memory_order_relaxed);
-            auto t0 = steady_clock::now();
+        size_t taken = 0;
+        // Bounded, so fences are seen to even while producers that ignore
+        // backpressure keep the queue full.
+        while (taken < drainLimit_ && inboundQueue_.try_dequeue(msg)) {
             progressed = true;
+            processInbound(std::move(msg));
+            // Producers may be refilling as fast as this drains.
+            if ((++taken & 255) == 0) checkInboundRelief();
+        }
+        if (fenced) serviceFences(taken < drainLimit_);
+        checkInboundRelief();
 
-            handleOrderMessage(std::move(msg));
-
-            auto t1 = steady_clock::now();
-            uint64_t ns = duration_cast<nanoseconds>(t1 - t0).count();
-            recordLatency(ns);
+        uint64_t now = Clock::now();
+        if (now - lastPublish >= publishEvery) {
+            publishLoads();
+            lastPublish = now;
         }
 
         if (!progressed) {
@@ -69,13 +177,33 @@ void MatchingEngine::matchingLoop() {
     LOG_INFO("[MatchingEngine] thread stopped");
 }
 
+void MatchingEngine::processInbound(DispatchMsg&& msg) {
+    inboundProcessed_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t t0 = Clock::now();
+
+    uint64_t seq = commandSeq_.load(std::memory_order_relaxed) + 1;
+    if (commandSink_) commandSink_(seq, msg);
+
+    handleOrderMessage(std::move(msg));
+    ringOutboundDoorbell();
+    commandSeq_.store(seq, std::memory_order_release);
+
+    auto ns = static_cast<uint64_t>(Clock::toNanos(Clock::nowOrdered() - t0));
+    recordLatency(ns);
+    busyNs_.store(busyNs_.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
 void MatchingEngine::handleOrderMessage(DispatchMsg&& msg) {
     auto it = orderBooks_.find(msg.symbol);
     if (it == orderBooks_.end()) {
-        LOG_WARN("[MatchingEngine] unknown symbol=" + msg.symbol);
+        if (resolveMigratingSymbol(msg)) return;
+
+        LOG_WARN("[MatchingEngine] unknown symbol={}", msg.symbol);
+        rejected_.inc();
 
         DispatchMsg err;
-        err.fd     = msg.fd;
+        err.sessionId = msg.sessionId;
+        err.protocol = msg.protocol;
         err.type   = MsgType::UNKNOWN;
         err.symbol = msg.symbol;
         err.status = "UNKNOWN_SYMBOL";
@@ -85,6 +213,7 @@ void MatchingEngine::handleOrderMessage(DispatchMsg&& msg) {
         return;
     }
     auto& ob = it->second;
+    ob.noteCommand();
 
     switch (msg.type) {
         case MsgType::NEW_ORDER:
@@ -93,10 +222,15 @@ void MatchingEngine::handleOrderMessage(DispatchMsg&& msg) {
         case MsgType::CANCEL_ORDER:
             handleCancelOrder(msg, ob);
             break;
+        case MsgType::MODIFY_ORDER:
+            handleModifyOrder(msg, ob);
+            break;
         default: {
-            LOG_WARN("[MatchingEngine][" + msg.symbol + "] Unknown msg type");
+            LOG_WARN("[MatchingEngine][{}] Unknown msg type", msg.symbol);
+            rejected_.inc();
             DispatchMsg err;
-            err.fd     = msg.fd;
+            err.sessionId = msg.sessionId;
+            err.protocol = msg.protocol;
             err.type   = MsgType::UNKNOWN;
             err.symbol = msg.symbol;
             err.status = "UNKNOWN_MSGTYPE";
@@ -108,15 +242,15 @@ void MatchingEngine::handleOrderMessage(DispatchMsg&& msg) {
     }
 }
 
-void MatchingEngine::handleCancelOrder(const DispatchMsg& msg, core::OrderBook& ob) {
-    LOG_INFO("[MatchingEngine][" + ob.symbol() + "] CANCEL_REQ"
-             " orderId=" + std::to_string(msg.orderId) +
-             " fd=" + std::to_string(msg.fd));
+bool MatchingEngine::handleCancelOrder(const DispatchMsg& msg, core::OrderBook& ob) {
+    LOG_INFO("[MatchingEngine][{}] CANCEL_REQ orderId={} session={}",
+             ob.symbol(), msg.orderId, msg.sessionId);
 
     bool ok = ob.cancelOrder(msg.orderId);
 
     DispatchMsg resp;
-    resp.fd = msg.fd;
+    resp.sessionId = msg.sessionId;
+    resp.protocol = msg.protocol;
     resp.type = MsgType::CANCEL_REPORT;
     resp.symbol = msg.symbol;
     resp.orderId= msg.orderId;
@@ -126,20 +260,29 @@ void MatchingEngine::handleCancelOrder(const DispatchMsg& msg, core::OrderBook&
         LOG_WARN("[MatchingEngine] outbound queue full!");
     }
 
-    LOG_INFO("[MatchingEngine][" + ob.symbol() + "] CANCEL_REPORT fd="
-             + std::to_string(msg.fd) + " status=" + (ok ? "OK" : "NOT_FOUND"));
+    LOG_INFO("[MatchingEngine][{}] CANCEL_REPORT session={} status={}",
+             ob.symbol(), msg.sessionId, ok ? "OK" : "NOT_FOUND");
+    return ok;
+}
+
+// Cancel-replace: the order loses its queue position and gets a new id.
+// Nothing is re-entered if the original order is already gone.
+void MatchingEngine::handleModifyOrder(const DispatchMsg& msg, core::OrderBook& ob) {
+    LOG_INFO("[MatchingEngine][{}] MODIFY_REQ orderId={} session={}",
+             ob.symbol(), msg.orderId, msg.sessionId);
+
+    if (handleCancelOrder(msg, ob)) handleNewOrder(msg, ob);
 }
 
 void MatchingEngine::handleNewOrder(const DispatchMsg& msg, core::OrderBook& ob) {
-    LOG_INFO("[MatchingEngine][" + ob.symbol() + "] NEW_ORDER"
-             " side=" + std::string(msg.side == core::Side::BUY ? "BUY" : "SELL") +
-             " price=" + std::to_string(msg.price) +
-             " qty=" + std::to_string(msg.qty) +
-             " fd=" + std::to_string(msg.fd));
+    LOG_INFO("[MatchingEngine][{}] NEW_ORDER side={} price={} qty={} session={}",
+             ob.symbol(), msg.side == core::Side::BUY ? "BUY" : "SELL", msg.price, msg.qty,
+             msg.sessionId);
 
     {
         DispatchMsg ack;
-        ack.fd     = msg.fd;
+        ack.sessionId = msg.sessionId;
+        ack.protocol = msg.protocol;
         ack.type   = MsgType::ACK;
         ack.symbol = msg.symbol;
         ack.status = "RECEIVED";
@@ -148,12 +291,14 @@ void MatchingEngine::handleNewOrder(const DispatchMsg& msg, core::OrderBook& ob)
         }
     }
 
-    ob.matchOrder(msg.side, msg.price, msg.qty);
+    uint32_t refused = ob.matchOrder(msg.side, msg.price, msg.qty);
 
+    trades_.inc(ob.getTradeEvents().size());
     for (const auto& evt : ob.getTradeEvents()) {
         DispatchMsg trade;
         trade.type    = MsgType::TRADE_REPORT;
-        trade.fd      = msg.fd;
+        trade.sessionId = msg.sessionId;
+        trade.protocol = msg.protocol;
         trade.symbol  = msg.symbol;
         trade.price   = evt.price;
         trade.qty     = evt.qty;
@@ -163,14 +308,28 @@ void MatchingEngine::handleNewOrder(const DispatchMsg& msg, core::OrderBook& ob)
             LOG_WARN("[MatchingEngine] outbound queue full!");
         }
 
-        LOG_INFO("[MatchingEngine][" + ob.symbol() + "] TRADE_REPORT"
-                 " px=" + std::to_string(evt.price) +
-                 " qty=" + std::to_string(evt.qty) +
-                 " maker=" + std::to_string(evt.makerOrderId) +
-                 " taker=" + std::to_string(evt.takerOrderId));
+        LOG_INFO("[MatchingEngine][{}] TRADE_REPORT px={} qty={} maker={} taker={}",
+                 ob.symbol(), evt.price, evt.qty, evt.makerOrderId, evt.takerOrderId);
     }
 
     ob.clearTradeEvents();
+
+    // Out of order storage: whatever did not fill is rejected, not rested.
+    if (refused > 0) {
+        LOG_WARN("[MatchingEngine][{}] book full, {} of {} rejected session={}",
+                 ob.symbol(), refused, msg.qty, msg.sessionId);
+        rejected_.inc();
+        DispatchMsg err;
+        err.sessionId = msg.sessionId;
+        err.protocol = msg.protocol;
+        err.type   = MsgType::UNKNOWN;
+        err.symbol = msg.symbol;
+        err.qty    = refused;
+        err.status = "BOOK_FULL";
+        if (!pushOutbound(std::move(err))) {
+            LOG_WARN("[MatchingEngine] outbound queue full!");
+        }
+    }
 }
 
 void MatchingEngine::setOutboundCallback(std::function<void()> cb) {
@@ -178,23 +337,287 @@ void MatchingEngine::setOutboundCallback(std::function<void()> cb) {
 }
 
 bool MatchingEngine::pushOutbound(const dispatch::DispatchMsg&& msg) {
-    bool ok = outboundQueue_.try_enqueue(std::move(msg));
-    if (ok && outboundReadyCallback_) outboundReadyCallback_();
+    // Reports must not be dropped: let the queue grow past its initial
+    // capacity rather than lose a fill.
+    bool ok = outboundQueue_.enqueue(std::move(msg));
+    outboundDirty_ |= ok;
+    if (ok) reports_.inc();
     return ok;
 }
 
+void MatchingEngine::ringOutboundDoorbell() {
+    if (!outboundDirty_) return;
+    outboundDirty_ = false;
+    if (!outboundReadyCallback_) return;
+    // Always the RMW: it is ordered against the consumer's clear, so either
+    // we see the flag cleared and ring, or the consumer's drain sees our
+    // reports. A plain load could read a stale true and strand them.
+    if (!outboundPending_.exchange(true, std::memory_order_acq_rel)) outboundReadyCallback_();
+}
+
+bool MatchingEngine::expectIncoming(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(migrationMtx_);
+    return incoming_.try_emplace(symbol).second;
+}
+
+void MatchingEngine::cancelIncoming(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(migrationMtx_);
+    auto it = incoming_.find(symbol);
+    if (it == incoming_.end() || it->second.ready) return;
+    if (it->second.buffered.empty()) {
+        incoming_.erase(it);
+        return;
+    }
+    // Buffered messages are released on this engine's thread, without a book.
+    it->second.ready = true;
+    incomingReady_.store(true, std::memory_order_release);
+}
+
+std::future<bool> MatchingEngine::beginMigrateOut(const std::string& symbol, MatchingEngine* target) {
+    std::lock_guard<std::mutex> lock(migrationMtx_);
+    auto [it, fresh] = outgoing_.try_emplace(symbol);
+    // A second migration would replace the first one's promise.
+    if (!fresh) return {};
+    it->second.target = target;
+    return it->second.done.get_future();
+}
+
+void MatchingEngine::fenceMigrateOut(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(migrationMtx_);
+    auto it = outgoing_.find(symbol);
+    if (it == outgoing_.end() || it->second.fenced) {
+        LOG_WARN("[MatchingEngine] stray migration fence symbol={}", symbol);
+        return;
+    }
+    it->second.fenced = true;
+    fencesPending_.fetch_add(1, std::memory_order_release);
+}
+
+// Every producer that routed a fenced symbol here has finished its push (the
+// route was flipped under an RCU grace period), but the MPMC queue does not
+// order those pushes against anything else. A fence hands over once a batch
+// that started after it ran the queue dry, so no stale message for the
+// symbol can be left behind.
+void MatchingEngine::serviceFences(bool drained) {
+    std::vector<std::string> ready;
+    bool finalDrain = false;
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        for (auto& [symbol, out] : outgoing_) {
+            if (!out.fenced) continue;
+            if (!out.observed) {
+                out.observed = true;
+                continue;
+            }
+            if (drained || out.retries >= FENCE_RETRIES) {
+                finalDrain |= !drained;
+                ready.push_back(symbol);
+                continue;
+            }
+            // Report congestion until the handover so producers that honour
+            // backpressure pause and the queue can run dry.
+            if (out.retries++ == 0) ++fencesWaiting_;
+        }
+    }
+    if (fencesWaiting_ > 0) inboundCongested_.store(true, std::memory_order_release);
+
+    if (finalDrain) {
+        // Out of retries: apply what is queued now, and no more, so inflow
+        // from producers that ignore backpressure cannot hold the fence.
+        DispatchMsg m;
+        for (size_t n = inboundQueue_.size_approx(); n > 0 && inboundQueue_.try_dequeue(m); --n) {
+            processInbound(std::move(m));
+        }
+    }
+    for (const auto& symbol : ready) handOver(symbol, finalDrain);
+}
+
+void MatchingEngine::handOver(const std::string& symbol, bool finalDrain) {
+    MatchingEngine* target = nullptr;
+    std::promise<bool> done;
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        auto it = outgoing_.find(symbol);
+        target = it->second.target;
+        done = std::move(it->second.done);
+        if (it->second.retries > 0) --fencesWaiting_;
+        outgoing_.erase(it);
+    }
+    fencesPending_.fetch_sub(1, std::memory_order_release);
+    if (finalDrain) LOG_WARN("[MatchingEngine] symbol={} handed over under sustained inflow", symbol);
+
+    auto node = orderBooks_.extract(symbol);
+    if (node.empty()) {
+        LOG_WARN("[MatchingEngine] migrate-out of unowned symbol={}", symbol);
+        target->cancelIncoming(symbol);
+        done.set_value(false);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        forwarded_[symbol] = target;
+    }
+
+    target->deliverIncoming(symbol, std::move(node));
+    done.set_value(true);
+
+    LOG_INFO("[MatchingEngine] symbol={} handed over", symbol);
+}
+
+void MatchingEngine::deliverIncoming(const std::string& symbol, BookMap::node_type&& node) {
+    std::lock_guard<std::mutex> lock(migrationMtx_);
+    auto& in = incoming_[symbol];
+    in.ready = true;
+    in.node = std::move(node);
+    incomingReady_.store(true, std::memory_order_release);
+}
+
+void MatchingEngine::adoptReadyIncoming() {
+    std::vector<std::string> ready;
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        for (const auto& [symbol, in] : incoming_) {
+            if (in.ready) ready.push_back(symbol);
+        }
+    }
+    for (const auto& symbol : ready) adoptIncoming(symbol);
+}
+
+void MatchingEngine::adoptIncoming(const std::string& symbol) {
+    std::vector<DispatchMsg> replay;
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        auto it = incoming_.find(symbol);
+        if (it == incoming_.end() || !it->second.ready) return;
+        if (!it->second.node.empty()) {
+            orderBooks_.insert(std::move(it->second.node));
+            forwarded_.erase(symbol);
+        }
+        replay = std::move(it->second.buffered);
+        incoming_.erase(it);
+    }
+
+    LOG_INFO("[MatchingEngine] symbol={} adopted, replaying {} buffered", symbol, replay.size());
+    for (auto& m : replay) handleOrderMessage(std::move(m));
+}
+
+bool MatchingEngine::resolveMigratingSymbol(DispatchMsg& msg) {
+    MatchingEngine* forwardTo = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(migrationMtx_);
+        auto in = incoming_.find(msg.symbol);
+        if (in != incoming_.end()) {
+            if (!in->second.ready) {
+                in->second.buffered.push_back(std::move(msg));
+                return true;
+            }
+        } else {
+            auto fwd = forwarded_.find(msg.symbol);
+            if (fwd == forwarded_.end()) return false;
+            forwardTo = fwd->second;
+        }
+    }
+
+    if (!forwardTo) {
+        // Book delivered but not yet picked up by the loop: adopt it now.
+        adoptIncoming(msg.symbol);
+        if (orderBooks_.count(msg.symbol) == 0) return false;
+        handleOrderMessage(std::move(msg));
+        return true;
+    }
+
+    forwardTo->acceptForwarded(std::move(msg));
+    return true;
+}
+
+// A straggler for a symbol that moved on. Never refused: the pushing thread
+// is another engine's, and two engines waiting on each other's full queues
+// would both stop.
+void MatchingEngine::acceptForwarded(DispatchMsg&& msg) {
+    inboundQueue_.enqueue(std::move(msg));
+    if (inboundQueue_.size_approx() >= highWatermark_) {
+        inboundCongested_.store(true, std::memory_order_release);
+    }
+}
+
+std::future<void> MatchingEngine::restoreSnapshot(uint64_t seq, BookImages books) {
+    auto pending = std::make_unique<PendingRestore>();
+    pending->seq = seq;
+    pending->books = std::move(books);
+    std::future<void> done = pending->done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(restoreMtx_);
+        restore_ = std::move(pending);
+    }
+    restorePending_.store(true, std::memory_order_release);
+    return done;
+}
+
+void MatchingEngine::takeSnapshot() {
+    BookImages books;
+    books.reserve(orderBooks_.size());
+    for (const auto& entry : orderBooks_) books.push_back(entry.second.image());
+    uint64_t seq = commandSeq_.load(std::memory_order_relaxed);
+    LOG_INFO("[MatchingEngine] snapshot of {} book(s) at seq={}", books.size(), seq);
+    if (snapshotSink_) snapshotSink_(seq, std::move(books));
+}
+
+void MatchingEngine::applyRestore() {
+    std::unique_ptr<PendingRestore> pending;
+    {
+        std::lock_guard<std::mutex> lock(restoreMtx_);
+        pending = std::move(restore_);
+        restorePending_.store(false, std::memory_order_relaxed);
+    }
+    if (!pending) return;
+
+    try {
+        for (const auto& image : pending->books) {
+            auto it = orderBooks_.find(image.symbol);
+            if (it == orderBooks_.end()) {
+                registerSymbol(image.symbol);
+                it = orderBooks_.find(image.symbol);
+            }
+            it->second.restore(image);
+        }
+    } catch (...) {
+        pending->done.set_exception(std::current_exception());
+        return;
+    }
+    commandSeq_.store(pending->seq, std::memory_order_release);
+    LOG_INFO("[MatchingEngine] restored {} book(s) at seq={}", pending->books.size(), pending->seq);
+    pending->done.set_value();
+}
+
+void MatchingEngine::publishLoads() {
+    std::vector<SymbolLoad> loads;
+    loads.reserve(orderBooks_.size());
+    uint64_t inUse = 0, capacity = 0;
+    for (auto& [symbol, ob] : orderBooks_) {
+        loads.push_back({symbol, ob.commandCount()});
+        inUse += ob.ordersInUse();
+        // An idle book gives its borrowed chunks back for busier ones.
+        if (ob.ordersInUse() == 0) ob.trimPool();
+        capacity += ob.poolCapacity();
+    }
+    ordersInUse_.store(inUse, std::memory_order_relaxed);
+    poolCapacity_.store(capacity, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(loadMtx_);
+    loads_ = std::move(loads);
+}
+
+std::vector<SymbolLoad> MatchingEngine::symbolLoads() const {
+    std::lock_guard<std::mutex> lock(loadMtx_);
+    return loads_;
+}
+
 void MatchingEngine::recordLatency(uint64_t ns) {
     latencyQueue_.push(ns);
 }
 
 std::vector<uint64_t> MatchingEngine::collectLatency() const {
-    std::vector<uint64_t> out;
-    out.reserve(LAT_BUF);
-
-    uint64_t v;
-    while (latencyQueue_.pop(v)) {
-        out.push_back(v);
-    }
+    std::vector<uint64_t> out(latencyQueue_.size());
+    out.resize(latencyQueue_.popBatch(out.data(), out.size()));
     return out;
 }
 
@@ -0,0 +1,616 @@
+#include "engine/replication.h"
+#include "utils/logger.h"
+#include "utils/placement.h"
+#include "utils/socketops.h"
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+
+using namespace std::chrono;
+using namespace utils;
+using namespace dispatch;
+
+namespace engine {
+
+namespace {
+
+constexpr size_t SEND_BATCH = 512;
+
+// Follower side only: handshake and acks are a few bytes on its own thread.
+bool sendAll(int fd, const void* data, size_t len) {
+    auto* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd pfd{fd, POLLOUT, 0};
+                ::poll(&pfd, 1, 10);
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}
+
+bool encodeReplRecord(uint64_t seq, const DispatchMsg& msg, ReplRecord& out) {
+    if (msg.symbol.size() > sizeof(out.symbol)) return false;
+    out = ReplRecord{};
+    out.seq = seq;
+    out.orderId = msg.orderId;
+    out.price = msg.price;
+    out.qty = msg.qty;
+    out.sessionId = msg.sessionId;
+    out.type = static_cast<uint8_t>(msg.type);
+    out.side = static_cast<uint8_t>(msg.side);
+    out.protocol = static_cast<uint8_t>(msg.protocol);
+    out.symbolLen = static_cast<uint8_t>(msg.symbol.size());
+    std::memcpy(out.symbol, msg.symbol.data(), msg.symbol.size());
+    return true;
+}
+
+DispatchMsg decodeReplRecord(const ReplRecord& rec) {
+    DispatchMsg msg;
+    msg.orderId = rec.orderId;
+    msg.price = rec.price;
+    msg.qty = rec.qty;
+    msg.sessionId = rec.sessionId;
+    msg.type = static_cast<MsgType>(rec.type);
+    msg.side = static_cast<core::Side>(rec.side);
+    msg.protocol = static_cast<WireProtocol>(rec.protocol);
+    msg.symbol.assign(rec.symbol, rec.symbolLen);
+    return msg;
+}
+
+ReplicationPublisher::ReplicationPublisher(const std::string& path)
+    : path_(path), ring_(RING_CAP) {}
+
+ReplicationPublisher::~ReplicationPublisher() {
+    stopPublisher();
+}
+
+void ReplicationPublisher::attach(MatchingEngine& engine) {
+    engine_ = &engine;
+    engine.setCommandSink([this](uint64_t seq, const DispatchMsg& msg) { append(seq, msg); });
+    engine.setSnapshotSink([this](uint64_t seq, MatchingEngine::BookImages&& books) {
+        offerSnapshot(seq, std::move(books));
+    });
+}
+
+void ReplicationPublisher::append(uint64_t seq, const DispatchMsg& msg) {
+    ReplRecord rec;
+    if (!encodeReplRecord(seq, msg, rec)) {
+        // Still publish the sequence number so the backup sees no gap; the
+        // command fails the same way on both sides.
+        DispatchMsg truncated = msg;
+        truncated.symbol.clear();
+        encodeReplRecord(seq, truncated, rec);
+        LOG_ERROR("[Replication] symbol too long to replicate: {}", msg.symbol);
+    }
+    if (!ring_.push(rec)) {
+        // Never stall the engine on replication; the sender sees the hole
+        // and forces the backup to resync.
+        lost_.fetch_add(1, std::memory_order_relaxed);
+        lastLostSeq_.store(seq, std::memory_order_release);
+    }
+    published_.store(seq, std::memory_order_release);
+}
+
+// Engine thread: the sender picks the copy up on its next pass.
+void ReplicationPublisher::offerSnapshot(uint64_t seq, MatchingEngine::BookImages&& books) {
+    std::lock_guard<std::mutex> lock(snapshotMtx_);
+    snapshotSeq_ = seq;
+    snapshotBooks_ = std::move(books);
+    snapshotReady_.store(true, std::memory_order_release);
+}
+
+bool ReplicationPublisher::startPublisher() {
+    if (running_.exchange(true)) return true;
+    listenFd_ = createUnixListenSocket(path_);
+    if (listenFd_ < 0) {
+        running_ = false;
+        return false;
+    }
+    senderThread_ = std::thread([this] { senderLoop(); });
+    LOG_INFO("[Replication] publishing on {}", path_);
+    return true;
+}
+
+void ReplicationPublisher::stopPublisher() {
+    if (!running_.exchange(false)) return;
+    if (senderThread_.joinable()) senderThread_.join();
+    dropBackup();
+    if (pendingFd_ >= 0) {
+        ::close(pendingFd_);
+        pendingFd_ = -1;
+    }
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        ::unlink(path_.c_str());
+        listenFd_ = -1;
+    }
+}
+
+bool ReplicationPublisher::waitForAck(uint64_t seq, milliseconds timeout) const {
+    auto deadline = steady_clock::now() + timeout;
+    while (ackedSeq() < seq) {
+        if (steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(microseconds(50));
+    }
+    return true;
+}
+
+void ReplicationPublisher::senderLoop() {
+    Placement::placeThread("replication");
+    std::vector<ReplRecord> batch(SEND_BATCH);
+    sendBuf_.reserve(SEND_BATCH);
+
+    // Keep flushing after stop so everything already sequenced reaches the
+    // backup before the stream closes (or the backup stalls).
+    while (true) {
+        bool stopping = !running_.load(std::memory_order_acquire);
+        if (backupFd_ < 0) acceptBackup();
+        if (awaitingSnapshot_ && snapshotReady_.load(std::memory_order_acquire)) prepareSnapshot();
+
+        uint64_t lost = lastLostSeq_.load(std::memory_order_acquire);
+        if (lost > resyncFrom_) {
+            resyncFrom_ = lost;
+            while (!retained_.empty() && retained_.front().seq <= lost) retained_.pop_front();
+            LOG_ERROR("[Replication] ring overflowed, stream lost seq={}; backup must resync", lost);
+            if (backupFd_ >= 0) dropBackup();
+        }
+
+        size_t n = ring_.pop(batch.data(), batch.size());
+        for (size_t i = 0; i < n; ++i) {
+            lastTaken_ = batch[i].seq;
+            if (batch[i].seq <= resyncFrom_) continue;
+            retained_.push_back(batch[i]);
+            if (retained_.size() <= MAX_RETAINED) continue;
+            if (backupFd_ >= 0 && !awaitingSnapshot_ && retained_.front().seq > sentSeq_) {
+                LOG_WARN("[Replication] backup fell out of the retained log at seq={}", sentSeq_);
+                dropBackup();
+            }
+            retained_.pop_front();
+        }
+
+        if (backupFd_ >= 0) flushBackup();
+        if (backupFd_ >= 0) readAcks();
+
+        if (n == 0) {
+            if (stopping && !sendPending()) break;
+            std::this_thread::sleep_for(microseconds(20));
+        }
+    }
+}
+
+void ReplicationPublisher::acceptBackup() {
+    // Handshake: the backup announces the last sequence it has applied and
+    // the stream resumes right after it from the retained log. It is read a
+    // piece per pass so a silent peer cannot hold up the sender.
+    if (pendingFd_ < 0) {
+        pendingFd_ = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (pendingFd_ < 0) return;
+        handshakeLen_ = 0;
+        handshakeDeadline_ = steady_clock::now() + HANDSHAKE_TIMEOUT;
+    }
+
+    ssize_t n = ::recv(pendingFd_, handshakeBuf_ + handshakeLen_, sizeof(handshakeBuf_) - handshakeLen_, 0);
+    if (n > 0) handshakeLen_ += static_cast<size_t>(n);
+    bool waiting = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+    if (handshakeLen_ < sizeof(handshakeBuf_)) {
+        if (n == 0 || (n < 0 && !waiting) || steady_clock::now() >= handshakeDeadline_) {
+            LOG_WARN("[Replication] backup handshake failed");
+            ::close(pendingFd_);
+            pendingFd_ = -1;
+        }
+        return;
+    }
+
+    int fd = pendingFd_;
+    pendingFd_ = -1;
+    uint64_t lastSeq;
+    std::memcpy(&lastSeq, handshakeBuf_, sizeof(lastSeq));
+
+    // Records still in the ring will be retained, so an empty log starts
+    // right after the last one taken.
+    uint64_t firstRetained = retained_.empty() ? lastTaken_ + 1 : retained_.front().seq;
+    bool behind = lastSeq < resyncFrom_ || lastSeq + 1 < firstRetained;
+    if (behind && !engine_) {
+        LOG_ERROR("[Replication] backup at seq={} is behind the retained log (first={})",
+                  lastSeq, firstRetained);
+        ::close(fd);
+        return;
+    }
+    if (behind) {
+        LOG_WARN("[Replication] backup at seq={} is behind the retained log (first={}), sending a snapshot",
+                 lastSeq, firstRetained);
+        awaitingSnapshot_ = true;
+        engine_->requestSnapshot();
+    }
+
+    backupFd_ = fd;
+    ackLen_ = 0;
+    sentSeq_ = lastSeq;
+    sentBytes_ = 0;
+    lastProgress_ = steady_clock::now();
+    acked_.store(lastSeq, std::memory_order_release);
+    backupConnected_.store(true, std::memory_order_release);
+    LOG_INFO("[Replication] backup connected at seq={}", lastSeq);
+}
+
+void ReplicationPublisher::prepareSnapshot() {
+    uint64_t seq;
+    MatchingEngine::BookImages books;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMtx_);
+        seq = snapshotSeq_;
+        books = std::move(snapshotBooks_);
+        snapshotReady_.store(false, std::memory_order_relaxed);
+    }
+
+    // The log has to carry on right after the snapshot; one taken before a
+    // later overflow or trim (or left over from an earlier request) is stale.
+    uint64_t firstRetained = retained_.empty() ? lastTaken_ + 1 : retained_.front().seq;
+    if (lastLostSeq_.load(std::memory_order_acquire) > seq || firstRetained > seq + 1) {
+        engine_->requestSnapshot();
+        return;
+    }
+
+    auto record = [seq](ReplKind kind, const std::string& symbol) {
+        ReplRecord rec{};
+        rec.seq = seq;
+        rec.type = static_cast<uint8_t>(kind);
+        rec.symbolLen = static_cast<uint8_t>(symbol.size());
+        std::memcpy(rec.symbol, symbol.data(), symbol.size());
+        return rec;
+    };
+    snapshotRecs_.clear();
+    snapshotRecs_.push_back(record(ReplKind::SNAPSHOT_BEGIN, {}));
+    size_t orders = 0;
+    for (const auto& book : books) {
+        if (book.symbol.size() > sizeof(ReplRecord::symbol)) {
+            LOG_ERROR("[Replication] symbol too long to replicate: {}", book.symbol);
+            continue;
+        }
+        ReplRecord rec = record(ReplKind::SNAPSHOT_BOOK, book.symbol);
+        rec.orderId = book.nextOrderId;
+        snapshotRecs_.push_back(rec);
+        rec.type = static_cast<uint8_t>(ReplKind::SNAPSHOT_ORDER);
+        for (const auto& o : book.orders) {
+            rec.orderId = o.orderId;
+            rec.side = static_cast<uint8_t>(o.side);
+            rec.price = o.price;
+            rec.qty = o.qty;
+            snapshotRecs_.push_back(rec);
+        }
+        orders += book.orders.size();
+    }
+    snapshotRecs_.push_back(record(ReplKind::SNAPSHOT_END, {}));
+
+    awaitingSnapshot_ = false;
+    snapshotSentBytes_ = 0;
+    sentSeq_ = seq;
+    sentBytes_ = 0;
+    snapshotsSent_.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("[Replication] sending snapshot at seq={}: {} book(s), {} order(s)", seq, books.size(), orders);
+}
+
+bool ReplicationPublisher::sendPending() const {
+    if (backupFd_ < 0 || awaitingSnapshot_) return false;
+    return !snapshotRecs_.empty() || (!retained_.empty() && retained_.back().seq > sentSeq_);
+}
+
+// What the socket took, or -1 once nothing more goes out this pass (the
+// backup may have been dropped).
+ssize_t ReplicationPublisher::sendToBackup(const char* data, size_t len, steady_clock::time_point now) {
+    ssize_t n;
+    do {
+        n = ::send(backupFd_, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_WARN("[Replication] send to backup failed: {}", std::strerror(errno));
+            dropBackup();
+        } else if (now - lastProgress_ > BACKUP_STALL) {
+            LOG_WARN("[Replication] backup stopped reading at seq={}, dropping it", sentSeq_);
+            dropBackup();
+        }
+        return -1;
+    }
+    lastProgress_ = now;
+    return n;
+}
+
+void ReplicationPublisher::flushBackup() {
+    // Everything retained past sentSeq_ is owed to the backup; write what
+    // the socket takes and come back for the rest on the next pass.
+    auto now = steady_clock::now();
+    if (awaitingSnapshot_) {
+        // Waiting on the engine, not on the backup.
+        lastProgress_ = now;
+        return;
+    }
+
+    // A snapshot goes out whole before the log that follows it.
+    size_t snapshotBytes = snapshotRecs_.size() * sizeof(ReplRecord);
+    while (snapshotSentBytes_ < snapshotBytes) {
+        ssize_t n = sendToBackup(reinterpret_cast<const char*>(snapshotRecs_.data()) + snapshotSentBytes_,
+                                 snapshotBytes - snapshotSentBytes_, now);
+        if (n < 0) return;
+        snapshotSentBytes_ += static_cast<size_t>(n);
+    }
+    if (snapshotBytes > 0) {
+        snapshotRecs_.clear();
+        snapshotRecs_.shrink_to_fit();
+        snapshotSentBytes_ = 0;
+    }
+
+    while (sendPending()) {
+        auto first = std::upper_bound(retained_.begin(), retained_.end(), sentSeq_,
+                                      [](uint64_t seq, const ReplRecord& r) { return seq < r.seq; });
+        size_t count = std::min<size_t>(SEND_BATCH, static_cast<size_t>(retained_.end() - first));
+        sendBuf_.assign(first, first + static_cast<std::ptrdiff_t>(count));
+
+        const char* data = reinterpret_cast<const char*>(sendBuf_.data()) + sentBytes_;
+        ssize_t n = sendToBackup(data, count * sizeof(ReplRecord) - sentBytes_, now);
+        if (n < 0) return;
+
+        size_t done = sentBytes_ + static_cast<size_t>(n);
+        if (done >= sizeof(ReplRecord)) sentSeq_ = sendBuf_[done / sizeof(ReplRecord) - 1].seq;
+        sentBytes_ = done % sizeof(ReplRecord);
+    }
+    lastProgress_ = now;
+}
+
+void ReplicationPublisher::readAcks() {
+    while (true) {
+        ssize_t n = ::recv(backupFd_, ackBuf_ + ackLen_, sizeof(ackBuf_) - ackLen_, MSG_DONTWAIT);
+        if (n == 0) {
+            LOG_WARN("[Replication] backup disconnected");
+            dropBackup();
+            return;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+            dropBackup();
+            return;
+        }
+        ackLen_ += static_cast<size_t>(n);
+        if (ackLen_ < sizeof(ackBuf_)) continue;
+
+        uint64_t seq;
+        std::memcpy(&seq, ackBuf_, sizeof(seq));
+        ackLen_ = 0;
+        if (seq > acked_.load(std::memory_order_relaxed)) acked_.store(seq, std::memory_order_release);
+        while (!retained_.empty() && retained_.front().seq <= seq) retained_.pop_front();
+    }
+}
+
+void ReplicationPublisher::dropBackup() {
+    if (backupFd_ >= 0) ::close(backupFd_);
+    backupFd_ = -1;
+    awaitingSnapshot_ = false;
+    snapshotRecs_.clear();
+    snapshotSentBytes_ = 0;
+    backupConnected_.store(false, std::memory_order_release);
+}
+
+ReplicationFollower::ReplicationFollower(MatchingEngine& engine, const std::string& path)
+    : engine_(engine), path_(path) {}
+
+ReplicationFollower::~ReplicationFollower() {
+    running_ = false;
+    if (followThread_.joinable()) followThread_.join();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool ReplicationFollower::startFollower(milliseconds connectTimeout) {
+    if (running_.exchange(true)) return true;
+
+    connectTimeout_ = connectTimeout;
+    received_.store(engine_.lastCommandSeq(), std::memory_order_release);
+    if (!connectPrimary()) {
+        running_ = false;
+        return false;
+    }
+
+    followThread_ = std::thread([this] { followLoop(); });
+    LOG_INFO("[Replication] following {} from seq={}", path_, receivedSeq());
+    return true;
+}
+
+bool ReplicationFollower::connectPrimary() {
+    auto deadline = steady_clock::now() + connectTimeout_;
+    while ((fd_ = connectUnixSocket(path_)) < 0) {
+        if (steady_clock::now() >= deadline || !running_.load(std::memory_order_acquire)) {
+            LOG_ERROR("[Replication] cannot reach primary at {}", path_);
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+
+    // The stream resumes right after the last record handed to the engine.
+    uint64_t lastSeq = receivedSeq();
+    if (!sendAll(fd_, &lastSeq, sizeof(lastSeq))) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ReplicationFollower::reconnectPrimary() {
+    ::close(fd_);
+    fd_ = -1;
+    // Whatever part of a snapshot arrived is useless on its own.
+    snapshot_.clear();
+    state_.store(State::FOLLOWING, std::memory_order_release);
+    if (connectPrimary()) return true;
+    state_.store(State::PRIMARY_LOST, std::memory_order_release);
+    return false;
+}
+
+void ReplicationFollower::followLoop() {
+    Placement::placeThread("replication");
+    std::vector<char> buf(SEND_BATCH * sizeof(ReplRecord));
+    size_t len = 0;
+
+    while (running_.load(std::memory_order_acquire)) {
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 1);
+        drainReports();
+        if (ready <= 0) continue;
+
+        ssize_t n = ::recv(fd_, buf.data() + len, buf.size() - len, 0);
+        if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+            // A live primary closes the stream on a backup it cannot serve
+            // from its log and answers the reconnect with a snapshot; only
+            // one that cannot be reached again is lost.
+            LOG_WARN("[Replication] stream from primary closed at seq={}, reconnecting", receivedSeq());
+            len = 0;
+            if (!reconnectPrimary()) {
+                LOG_WARN("[Replication] primary lost at seq={}", receivedSeq());
+                break;
+            }
+            continue;
+        }
+        if (n < 0) continue;
+        len += static_cast<size_t>(n);
+
+        size_t off = 0;
+        bool gap = false;
+        bool diverged = false;
+        for (; off + sizeof(ReplRecord) <= len; off += sizeof(ReplRecord)) {
+            ReplRecord rec;
+            std::memcpy(&rec, buf.data() + off, sizeof(rec));
+            if (rec.type >= static_cast<uint8_t>(ReplKind::SNAPSHOT_BEGIN)) {
+                if (!onSnapshotRecord(rec)) {
+                    diverged = true;
+                    break;
+                }
+                continue;
+            }
+            uint64_t expected = received_.load(std::memory_order_relaxed) + 1;
+            if (rec.seq < expected) continue;
+            if (rec.seq != expected) {
+                LOG_ERROR("[Replication] sequence gap: expected={} got={}, resyncing", expected, rec.seq);
+                gap = true;
+                break;
+            }
+            auto msg = decodeReplRecord(rec);
+            while (!engine_.pushInbound(std::move(msg))) std::this_thread::yield();
+            received_.store(rec.seq, std::memory_order_release);
+        }
+
+        if (diverged) break;
+        if (gap) {
+            // Nothing past the hole is applied; the primary replays from it.
+            len = 0;
+            if (!reconnectPrimary()) break;
+            continue;
+        }
+        std::memmove(buf.data(), buf.data() + off, len - off);
+        len -= off;
+
+        sendAck();
+    }
+}
+
+bool ReplicationFollower::onSnapshotRecord(const ReplRecord& rec) {
+    switch (static_cast<ReplKind>(rec.type)) {
+        case ReplKind::SNAPSHOT_BEGIN:
+            LOG_WARN("[Replication] primary is resending its books at seq={}", rec.seq);
+            state_.store(State::RESYNCING, std::memory_order_release);
+            snapshotSeq_ = rec.seq;
+            snapshot_.clear();
+            return true;
+        case ReplKind::SNAPSHOT_BOOK: {
+            core::BookImage book;
+            book.symbol.assign(rec.symbol, rec.symbolLen);
+            book.nextOrderId = rec.orderId;
+            snapshot_.push_back(std::move(book));
+            return true;
+        }
+        case ReplKind::SNAPSHOT_ORDER:
+            if (!snapshot_.empty()) {
+                snapshot_.back().orders.push_back(
+                    {rec.orderId, static_cast<core::Side>(rec.side), rec.price, rec.qty});
+            }
+            return true;
+        case ReplKind::SNAPSHOT_END:
+            return applySnapshot();
+    }
+    LOG_WARN("[Replication] unknown record type={} ignored", static_cast<int>(rec.type));
+    return true;
+}
+
+bool ReplicationFollower::applySnapshot() {
+    // Commands already pushed are applied first, so none of them lands on
+    // the restored books.
+    uint64_t pushed = received_.load(std::memory_order_relaxed);
+    while (engine_.lastCommandSeq() < pushed) {
+        drainReports();
+        std::this_thread::yield();
+    }
+
+    size_t books = snapshot_.size();
+    auto done = engine_.restoreSnapshot(snapshotSeq_, std::move(snapshot_));
+    snapshot_.clear();
+    while (done.wait_for(milliseconds(1)) != std::future_status::ready) drainReports();
+    try {
+        done.get();
+    } catch (const std::exception& ex) {
+        LOG_ERROR("[Replication] snapshot at seq={} could not be applied: {}; backup diverged",
+                  snapshotSeq_, std::string_view(ex.what()));
+        state_.store(State::DIVERGED, std::memory_order_release);
+        return false;
+    }
+
+    received_.store(snapshotSeq_, std::memory_order_release);
+    resyncs_.fetch_add(1, std::memory_order_relaxed);
+    state_.store(State::FOLLOWING, std::memory_order_release);
+    LOG_INFO("[Replication] resynced {} book(s) at seq={}", books, snapshotSeq_);
+    return true;
+}
+
+void ReplicationFollower::sendAck() {
+    uint64_t seq = received_.load(std::memory_order_relaxed);
+    if (!sendAll(fd_, &seq, sizeof(seq))) {
+        LOG_WARN("[Replication] ack send failed seq={}", seq);
+    }
+}
+
+void ReplicationFollower::drainReports() {
+    DispatchMsg out;
+    while (engine_.popOutbound(out)) {
+        if (reportHandler_) reportHandler_(out);
+    }
+}
+
+uint64_t ReplicationFollower::promote() {
+    running_ = false;
+    if (followThread_.joinable()) followThread_.join();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    uint64_t last = receivedSeq();
+    while (engine_.lastCommandSeq() < last) {
+        drainReports();
+        std::this_thread::yield();
+    }
+    drainReports();
+    LOG_INFO("[Replication] promoted to primary at seq={}", last);
+    return last;
+}
+
+}
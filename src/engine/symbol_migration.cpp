@@ -0,0 +1,53 @@
+#include "engine/symbol_migration.h"
+#include "engine/engine_router.h"
+#include "utils/logger.h"
+
+using namespace utils;
+
+namespace engine {
+
+bool migrateSymbol(const std::string& symbol,
+                   MatchingEngine& from,
+                   MatchingEngine& to,
+                   std::chrono::milliseconds timeout) {
+    if (&from == &to) return false;
+
+    LOG_INFO("[Migration] symbol=" + symbol + " begin");
+
+    // Nothing is touched unless both ends are free for this symbol.
+    if (!to.expectIncoming(symbol)) {
+        LOG_WARN("[Migration] symbol=" + symbol + " rejected: target already has one incoming");
+        return false;
+    }
+    auto done = from.beginMigrateOut(symbol, &to);
+    if (!done.valid()) {
+        to.cancelIncoming(symbol);
+        LOG_WARN("[Migration] symbol=" + symbol + " rejected: migration already in flight");
+        return false;
+    }
+
+    MatchingEngine* previous = EngineRouter::instance().route(symbol);
+    // Returns after an RCU grace period: every push that resolved the old
+    // route has landed in the source queue before the fence is sent.
+    EngineRouter::instance().bindSymbolToEngine(symbol, &to);
+    from.fenceMigrateOut(symbol);
+
+    if (done.wait_for(timeout) != std::future_status::ready) {
+        LOG_WARN("[Migration] symbol=" + symbol + " handover still pending after timeout");
+        return false;
+    }
+
+    if (!done.get()) {
+        // The source had no book to hand over: point the symbol back where it
+        // was and drop the target's reservation (the source already released
+        // anything buffered there).
+        EngineRouter::instance().bindSymbolToEngine(symbol, previous);
+        to.cancelIncoming(symbol);
+        LOG_WARN("[Migration] symbol=" + symbol + " failed: source did not own symbol, route restored");
+        return false;
+    }
+    LOG_INFO("[Migration] symbol=" + symbol + " done");
+    return true;
+}
+
+}
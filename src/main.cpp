@@ -1,50 +1,122 @@
-#include "net/epoll_reactor.h"
+#include "net/reactor.h"
 #include "net/tcp_server.h"
+#include "net/tcp_server_group.h"
+#include "net/shm_gateway.h"
+#include "net/stats_endpoint.h"
+#include "net/stats_segment.h"
 #include "dispatch/dispatcher.h"
 #include "engine/engine_router.h"
 #include "engine/matching_engine.h"
 #include "utils/message_parser.h"
 #include "utils/message_encoder.h"
+#include "utils/clock.h"
 #include "utils/logger.h"
+#include "utils/placement.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
 
 using namespace net;
 using namespace engine;
 using namespace utils;
 using namespace dispatch;
 
+namespace {
 
-int main() {
-    LOG_INFO("=== OrderBook System Starting ===");
+// Parses a positive reactor count; anything else (sign, junk, overflow) fails.
+bool parseReactorCount(const char* text, size_t& out) {
+    if (*text < '0' || *text > '9') return false;
+    char* end = nullptr;
+    errno = 0;
+    unsigned long n = std::strtoul(text, &end, 10);
+    if (errno == ERANGE || *end != '\0' || n == 0) return false;
+    out = n;
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    // Optional arguments: number of reactor threads, then "uring" to run
+    // them on io_uring instead of epoll.
+    size_t reactors = 1;
+    if (argc > 1 && !parseReactorCount(argv[1], reactors)) {
+        // Placement is not configured yet, so this cannot go through the logger.
+        std::cerr << "usage: " << argv[0] << " [reactor-count >= 1] [uring]\n";
+        return 2;
+    }
+    ReactorKind kind = (argc > 2 && std::string(argv[2]) == "uring") ? ReactorKind::IO_URING
+                                                                     : ReactorKind::EPOLL;
+    size_t workers = std::max<size_t>(1, std::thread::hardware_concurrency() / reactors);
+
+    // Thread placement, e.g. ORDERBOOK_CPUS="engine=2,dispatcher=3,reactor=4-5,pool=6-9,logger=0".
+    // Set before the first log line, which starts the logger thread.
+    const char* cpus = std::getenv("ORDERBOOK_CPUS");
+    bool placementOk = !cpus || Placement::configure(cpus);
 
-    net::EpollReactor reactor;
+    // Per-component log levels, e.g. ORDERBOOK_LOG_LEVELS="engine=warn,net=info".
+    // ORDERBOOK_LOG_LEVELS_FILE holds the same syntax and is re-read on SIGHUP.
+    if (const char* spec = std::getenv("ORDERBOOK_LOG_LEVELS")) {
+        if (!Logger::setLevels(spec)) LOG_ERROR("[Main] bad ORDERBOOK_LOG_LEVELS: {}", std::string(spec));
+    }
+    if (const char* file = std::getenv("ORDERBOOK_LOG_LEVELS_FILE")) {
+        Logger::instance().watchLevelFile(file);
+    }
+
+    LOG_INFO("=== OrderBook System Starting ===");
+    if (!placementOk) LOG_ERROR("[Main] bad ORDERBOOK_CPUS: {}", std::string(cpus));
+    if (!Clock::invariantTsc()) LOG_WARN("[Main] no invariant TSC, timestamps may drift between calibrations");
 
     Dispatcher dispatcher(1024);
     dispatcher.startDispatcher();
 
-    auto* engine = new MatchingEngine();
-
-    engine->registerSymbol("AAPL",   100000); 
-    engine->registerSymbol("TESLA",100000); 
+    MatchingEngine* engine;
+    {
+        // Queues, books and order pools come from the engine thread's node.
+        ScopedMemoryNode local(Placement::nodeFor("engine"));
+        engine = new MatchingEngine();
+        engine->registerSymbol("AAPL",   100000); 
+        engine->registerSymbol("TESLA",100000); 
+    }
 
     EngineRouter::instance().bindSymbolToEngine("AAPL", engine);
     EngineRouter::instance().bindSymbolToEngine("TESLA", engine);
 
+    // Pools, rings and tables are all allocated by now: lock them in, then
+    // warm the books before any port opens.
+    if (!lockMemory()) LOG_WARN("[Main] mlockall failed, errno={}; pages may fault under load", errno);
+    engine->setWarmup(10000);
     engine->startEngine();
 
     dispatcher.attachEngine(engine);
 
-    net::TcpServer server(reactor, dispatcher, "0.0.0.0", 9000);
-    server.startServer();
-
-    dispatcher.setSender([&](int fd, const std::string& payload) {
-        auto* conn = server.getConnection(fd);
-        return conn && conn->send(payload);
+    net::TcpServerGroup servers(dispatcher, "0.0.0.0", 9000, reactors, workers, kind);
+    // Colocated clients attach to /dev/shm/orderbook_gateway with ShmClient.
+    net::ShmGateway shmGateway(dispatcher, "/orderbook_gateway");
+    dispatcher.setSender([&](SessionId session, const std::string& payload) {
+        if (net::isShmSession(session)) return shmGateway.queueSend(session, payload);
+        return servers.queueSend(session, payload);
     });
+    dispatcher.setFlusher([&] { servers.flushPending(); });
+
+    // curl localhost:9100/metrics, or map /dev/shm/orderbook_stats.
+    net::StatsEndpoint statsEndpoint(servers.reactor(0), "0.0.0.0", 9100);
+    statsEndpoint.startEndpoint();
+    net::StatsPublisher statsPublisher("/orderbook_stats");
+    statsPublisher.startPublisher();
+
+    servers.startGroup();
+    shmGateway.startGateway();
 
-    LOG_INFO("[Main] Reactor loop started (listening on port 9000)...");
-    reactor.runEventLoop();
+    LOG_INFO("[Main] " + std::to_string(reactors) + " reactor loop(s) started (listening on port 9000)...");
+    servers.joinGroup();
 
     dispatcher.stopDispatcher();
+    shmGateway.stopGateway();
+    statsPublisher.stopPublisher();
     engine->stopEngine();
     LOG_INFO("[Main] OrderBookEngine shutdown.");
     return 0;
@@ -0,0 +1,78 @@
+#include "net/connection_registry.h"
+
+using namespace utils;
+
+namespace net {
+
+ConnectionRegistry::ConnectionRegistry(size_t capacity, uint32_t firstIndex)
+    : slots_(capacity), firstIndex_(firstIndex) {
+    freeSlots_.reserve(capacity);
+    // Hand out low indices first.
+    for (size_t i = capacity; i > 0; --i) freeSlots_.push_back(static_cast<uint32_t>(i - 1));
+}
+
+ConnectionRegistry::~ConnectionRegistry() {
+    // Readers are gone by the time the owner is destroyed.
+    std::lock_guard<std::mutex> lock(mtx_);
+    retired_.clear();
+}
+
+SessionId ConnectionRegistry::add(std::shared_ptr<TcpConnection> conn) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    reclaimLocked();
+    if (freeSlots_.empty()) return dispatch::INVALID_SESSION;
+
+    uint32_t index = freeSlots_.back();
+    freeSlots_.pop_back();
+    Slot& s = slots_[index];
+    s.conn.store(conn.get(), std::memory_order_release);
+    s.owner = std::move(conn);
+    ++live_;
+    return (static_cast<uint64_t>(s.gen.load(std::memory_order_relaxed)) << 32) | (index + firstIndex_);
+}
+
+bool ConnectionRegistry::remove(SessionId id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    uint32_t index = static_cast<uint32_t>(id) - firstIndex_;
+    uint32_t gen = static_cast<uint32_t>(id >> 32);
+    if (index >= slots_.size()) return false;
+    Slot& s = slots_[index];
+    if (s.gen.load(std::memory_order_relaxed) != gen || !s.owner) return false;
+
+    // Generation 0 is skipped so no live id ever equals INVALID_SESSION.
+    uint32_t next = gen + 1 ? gen + 1 : 1;
+    s.gen.store(next, std::memory_order_release);
+    s.conn.store(nullptr, std::memory_order_release);
+    retired_.push_back({Rcu::instance().retire(), std::move(s.owner)});
+    hasRetired_.store(true, std::memory_order_relaxed);
+    freeSlots_.push_back(index);
+    --live_;
+    reclaimLocked();
+    return true;
+}
+
+size_t ConnectionRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return live_;
+}
+
+size_t ConnectionRegistry::retiredCount() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return retired_.size();
+}
+
+void ConnectionRegistry::reclaim() {
+    if (!hasRetired_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    reclaimLocked();
+}
+
+void ConnectionRegistry::reclaimLocked() {
+    // Tickets only grow, so the retired list is ordered by them.
+    size_t done = 0;
+    while (done < retired_.size() && Rcu::instance().elapsed(retired_[done].ticket)) ++done;
+    retired_.erase(retired_.begin(), retired_.begin() + done);
+    hasRetired_.store(!retired_.empty(), std::memory_order_relaxed);
+}
+
+}
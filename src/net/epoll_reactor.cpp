@@ -23,37 +23,46 @@ EpollReactor::~EpollReactor() {
     if (epfd_ >= 0) close(epfd_);
 }
 
-bool EpollReactor::registerEventHandler(int fd, uint32_t events, const EventCallback& cb) {
+bool EpollReactor::registerEventHandler(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) {
+    HandlerTable::Slot* slot = handlers_.add(fd, events, std::move(handler));
+    if (!slot) {
+        LOG_ERROR("[EpollReactor] fd " + std::to_string(fd) + " already registered");
+        return false;
+    }
     struct epoll_event ev{};
     ev.events = events;
-    ev.data.fd = fd;
+    ev.data.ptr = slot;
     if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
         LOG_ERROR("[EpollReactor] epoll_ctl ADD failed: " + std::string(std::strerror(errno)));
+        handlers_.remove(fd);
         return false;
     }
-    callbacks_[fd] = cb;
     return true;
 }
 
 bool EpollReactor::updateEventMask(int fd, uint32_t events) {
+    // Called from other threads as well; the slot of a live fd stays put.
+    HandlerTable::Slot* slot = handlers_.find(fd);
+    if (!slot) return false;
     struct epoll_event ev{};
     ev.events = events;
-    ev.data.fd = fd;
+    ev.data.ptr = slot;
     return epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) == 0;
 }
 
 bool EpollReactor::unregisterEventHandler(int fd) {
-    if (epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr) < 0) {
+    if (!handlers_.remove(fd)) return false;
+    // A closed fd has already left the epoll set.
+    if (epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr) < 0 && errno != EBADF) {
         LOG_ERROR("[EpollReactor] epoll_ctl DEL failed: " + std::string(std::strerror(errno)));
-        return false;
     }
-    callbacks_.erase(fd);
     return true;
 }
 
 void EpollReactor::runEventLoop() {
-    reactorRunning_ = true;
-    while (reactorRunning_) {
+    // Stop is sticky so a stop that races ahead of the loop still ends it;
+    // with a finite timeout the loop notices within timeoutMs.
+    while (!stopRequested_.load(std::memory_order_acquire)) {
         int n = epoll_wait(epfd_, events_.data(), static_cast<int>(events_.size()), timeoutMs_);
 
         if (n == (int)events_.size()) events_.resize(events_.size() * 2);
@@ -64,23 +73,21 @@ void EpollReactor::runEventLoop() {
             break;
         }
         for (int i = 0; i < n; ++i) {
-            int fd = events_[i].data.fd;
-            auto it = callbacks_.find(fd);
-            if (it != callbacks_.end()) {
-                try {
-                    it->second(fd, events_[i].events);
-                } catch (const std::exception& ex) {
-                    LOG_ERROR("[EpollReactor] Exception in callback for fd " +
-                              std::to_string(fd) + ": " + ex.what());
-                } catch (...) {
-                    LOG_ERROR("[EpollReactor] Unknown exception in callback for fd " +
-                              std::to_string(fd));
-                }
+            auto* slot = static_cast<HandlerTable::Slot*>(events_[i].data.ptr);
+            try {
+                dispatchEvent(slot, events_[i].events);
+            } catch (const std::exception& ex) {
+                LOG_ERROR("[EpollReactor] Exception in callback for fd " +
+                          std::to_string(slot->fd) + ": " + ex.what());
+            } catch (...) {
+                LOG_ERROR("[EpollReactor] Unknown exception in callback for fd " +
+                          std::to_string(slot->fd));
             }
         }
+        handlers_.releaseRetired();
     }
 }
 
-void EpollReactor::stopEventLoop() { reactorRunning_ = false; }
+void EpollReactor::stopEventLoop() { stopRequested_.store(true, std::memory_order_release); }
 
 }
\ No newline at end of file
@@ -0,0 +1,724 @@
+#include "net/io_uring_reactor.h"
+#include "utils/logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+using namespace utils;
+
+namespace net {
+
+namespace {
+
+// user_data: operation in the top two bits, then a 30-bit generation and
+// the fd. Operation 3 is left to the fixed tags.
+constexpr uint64_t POLL_OP = 0;
+constexpr uint64_t RECV_OP = 1;
+constexpr uint64_t ACCEPT_OP = 2;
+constexpr uint32_t GEN_MASK = (1u << 30) - 1;
+constexpr uint64_t IGNORE_TAG = ~0ull;
+constexpr uint64_t WAKE_TAG = ~0ull - 1;
+
+constexpr uint16_t RECV_GROUP = 0;
+
+// Poll flags share their values with the EPOLL* readiness bits; the epoll
+// behaviour flags have no POLL_ADD equivalent.
+constexpr uint32_t EPOLL_MODE_FLAGS = EPOLLET | EPOLLONESHOT | EPOLLEXCLUSIVE | EPOLLWAKEUP;
+
+int ioUringSetup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+                 const void* arg, size_t argSize) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete,
+                                      flags, arg, argSize));
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nrArgs) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+uint64_t opTag(uint64_t op, int fd, uint32_t gen) {
+    return (op << 62) | (static_cast<uint64_t>(gen & GEN_MASK) << 32) | static_cast<uint32_t>(fd);
+}
+
+uint32_t bumpGen(uint32_t& next) {
+    uint32_t gen = next;
+    next = (next + 1) & GEN_MASK;
+    return gen;
+}
+
+template<typename T>
+T* ringField(void* base, uint32_t off) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + off);
+}
+
+}
+
+bool IoUringReactor::supported() {
+    io_uring_params p{};
+    int fd = ioUringSetup(4, &p);
+    if (fd < 0) return false;
+    ::close(fd);
+    return (p.features & IORING_FEAT_EXT_ARG) && (p.features & IORING_FEAT_NODROP);
+}
+
+IoUringReactor::IoUringReactor(unsigned entries, int timeoutMs) : timeoutMs_(timeoutMs) {
+    io_uring_params p{};
+    ringFd_ = ioUringSetup(entries, &p);
+    if (ringFd_ < 0) {
+        LOG_ERROR("[IoUringReactor] io_uring_setup failed: " + std::string(std::strerror(errno)));
+        throw std::runtime_error("Failed to create io_uring instance");
+    }
+
+    sqRingSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqRingSize_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    sqesSize_ = p.sq_entries * sizeof(io_uring_sqe);
+
+    void* sqRing = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    void* cqRing = single ? sqRing
+                          : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+    void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+        LOG_ERROR("[IoUringReactor] ring mmap failed: " + std::string(std::strerror(errno)));
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqesSize_);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqRingSize_);
+        if (sqRing != MAP_FAILED) ::munmap(sqRing, sqRingSize_);
+        ::close(ringFd_);
+        throw std::runtime_error("Failed to map io_uring rings");
+    }
+    sqRing_ = sqRing;
+    cqRing_ = cqRing;
+
+    sqHead_    = ringField<unsigned>(sqRing_, p.sq_off.head);
+    sqTail_    = ringField<unsigned>(sqRing_, p.sq_off.tail);
+    sqArray_   = ringField<unsigned>(sqRing_, p.sq_off.array);
+    sqMask_    = *ringField<unsigned>(sqRing_, p.sq_off.ring_mask);
+    sqEntries_ = *ringField<unsigned>(sqRing_, p.sq_off.ring_entries);
+    sqes_      = static_cast<io_uring_sqe*>(sqes);
+
+    cqHead_ = ringField<unsigned>(cqRing_, p.cq_off.head);
+    cqTail_ = ringField<unsigned>(cqRing_, p.cq_off.tail);
+    cqMask_ = *ringField<unsigned>(cqRing_, p.cq_off.ring_mask);
+    cqes_   = ringField<io_uring_cqe>(cqRing_, p.cq_off.cqes);
+
+    // Blocking on purpose: the ring reads it, so the read completes as soon
+    // as another thread writes.
+    wakeFd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        LOG_ERROR("[IoUringReactor] eventfd failed: " + std::string(std::strerror(errno)));
+        throw std::runtime_error("Failed to create io_uring wake eventfd");
+    }
+    batch_.reserve(p.cq_entries);
+    // Before the wake read is queued, so setup can wait on its own requests.
+    completions_ = setupBuffers();
+    armWake();
+}
+
+IoUringReactor::~IoUringReactor() {
+    if (sqes_) ::munmap(sqes_, sqesSize_);
+    if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+    if (sqRing_) ::munmap(sqRing_, sqRingSize_);
+    if (ringFd_ >= 0) ::close(ringFd_);
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+    if (bufRing_) ::munmap(bufRing_, bufRingSize_);
+    if (bufBase_) ::munmap(bufBase_, static_cast<size_t>(RECV_BUFFERS) * RECV_BUFFER_SIZE);
+}
+
+// Constructor only, with nothing else in flight: submits what is queued
+// and takes the one completion it produces.
+bool IoUringReactor::completeNow(io_uring_cqe& out) {
+    unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (ioUringEnter(ringFd_, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) return false;
+    unsigned head = *cqHead_;
+    if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return false;
+    out = cqes_[head & cqMask_];
+    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Receive buffers go to the kernel through a registered buffer ring where
+// it works (5.19), else one PROVIDE_BUFFERS request each (5.7). Some
+// kernels accept the ring and then never select from it, so it is probed
+// with a real recv first. Without either, receivers read on readiness and
+// completesReads() stays false.
+bool IoUringReactor::setupBuffers() {
+    size_t bufSize = static_cast<size_t>(RECV_BUFFERS) * RECV_BUFFER_SIZE;
+    void* bufs = ::mmap(nullptr, bufSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufs == MAP_FAILED) {
+        LOG_WARN("[IoUringReactor] receive buffer mmap failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    bufBase_ = static_cast<char*>(bufs);
+
+    if (setupBufferRing()) return true;
+
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return false;
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(RECV_BUFFERS);
+    sqe->addr = reinterpret_cast<uint64_t>(bufBase_);
+    sqe->len = RECV_BUFFER_SIZE;
+    sqe->off = 0;
+    sqe->buf_group = RECV_GROUP;
+    pushSqe();
+    io_uring_cqe cqe{};
+    if (!completeNow(cqe) || cqe.res < 0) {
+        LOG_INFO("[IoUringReactor] no provided buffers, reads stay readiness-driven");
+        return false;
+    }
+    return true;
+}
+
+bool IoUringReactor::setupBufferRing() {
+    static_assert((RECV_BUFFERS & (RECV_BUFFERS - 1)) == 0, "buffer ring size must be a power of two");
+    size_t ringSize = RECV_BUFFERS * sizeof(io_uring_buf);
+    void* ring = ::mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) return false;
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = RECV_BUFFERS;
+    reg.bgid = RECV_GROUP;
+    if (ioUringRegister(ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        ::munmap(ring, ringSize);
+        return false;
+    }
+    bufRing_ = static_cast<io_uring_buf_ring*>(ring);
+    bufRingSize_ = ringSize;
+    for (unsigned bid = 0; bid < RECV_BUFFERS; ++bid) recycleBuffer(static_cast<uint16_t>(bid));
+
+    int sp[2];
+    bool works = false;
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sp) == 0) {
+        io_uring_sqe* sqe = nextSqe();
+        if (sqe && ::write(sp[1], "", 1) == 1) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = sp[0];
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = RECV_GROUP;
+            pushSqe();
+            io_uring_cqe cqe{};
+            works = completeNow(cqe) && cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER);
+            if (works) recycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+        ::close(sp[0]);
+        ::close(sp[1]);
+    }
+    if (works) return true;
+
+    ioUringRegister(ringFd_, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    ::munmap(ring, ringSize);
+    bufRing_ = nullptr;
+    bufRingSize_ = 0;
+    return false;
+}
+
+void IoUringReactor::recycleBuffer(uint16_t bid) {
+    char* addr = bufBase_ + static_cast<size_t>(bid) * RECV_BUFFER_SIZE;
+    if (bufRing_) {
+        // The ring's tail overlays bufs[0].resv, which is left alone here.
+        io_uring_buf& buf = bufRing_->bufs[bufTail_ & (RECV_BUFFERS - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(addr);
+        buf.len = RECV_BUFFER_SIZE;
+        buf.bid = bid;
+        ++bufTail_;
+        __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+        return;
+    }
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_ERROR("[IoUringReactor] submission queue full, receive buffer " + std::to_string(bid) + " lost");
+        return;
+    }
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->len = RECV_BUFFER_SIZE;
+    sqe->off = bid;
+    sqe->buf_group = RECV_GROUP;
+    sqe->user_data = IGNORE_TAG;
+    pushSqe();
+}
+
+io_uring_sqe* IoUringReactor::nextSqe() {
+    unsigned tail = *sqTail_;
+    if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) {
+        // Full: hand what is queued to the kernel now rather than drop it.
+        ioUringEnter(ringFd_, sqEntries_, 0, 0, nullptr, 0);
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) return nullptr;
+    }
+    unsigned idx = tail & sqMask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[idx] = idx;
+    return sqe;
+}
+
+void IoUringReactor::pushSqe() {
+    __atomic_store_n(sqTail_, *sqTail_ + 1, __ATOMIC_RELEASE);
+}
+
+// A receiver's input comes from its RECV, an acceptor's from its ACCEPT.
+uint32_t IoUringReactor::pollMask(const Watch& w) const {
+    if (w.onAccept) return 0;
+    uint32_t mask = w.events & ~EPOLL_MODE_FLAGS;
+    return w.receiver ? mask & ~EPOLLIN : mask;
+}
+
+void IoUringReactor::armPoll(int fd, Watch& w) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_ERROR("[IoUringReactor] submission queue full, fd=" + std::to_string(fd));
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = pollMask(w);
+    sqe->user_data = opTag(POLL_OP, fd, w.gen);
+    pushSqe();
+    w.armed = true;
+}
+
+void IoUringReactor::removePoll(int fd, const Watch& w) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = opTag(POLL_OP, fd, w.gen);
+    sqe->user_data = IGNORE_TAG;
+    pushSqe();
+}
+
+// A poll not in flight, because its callback is running, is armed here and
+// so not again when the callback returns.
+void IoUringReactor::syncPoll(int fd, Watch& w) {
+    if (w.armed) {
+        removePoll(fd, w);
+        w.gen = bumpGen(nextGen_);
+        w.armed = false;
+    }
+    if (pollMask(w)) armPoll(fd, w);
+}
+
+void IoUringReactor::armRecv(int fd, Watch& w) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_ERROR("[IoUringReactor] submission queue full, fd=" + std::to_string(fd));
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_GROUP;
+    sqe->user_data = opTag(RECV_OP, fd, w.regGen);
+    pushSqe();
+    w.shotArmed = true;
+    w.shotCancelled = false;
+}
+
+void IoUringReactor::armAccept(int fd, Watch& w) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) {
+        LOG_ERROR("[IoUringReactor] submission queue full, fd=" + std::to_string(fd));
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK;
+    sqe->user_data = opTag(ACCEPT_OP, fd, w.regGen);
+    pushSqe();
+    w.shotArmed = true;
+    w.shotCancelled = false;
+}
+
+void IoUringReactor::cancel(uint64_t tag) {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = tag;
+    sqe->user_data = IGNORE_TAG;
+    pushSqe();
+}
+
+// Receiving stops while bytes are held or the stream has ended. A RECV
+// being cancelled is re-armed, if still wanted, by its last completion.
+void IoUringReactor::syncRecv(int fd, Watch& w) {
+    if (!w.receiver) return;
+    bool want = (w.events & EPOLLIN) && w.held.empty() && !w.eof;
+    if (want && !w.shotArmed) {
+        armRecv(fd, w);
+    } else if (!want && w.shotArmed && !w.shotCancelled) {
+        cancel(opTag(RECV_OP, fd, w.regGen));
+        w.shotCancelled = true;
+    }
+}
+
+void IoUringReactor::armWake() {
+    io_uring_sqe* sqe = nextSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeFd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeValue_);
+    sqe->len = sizeof(wakeValue_);
+    sqe->user_data = WAKE_TAG;
+    pushSqe();
+}
+
+IoUringReactor::Watch* IoUringReactor::findWatch(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= watches_.size()) return nullptr;
+    Watch& w = watches_[fd];
+    return w.registered ? &w : nullptr;
+}
+
+// The registration a RECV or ACCEPT was armed for, not one that reused the fd.
+IoUringReactor::Watch* IoUringReactor::findWatch(int fd, uint32_t regGen) {
+    Watch* w = findWatch(fd);
+    return w && w->regGen == regGen ? w : nullptr;
+}
+
+IoUringReactor::Watch* IoUringReactor::addWatch(int fd, uint32_t events) {
+    if (static_cast<size_t>(fd) >= watches_.size()) watches_.resize(fd + 1);
+    Watch& w = watches_[fd];
+    w = Watch{};
+    w.registered = true;
+    w.events = events;
+    w.gen = bumpGen(nextGen_);
+    w.regGen = bumpGen(nextGen_);
+    return &w;
+}
+
+// Before the loop starts the constructing thread owns the rings.
+bool IoUringReactor::onLoopThread() const {
+    std::thread::id loop = loopThread_.load(std::memory_order_acquire);
+    return loop == std::thread::id() || loop == std::this_thread::get_id();
+}
+
+bool IoUringReactor::registerEventHandler(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) {
+    if (fd < 0 || findWatch(fd) || !handlers_.add(fd, events, std::move(handler))) {
+        LOG_ERROR("[IoUringReactor] fd " + std::to_string(fd) + " already registered");
+        return false;
+    }
+    syncPoll(fd, *addWatch(fd, events));
+    return true;
+}
+
+bool IoUringReactor::registerReceiver(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) {
+    if (!completions_) return registerEventHandler(fd, events, std::move(handler));
+    if (fd < 0 || findWatch(fd) || !handlers_.add(fd, events, std::move(handler))) {
+        LOG_ERROR("[IoUringReactor] fd " + std::to_string(fd) + " already registered");
+        return false;
+    }
+    Watch* w = addWatch(fd, events);
+    w->receiver = true;
+    syncPoll(fd, *w);
+    syncRecv(fd, *w);
+    return true;
+}
+
+bool IoUringReactor::registerAcceptor(int listenFd, AcceptCallback onAccept) {
+    if (!completions_) return Reactor::registerAcceptor(listenFd, std::move(onAccept));
+    if (listenFd < 0 || findWatch(listenFd)) {
+        LOG_ERROR("[IoUringReactor] fd " + std::to_string(listenFd) + " already registered");
+        return false;
+    }
+    Watch* w = addWatch(listenFd, EPOLLIN);
+    w->onAccept = std::make_shared<AcceptCallback>(std::move(onAccept));
+    armAccept(listenFd, *w);
+    return true;
+}
+
+bool IoUringReactor::updateEventMask(int fd, uint32_t events) {
+    if (onLoopThread()) return applyEventMask(fd, events);
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx_);
+        pendingMasks_.emplace_back(fd, events);
+    }
+    uint64_t one = 1;
+    return ::write(wakeFd_, &one, sizeof(one)) == sizeof(one);
+}
+
+bool IoUringReactor::applyEventMask(int fd, uint32_t events) {
+    Watch* found = findWatch(fd);
+    if (!found) return false;
+    Watch& w = *found;
+    // Any update hands held bytes over again, as re-applying the mask makes
+    // epoll report a socket its handler left unread.
+    if (w.receiver && (!w.held.empty() || (w.eof && !w.eofDelivered)) && !w.redeliver) {
+        w.redeliver = true;
+        redeliver_.push_back(fd);
+    }
+    if (w.events == events) return true;
+    w.events = events;
+    syncPoll(fd, w);
+    syncRecv(fd, w);
+    return true;
+}
+
+void IoUringReactor::applyPendingMasks() {
+    std::vector<std::pair<int, uint32_t>> masks;
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx_);
+        masks.swap(pendingMasks_);
+    }
+    for (const auto& m : masks) applyEventMask(m.first, m.second);
+}
+
+bool IoUringReactor::unregisterEventHandler(int fd) {
+    Watch* w = findWatch(fd);
+    if (!w) {
+        LOG_ERROR("[IoUringReactor] unregister of unknown fd " + std::to_string(fd));
+        return false;
+    }
+    if (w->armed) removePoll(fd, *w);
+    if (w->shotArmed && !w->shotCancelled) cancel(opTag(w->onAccept ? ACCEPT_OP : RECV_OP, fd, w->regGen));
+    w->registered = false;
+    w->armed = false;
+    w->held.clear();
+    w->onAccept.reset();
+    handlers_.remove(fd);
+    return true;
+}
+
+// One syscall per iteration: submits everything queued since the last call
+// and waits for at least one completion.
+int IoUringReactor::submitAndWait() {
+    unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (timeoutMs_ < 0) {
+        return ioUringEnter(ringFd_, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+    __kernel_timespec ts{};
+    ts.tv_sec = timeoutMs_ / 1000;
+    ts.tv_nsec = static_cast<long long>(timeoutMs_ % 1000) * 1000000;
+    io_uring_getevents_arg arg{};
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+    return ioUringEnter(ringFd_, toSubmit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                        &arg, sizeof(arg));
+}
+
+void IoUringReactor::runEventLoop() {
+    loopThread_.store(std::this_thread::get_id(), std::memory_order_release);
+    while (!stopRequested_.load(std::memory_order_acquire)) {
+        redeliverHeld();
+        if (submitAndWait() < 0 && errno != EINTR && errno != ETIME && errno != EBUSY) {
+            LOG_ERROR("[IoUringReactor] io_uring_enter failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        // Callbacks queue submissions, which may flush a full SQ and post
+        // new completions, so the batch is copied out first.
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        batch_.clear();
+        for (; head != tail; ++head) batch_.push_back(cqes_[head & cqMask_]);
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+        for (const auto& cqe : batch_) handleCompletion(cqe);
+        handlers_.releaseRetired();
+    }
+}
+
+void IoUringReactor::handleCompletion(const io_uring_cqe& cqe) {
+    if (cqe.user_data == IGNORE_TAG) return;
+    if (cqe.user_data == WAKE_TAG) {
+        applyPendingMasks();
+        armWake();
+        return;
+    }
+
+    int fd = static_cast<int>(static_cast<uint32_t>(cqe.user_data));
+    uint32_t gen = static_cast<uint32_t>(cqe.user_data >> 32) & GEN_MASK;
+    switch (cqe.user_data >> 62) {
+        case RECV_OP:   handleRecv(fd, gen, cqe); break;
+        case ACCEPT_OP: handleAccepted(fd, gen, cqe); break;
+        default:        handlePoll(fd, gen, cqe); break;
+    }
+}
+
+void IoUringReactor::handlePoll(int fd, uint32_t gen, const io_uring_cqe& cqe) {
+    Watch* w = findWatch(fd);
+    // Stale: the fd was unregistered or its poll replaced since submission.
+    if (!w || w->gen != gen) return;
+    w->armed = false;
+
+    uint32_t events = cqe.res < 0 ? 0 : static_cast<uint32_t>(cqe.res);
+    // A receiver learns of input, hangup and errors from its RECV; a poll
+    // left with nothing to report waits for the next mask update rather
+    // than spin on a hung-up socket.
+    bool rearm = true;
+    if (w->receiver) {
+        events &= pollMask(*w);
+        rearm = events != 0;
+    }
+
+    if (cqe.res < 0) {
+        LOG_WARN("[IoUringReactor] poll failed for fd " + std::to_string(fd) + ": " +
+                 std::string(std::strerror(-cqe.res)));
+    } else if (events) {
+        try {
+            dispatchEvent(handlers_.find(fd), events);
+        } catch (const std::exception& ex) {
+            LOG_ERROR("[IoUringReactor] Exception in callback for fd " +
+                      std::to_string(fd) + ": " + ex.what());
+        } catch (...) {
+            LOG_ERROR("[IoUringReactor] Unknown exception in callback for fd " +
+                      std::to_string(fd));
+        }
+    }
+
+    // The callback may have unregistered the fd, or unregistered it and had
+    // the number reused by a fresh registration that is already armed.
+    // The vector may have grown, so the watch is looked up again.
+    w = findWatch(fd);
+    if (w && !w->armed && rearm && pollMask(*w)) armPoll(fd, *w);
+}
+
+void IoUringReactor::handleRecv(int fd, uint32_t regGen, const io_uring_cqe& cqe) {
+    const char* data = nullptr;
+    uint16_t bid = 0;
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        data = bufBase_ + static_cast<size_t>(bid) * RECV_BUFFER_SIZE;
+    }
+    Watch* w = findWatch(fd, regGen);
+    if (!w) {
+        if (data) recycleBuffer(bid);
+        return;
+    }
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        w->shotArmed = false;
+        w->shotCancelled = false;
+    }
+
+    if (cqe.res > 0 && data) {
+        size_t len = static_cast<size_t>(cqe.res);
+        if (!w->held.empty()) {
+            w->held.append(data, len);
+        } else {
+            size_t taken = deliver(fd, data, len);
+            w = findWatch(fd, regGen);
+            if (w && taken < len) w->held.assign(data + taken, len - taken);
+        }
+    } else if (cqe.res == -EINVAL && !w->eof) {
+        // Provided buffers without multishot recv (5.19): this receiver,
+        // and every later one, reads on readiness instead.
+        LOG_WARN("[IoUringReactor] multishot recv unsupported, fd " + std::to_string(fd) +
+                 " falls back to readiness");
+        completions_ = false;
+        w->receiver = false;
+        syncPoll(fd, *w);
+        return;
+    } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        w->eof = true;
+    }
+    if (data) recycleBuffer(bid);
+    settleRecv(fd, regGen);
+}
+
+void IoUringReactor::settleRecv(int fd, uint32_t regGen) {
+    Watch* w = findWatch(fd, regGen);
+    if (!w) return;
+    if (w->eof && w->held.empty() && !w->eofDelivered) {
+        w->eofDelivered = true;
+        deliver(fd, nullptr, 0);
+        w = findWatch(fd, regGen);
+        if (!w) return;
+    }
+    syncRecv(fd, *w);
+}
+
+void IoUringReactor::redeliverHeld() {
+    if (redeliver_.empty()) return;
+    std::vector<int> fds;
+    fds.swap(redeliver_);
+    for (int fd : fds) {
+        Watch* w = findWatch(fd);
+        if (!w || !w->redeliver) continue;
+        w->redeliver = false;
+        uint32_t regGen = w->regGen;
+        if (!w->held.empty()) {
+            std::string held;
+            held.swap(w->held);
+            size_t taken = deliver(fd, held.data(), held.size());
+            w = findWatch(fd, regGen);
+            if (!w) continue;
+            if (taken < held.size()) {
+                w->held = held.substr(taken);
+                continue;
+            }
+        }
+        settleRecv(fd, regGen);
+    }
+}
+
+size_t IoUringReactor::deliver(int fd, const char* data, size_t len) {
+    HandlerTable::Slot* slot = handlers_.find(fd);
+    if (!slot || !slot->live) return len;
+    try {
+        return slot->handler->handleData(fd, data, len);
+    } catch (const std::exception& ex) {
+        LOG_ERROR("[IoUringReactor] Exception in callback for fd " +
+                  std::to_string(fd) + ": " + ex.what());
+    } catch (...) {
+        LOG_ERROR("[IoUringReactor] Unknown exception in callback for fd " +
+                  std::to_string(fd));
+    }
+    return len;
+}
+
+void IoUringReactor::handleAccepted(int fd, uint32_t regGen, const io_uring_cqe& cqe) {
+    Watch* w = findWatch(fd, regGen);
+    if (!w || !w->onAccept) {
+        if (cqe.res >= 0) ::close(cqe.res);
+        return;
+    }
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        w->shotArmed = false;
+        w->shotCancelled = false;
+    }
+
+    if (cqe.res >= 0) {
+        // Held by reference count: the callback may unregister the listener.
+        std::shared_ptr<AcceptCallback> onAccept = w->onAccept;
+        try {
+            (*onAccept)(cqe.res);
+        } catch (const std::exception& ex) {
+            LOG_ERROR("[IoUringReactor] Exception in accept callback for fd " +
+                      std::to_string(fd) + ": " + ex.what());
+        } catch (...) {
+            LOG_ERROR("[IoUringReactor] Unknown exception in accept callback for fd " +
+                      std::to_string(fd));
+        }
+    } else if (cqe.res != -ECANCELED) {
+        LOG_WARN("[IoUringReactor] accept failed on fd " + std::to_string(fd) + ": " +
+                 std::string(std::strerror(-cqe.res)));
+    }
+
+    w = findWatch(fd, regGen);
+    if (w && !w->shotArmed) armAccept(fd, *w);
+}
+
+void IoUringReactor::stopEventLoop() {
+    stopRequested_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    (void)!::write(wakeFd_, &one, sizeof(one));
+}
+
+}
@@ -0,0 +1,105 @@
+#include "net/reactor.h"
+#include "net/epoll_reactor.h"
+#include "net/io_uring_reactor.h"
+#include "utils/logger.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace utils;
+
+namespace net {
+
+namespace {
+
+class CallbackHandler final : public EventHandler {
+public:
+    explicit CallbackHandler(const EventCallback& cb) : cb_(cb) {}
+    void handleEvent(int fd, uint32_t events) override { cb_(fd, events); }
+
+private:
+    EventCallback cb_;
+};
+
+}
+
+HandlerTable::~HandlerTable() {
+    for (auto& chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+}
+
+HandlerTable::Entry* HandlerTable::entry(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= CHUNK_SIZE * MAX_CHUNKS) return nullptr;
+    auto& chunk = chunks_[fd / CHUNK_SIZE];
+    Entry* entries = chunk.load(std::memory_order_relaxed);
+    if (!entries) {
+        entries = new Entry[CHUNK_SIZE]();
+        chunk.store(entries, std::memory_order_release);
+    }
+    return &entries[fd % CHUNK_SIZE];
+}
+
+HandlerTable::Slot* HandlerTable::add(int fd, uint32_t events, std::unique_ptr<EventHandler> handler) {
+    Entry* e = entry(fd);
+    if (!e || e->load(std::memory_order_relaxed)) return nullptr;
+
+    Slot* slot;
+    if (!free_.empty()) {
+        slot = free_.back();
+        free_.pop_back();
+    } else {
+        slots_.push_back(std::make_unique<Slot>());
+        slot = slots_.back().get();
+    }
+    slot->fd = fd;
+    slot->events = events;
+    slot->handler = std::move(handler);
+    slot->live = true;
+    e->store(slot, std::memory_order_release);
+    return slot;
+}
+
+bool HandlerTable::remove(int fd) {
+    Entry* e = entry(fd);
+    Slot* slot = e ? e->load(std::memory_order_relaxed) : nullptr;
+    if (!slot) return false;
+    e->store(nullptr, std::memory_order_release);
+    slot->live = false;
+    retired_.push_back(slot);
+    return true;
+}
+
+void HandlerTable::releaseRetired() {
+    for (Slot* slot : retired_) {
+        slot->handler.reset();
+        free_.push_back(slot);
+    }
+    retired_.clear();
+}
+
+bool Reactor::registerEventHandler(int fd, uint32_t events, const EventCallback& cb) {
+    return registerEventHandler(fd, events, std::make_unique<CallbackHandler>(cb));
+}
+
+bool Reactor::registerAcceptor(int listenFd, AcceptCallback onAccept) {
+    // Level-triggered: one accept per event, a backlog raises another.
+    return registerEventHandler(listenFd, EPOLLIN, [onAccept = std::move(onAccept)](int fd, uint32_t) {
+        int connFd = ::accept4(fd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (connFd >= 0) {
+            onAccept(connFd);
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("[Reactor] accept4() failed on fd " + std::to_string(fd) + ": " +
+                      std::string(std::strerror(errno)));
+        }
+    });
+}
+
+std::unique_ptr<Reactor> makeReactor(ReactorKind kind, int timeoutMs) {
+    if (kind == ReactorKind::IO_URING) {
+        if (IoUringReactor::supported()) return std::make_unique<IoUringReactor>(4096, timeoutMs);
+        LOG_WARN("[Reactor] io_uring unavailable, falling back to epoll");
+    }
+    return std::make_unique<EpollReactor>(1024, timeoutMs);
+}
+
+}
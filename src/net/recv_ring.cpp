@@ -0,0 +1,49 @@
+#include "net/recv_ring.h"
+#include <sys/uio.h>
+
+namespace net {
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t cap = 1;
+    while (cap < n) cap <<= 1;
+    return cap;
+}
+
+}
+
+RecvRing::RecvRing(size_t capacity)
+    : buf_(new char[roundUpPow2(capacity)]),
+      mask_(roundUpPow2(capacity) - 1) {}
+
+ssize_t RecvRing::readFrom(int fd) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t free = writable();
+    if (free == 0) return 0;
+
+    size_t pos = tail & mask_;
+    size_t first = capacity() - pos;
+    if (first > free) first = free;
+
+    iovec iov[2];
+    iov[0] = {buf_.get() + pos, first};
+    iov[1] = {buf_.get(), free - first};
+    ssize_t n = ::readv(fd, iov, iov[1].iov_len ? 2 : 1);
+    if (n > 0) tail_.store(tail + static_cast<size_t>(n), std::memory_order_release);
+    return n;
+}
+
+size_t RecvRing::write(const char* data, size_t len) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t n = len < writable() ? len : writable();
+    size_t pos = tail & mask_;
+    size_t first = capacity() - pos;
+    if (first > n) first = n;
+    std::memcpy(buf_.get() + pos, data, first);
+    std::memcpy(buf_.get(), data + first, n - first);
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+}
@@ -0,0 +1,79 @@
+#include "net/send_buffer.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cstring>
+
+namespace net {
+
+namespace {
+
+constexpr size_t MAX_SPARE_CHUNKS = 4;
+
+}
+
+SendBuffer::Chunk SendBuffer::takeChunk() {
+    if (spare_.empty()) {
+        Chunk c;
+        c.data.reset(new char[CHUNK_SIZE]);
+        return c;
+    }
+    Chunk c = std::move(spare_.back());
+    spare_.pop_back();
+    c.begin = c.end = 0;
+    return c;
+}
+
+void SendBuffer::append(const char* data, size_t len) {
+    size_ += len;
+    while (len > 0) {
+        if (chunks_.empty() || chunks_.back().end == CHUNK_SIZE) chunks_.push_back(takeChunk());
+        Chunk& tail = chunks_.back();
+        size_t n = std::min(len, CHUNK_SIZE - tail.end);
+        std::memcpy(tail.data.get() + tail.end, data, n);
+        tail.end += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void SendBuffer::clear() {
+    while (!chunks_.empty()) {
+        if (spare_.size() < MAX_SPARE_CHUNKS) spare_.push_back(std::move(chunks_.front()));
+        chunks_.pop_front();
+    }
+    size_ = 0;
+}
+
+ssize_t SendBuffer::writeTo(int fd) {
+    iovec iov[MAX_IOV];
+    int cnt = 0;
+    for (auto it = chunks_.begin(); it != chunks_.end() && cnt < MAX_IOV; ++it) {
+        iov[cnt++] = {it->data.get() + it->begin, it->end - it->begin};
+    }
+
+    msghdr mh{};
+    mh.msg_iov = iov;
+    mh.msg_iovlen = static_cast<size_t>(cnt);
+    // sendmsg() rather than writev() for MSG_NOSIGNAL: a reset peer must
+    // not take the process down with SIGPIPE.
+    ssize_t n = ::sendmsg(fd, &mh, MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n <= 0) return n;
+
+    size_ -= static_cast<size_t>(n);
+    size_t left = static_cast<size_t>(n);
+    while (left > 0) {
+        Chunk& head = chunks_.front();
+        size_t avail = head.end - head.begin;
+        if (left < avail) {
+            head.begin += left;
+            break;
+        }
+        left -= avail;
+        if (spare_.size() < MAX_SPARE_CHUNKS) spare_.push_back(std::move(head));
+        chunks_.pop_front();
+    }
+    return n;
+}
+
+}
@@ -0,0 +1,102 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "net/shm_client.h"
+#include "utils/logger.h"
+#include "utils/binary_protocol.h"
+
+using namespace utils;
+
+namespace net {
+
+ShmClient::~ShmClient() { detach(); }
+
+bool ShmClient::attach(const std::string& name) {
+    if (attached()) return true;
+
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        LOG_WARN("[ShmClient] shm_open " + name + " failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmSegmentHeader)) {
+        ::close(fd);
+        return false;
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_WARN("[ShmClient] mmap failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    base_ = base;
+
+    auto* seg = static_cast<ShmSegmentHeader*>(base_);
+    if (!seg->ready.load(std::memory_order_acquire) || seg->magic != SHM_MAGIC ||
+        seg->version != SHM_VERSION) {
+        LOG_WARN("[ShmClient] " + name + " is not a ready gateway segment");
+        detach();
+        return false;
+    }
+    layout_ = ShmLayout{seg->maxClients, seg->ringSlots};
+    if (layout_.segmentBytes() > bytes_) {
+        detach();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < layout_.maxClients; ++i) {
+        ShmClientHeader* hdr = layout_.client(base_, i);
+        uint32_t expected = static_cast<uint32_t>(ShmClientState::FREE);
+        if (!hdr->state.compare_exchange_strong(expected, static_cast<uint32_t>(ShmClientState::ATTACHING),
+                                                std::memory_order_acq_rel)) {
+            continue;
+        }
+        hdr->pid.store(::getpid(), std::memory_order_relaxed);
+        requests_ = ShmRing(layout_.requestRing(hdr), layout_.ringSlots);
+        responses_ = ShmRing(layout_.responseRing(hdr), layout_.ringSlots);
+        sessionId_ = shmSessionId(hdr->generation.load(std::memory_order_acquire), i);
+        client_ = hdr;
+        hdr->state.store(static_cast<uint32_t>(ShmClientState::ACTIVE), std::memory_order_release);
+        return true;
+    }
+
+    LOG_WARN("[ShmClient] " + name + " has no free client block");
+    detach();
+    return false;
+}
+
+void ShmClient::detach() {
+    if (client_) {
+        client_->state.store(static_cast<uint32_t>(ShmClientState::CLOSING), std::memory_order_release);
+        client_ = nullptr;
+    }
+    if (base_) {
+        ::munmap(base_, bytes_);
+        base_ = nullptr;
+    }
+    sessionId_ = dispatch::INVALID_SESSION;
+}
+
+bool ShmClient::submit(const dispatch::DispatchMsg& msg) {
+    if (!client_) return false;
+    char frame[SHM_SLOT_SIZE];
+    size_t len = encodeBinaryOrder(msg, frame, sizeof(frame));
+    return len > 0 && requests_.tryPush(frame, len);
+}
+
+bool ShmClient::poll(dispatch::DispatchMsg& report) {
+    if (!client_) return false;
+    const char* frame = responses_.front();
+    if (!frame) return false;
+    int len = binFrameLength(frame, SHM_SLOT_SIZE);
+    bool ok = len > 0 && decodeBinaryReport(frame, static_cast<size_t>(len), report);
+    responses_.pop();
+    return ok;
+}
+
+}
@@ -0,0 +1,241 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "net/shm_gateway.h"
+#include "utils/logger.h"
+#include "utils/placement.h"
+#include "utils/binary_protocol.h"
+
+using namespace std::chrono;
+using namespace utils;
+
+namespace net {
+
+namespace {
+// Frames taken from one client before moving on to the next.
+constexpr int POLL_BATCH = 64;
+}
+
+ShmGateway::ShmGateway(dispatch::Dispatcher& dispatcher,
+                       std::string name,
+                       uint32_t maxClients,
+                       uint32_t ringSlots)
+    : dispatcher_(dispatcher),
+      name_(std::move(name)),
+      layout_{maxClients, ringSlots}
+{
+    if (ringSlots == 0 || (ringSlots & (ringSlots - 1)) != 0) {
+        throw std::runtime_error("shm ring slots must be a power of two");
+    }
+    if (maxClients == 0 || maxClients >= SHM_SESSION_FLAG) {
+        throw std::runtime_error("shm client count out of range");
+    }
+    clients_.reserve(maxClients);
+    for (uint32_t i = 0; i < maxClients; ++i) clients_.push_back(std::make_unique<Client>());
+}
+
+ShmGateway::~ShmGateway() { stopGateway(); }
+
+bool ShmGateway::startGateway() {
+    if (running_) return true;
+
+    // A segment left behind by a gateway that died is of no use to anyone.
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        LOG_ERROR("[ShmGateway] shm_open " + name_ + " failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    size_t bytes = layout_.segmentBytes();
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        LOG_ERROR("[ShmGateway] ftruncate failed: " + std::string(std::strerror(errno)));
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("[ShmGateway] mmap failed: " + std::string(std::strerror(errno)));
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    base_ = base;
+
+    auto* seg = new (base_) ShmSegmentHeader;
+    seg->magic = SHM_MAGIC;
+    seg->version = SHM_VERSION;
+    seg->maxClients = layout_.maxClients;
+    seg->ringSlots = layout_.ringSlots;
+    for (uint32_t i = 0; i < layout_.maxClients; ++i) {
+        auto* hdr = new (layout_.client(base_, i)) ShmClientHeader;
+        new (layout_.requestRing(hdr)) ShmRingHeader;
+        new (layout_.responseRing(hdr)) ShmRingHeader;
+        clients_[i]->hdr = hdr;
+    }
+    seg->ready.store(1, std::memory_order_release);
+
+    running_ = true;
+    pollThread_ = std::thread([this] { pollLoop(); });
+    LOG_INFO("[ShmGateway] serving " + name_ + " clients=" + std::to_string(layout_.maxClients) +
+             " slots=" + std::to_string(layout_.ringSlots));
+    return true;
+}
+
+void ShmGateway::stopGateway() {
+    if (!running_.exchange(false)) return;
+    if (pollThread_.joinable()) pollThread_.join();
+    unmapSegment();
+    LOG_INFO("[ShmGateway] stopped " + name_);
+}
+
+void ShmGateway::unmapSegment() {
+    // The dispatcher may still be sending; shut it out before unmapping.
+    for (auto& c : clients_) {
+        std::lock_guard<std::mutex> lock(c->sendMtx);
+        c->active = false;
+        c->hdr = nullptr;
+    }
+    activeClients_.store(0, std::memory_order_relaxed);
+    static_cast<ShmSegmentHeader*>(base_)->ready.store(0, std::memory_order_release);
+    ::munmap(base_, layout_.segmentBytes());
+    base_ = nullptr;
+    ::shm_unlink(name_.c_str());
+}
+
+void ShmGateway::pollLoop() {
+    Placement::placeThread("shm");
+    int idleSpins = 0;
+    auto lastOwnerCheck = steady_clock::now();
+
+    while (running_) {
+        // Clients that die without detaching are found by pid once a second.
+        auto now = steady_clock::now();
+        bool checkOwners = now - lastOwnerCheck >= seconds(1);
+        if (checkOwners) lastOwnerCheck = now;
+
+        bool progressed = false;
+        for (uint32_t i = 0; i < clients_.size(); ++i) {
+            progressed |= pollClient(*clients_[i], i, checkOwners);
+        }
+
+        if (!progressed) {
+            if (++idleSpins > 64) {
+                std::this_thread::sleep_for(microseconds(50));
+                idleSpins = 0;
+            }
+        } else {
+            idleSpins = 0;
+        }
+    }
+}
+
+bool ShmGateway::pollClient(Client& client, uint32_t index, bool checkOwner) {
+    auto state = static_cast<ShmClientState>(client.hdr->state.load(std::memory_order_acquire));
+    if (state == ShmClientState::CLOSING) {
+        recycleClient(client, index);
+        return true;
+    }
+    if (state != ShmClientState::ATTACHING) {
+        client.attachingSeen = false;
+    } else if (checkOwner) {
+        // Attaching takes a few stores; a block still ATTACHING a full check
+        // later belongs to a client that died part way, possibly before it
+        // wrote its pid.
+        pid_t pid = client.hdr->pid.load(std::memory_order_relaxed);
+        if (client.attachingSeen && (pid <= 0 || (::kill(pid, 0) != 0 && errno == ESRCH))) {
+            LOG_WARN("[ShmGateway] client=" + std::to_string(index) + " pid=" +
+                     std::to_string(pid) + " died while attaching");
+            client.attachingSeen = false;
+            recycleClient(client, index);
+            return true;
+        }
+        client.attachingSeen = true;
+    }
+    if (state == ShmClientState::ACTIVE && !client.active) activateClient(client);
+    if (!client.active) return false;
+
+    if (checkOwner) {
+        pid_t pid = client.hdr->pid.load(std::memory_order_relaxed);
+        if (pid > 0 && ::kill(pid, 0) != 0 && errno == ESRCH) {
+            LOG_WARN("[ShmGateway] client=" + std::to_string(index) + " pid=" +
+                     std::to_string(pid) + " is gone");
+            recycleClient(client, index);
+            return true;
+        }
+    }
+
+    bool progressed = false;
+    for (int n = 0; n < POLL_BATCH; ++n) {
+        const char* frame = client.requests.front();
+        if (!frame) break;
+
+        dispatch::DispatchMsg msg;
+        int len = binFrameLength(frame, SHM_SLOT_SIZE);
+        if (len <= 0 || !decodeBinaryOrder(frame, static_cast<size_t>(len), msg)) {
+            LOG_WARN("[ShmGateway] undecodable frame from client=" + std::to_string(index));
+            client.requests.pop();
+            progressed = true;
+            continue;
+        }
+        msg.sessionId = shmSessionId(client.generation, index);
+
+        engine::MatchingEngine* target = nullptr;
+        // A full engine queue leaves the frame in the ring for the next pass.
+        if (!dispatcher_.routeInbound(std::move(msg), &target) && target) break;
+        client.requests.pop();
+        progressed = true;
+    }
+    return progressed;
+}
+
+void ShmGateway::activateClient(Client& client) {
+    std::lock_guard<std::mutex> lock(client.sendMtx);
+    client.generation = client.hdr->generation.load(std::memory_order_acquire);
+    client.requests = ShmRing(layout_.requestRing(client.hdr), layout_.ringSlots);
+    client.responses = ShmRing(layout_.responseRing(client.hdr), layout_.ringSlots);
+    client.active = true;
+    activeClients_.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("[ShmGateway] client attached, pid=" +
+             std::to_string(client.hdr->pid.load(std::memory_order_relaxed)));
+}
+
+void ShmGateway::recycleClient(Client& client, uint32_t index) {
+    std::lock_guard<std::mutex> lock(client.sendMtx);
+    if (client.active) activeClients_.fetch_sub(1, std::memory_order_relaxed);
+    client.active = false;
+
+    // Reports still in flight for the old session now fail the generation
+    // check in queueSend().
+    uint32_t next = client.hdr->generation.load(std::memory_order_relaxed) + 1;
+    client.hdr->generation.store(next ? next : 1, std::memory_order_relaxed);
+    for (ShmRingHeader* ring : {layout_.requestRing(client.hdr), layout_.responseRing(client.hdr)}) {
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->tail.store(0, std::memory_order_relaxed);
+    }
+    client.hdr->pid.store(0, std::memory_order_relaxed);
+    client.hdr->state.store(static_cast<uint32_t>(ShmClientState::FREE), std::memory_order_release);
+    LOG_INFO("[ShmGateway] client=" + std::to_string(index) + " released");
+}
+
+bool ShmGateway::queueSend(dispatch::SessionId session, const std::string& payload) {
+    uint32_t index = static_cast<uint32_t>(session) & ~SHM_SESSION_FLAG;
+    if (!isShmSession(session) || index >= clients_.size()) return false;
+
+    Client& client = *clients_[index];
+    std::lock_guard<std::mutex> lock(client.sendMtx);
+    if (!client.active || client.generation != static_cast<uint32_t>(session >> 32)) return false;
+    if (!client.responses.tryPush(payload.data(), payload.size())) {
+        droppedReports_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,131 @@
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <stdexcept>
+#include "net/stats_endpoint.h"
+#include "utils/logger.h"
+#include "utils/metrics.h"
+#include "utils/socketops.h"
+
+using namespace utils;
+
+namespace net {
+
+namespace {
+// Anything bigger is not a scrape.
+constexpr size_t MAX_REQUEST = 8192;
+}
+
+// One scrape: read the request head, answer, close.
+class StatsEndpoint::Client final : public EventHandler {
+public:
+    Client(Reactor& reactor, int fd) : reactor_(reactor), fd_(fd) {}
+    ~Client() override { ::close(fd_); }
+
+    void handleEvent(int fd, uint32_t) override {
+        if (response_.empty()) {
+            if (!readRequest()) {
+                reactor_.unregisterEventHandler(fd);
+                return;
+            }
+            if (response_.empty()) return;
+        }
+        writeResponse();
+    }
+
+private:
+    // False when the connection should just be dropped.
+    bool readRequest() {
+        char buf[1024];
+        for (;;) {
+            ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
+            if (n > 0) {
+                request_.append(buf, static_cast<size_t>(n));
+                if (request_.size() > MAX_REQUEST) return false;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            // Peer closed or failed before finishing its request.
+            return false;
+        }
+        if (request_.find("\r\n\r\n") == std::string::npos && request_.find("\n\n") == std::string::npos) {
+            return true;
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (request_.compare(0, 4, "GET ") == 0) {
+            body = MetricsRegistry::instance().renderText();
+        } else {
+            status = "405 Method Not Allowed";
+        }
+        response_ = "HTTP/1.1 " + status + "\r\n"
+                    "Content-Type: text/plain; version=0.0.4\r\n"
+                    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                    "Connection: close\r\n\r\n" + body;
+        return true;
+    }
+
+    void writeResponse() {
+        while (sent_ < response_.size()) {
+            ssize_t n = ::send(fd_, response_.data() + sent_, response_.size() - sent_, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent_ += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                reactor_.updateEventMask(fd_, EPOLLOUT);
+                return;
+            }
+            break;
+        }
+        reactor_.unregisterEventHandler(fd_);
+    }
+
+    Reactor& reactor_;
+    int fd_;
+    std::string request_;
+    std::string response_;
+    size_t sent_ = 0;
+};
+
+StatsEndpoint::StatsEndpoint(Reactor& reactor, const std::string& host, uint16_t port)
+    : reactor_(reactor)
+{
+    listenFd_ = createListenSocket(host, port, 16);
+    if (listenFd_ < 0) {
+        LOG_ERROR("[StatsEndpoint] Failed to create listen socket");
+        throw std::runtime_error("listen socket error");
+    }
+}
+
+StatsEndpoint::~StatsEndpoint() {
+    if (listenFd_ >= 0) ::close(listenFd_);
+}
+
+bool StatsEndpoint::startEndpoint() {
+    return reactor_.registerEventHandler(listenFd_, EPOLLIN, [this](int fd, uint32_t) {
+        handleAccept(fd);
+    });
+}
+
+void StatsEndpoint::handleAccept(int listenFd) {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN("[StatsEndpoint] accept4() failed, errno={}", errno);
+            }
+            return;
+        }
+        // On failure the handler, and with it the socket, is dropped.
+        reactor_.registerEventHandler(fd, EPOLLIN, std::make_unique<Client>(reactor_, fd));
+    }
+}
+
+}
@@ -0,0 +1,175 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include "net/stats_segment.h"
+#include "utils/clock.h"
+#include "utils/logger.h"
+#include "utils/placement.h"
+
+using namespace utils;
+
+namespace net {
+
+namespace {
+
+StatsEntry* entriesOf(void* base) {
+    return reinterpret_cast<StatsEntry*>(static_cast<char*>(base) + sizeof(StatsSegmentHeader));
+}
+
+}
+
+StatsPublisher::StatsPublisher(std::string name, uint32_t capacity, std::chrono::milliseconds interval)
+    : name_(std::move(name)), capacity_(capacity), interval_(interval) {}
+
+StatsPublisher::~StatsPublisher() { stopPublisher(); }
+
+bool StatsPublisher::startPublisher() {
+    if (running_) return true;
+
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        LOG_ERROR("[StatsPublisher] shm_open " + name_ + " failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    bytes_ = sizeof(StatsSegmentHeader) + static_cast<size_t>(capacity_) * sizeof(StatsEntry);
+    if (::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        LOG_ERROR("[StatsPublisher] ftruncate failed: " + std::string(std::strerror(errno)));
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    base_ = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        LOG_ERROR("[StatsPublisher] mmap failed: " + std::string(std::strerror(errno)));
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+
+    auto* hdr = new (base_) StatsSegmentHeader{};
+    hdr->capacity = capacity_;
+    hdr->version = STATS_VERSION;
+    // Readers check the magic last.
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = STATS_MAGIC;
+
+    running_ = true;
+    thread_ = std::thread([this] {
+        Placement::placeThread("stats");
+        std::unique_lock<std::mutex> lock(waitMtx_);
+        while (running_.load(std::memory_order_relaxed)) {
+            publish();
+            waitCv_.wait_for(lock, interval_, [this] { return !running_.load(std::memory_order_relaxed); });
+        }
+    });
+    LOG_INFO("[StatsPublisher] publishing to " + name_);
+    return true;
+}
+
+void StatsPublisher::stopPublisher() {
+    {
+        std::lock_guard<std::mutex> lock(waitMtx_);
+        if (!running_.exchange(false)) return;
+    }
+    waitCv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    std::lock_guard<std::mutex> lock(waitMtx_);
+    ::munmap(base_, bytes_);
+    base_ = nullptr;
+    ::shm_unlink(name_.c_str());
+}
+
+void StatsPublisher::publishNow() {
+    std::lock_guard<std::mutex> lock(waitMtx_);
+    publish();
+}
+
+void StatsPublisher::publish() {
+    if (!base_) return;
+    std::vector<MetricSample> samples = MetricsRegistry::instance().snapshot();
+    auto* hdr = static_cast<StatsSegmentHeader*>(base_);
+    StatsEntry* entries = entriesOf(base_);
+    auto count = static_cast<uint32_t>(std::min<size_t>(samples.size(), capacity_));
+
+    uint64_t seq = hdr->seq.load(std::memory_order_relaxed);
+    hdr->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint32_t i = 0; i < count; ++i) {
+        StatsEntry& e = entries[i];
+        size_t len = std::min(samples[i].name.size(), STATS_NAME_LEN - 1);
+        std::memcpy(e.name, samples[i].name.data(), len);
+        e.name[len] = '\0';
+        e.value = samples[i].value;
+        e.kind = static_cast<uint8_t>(samples[i].kind);
+    }
+    hdr->count = count;
+    hdr->updatedNs = Clock::wallNs();
+    hdr->seq.store(seq + 2, std::memory_order_release);
+}
+
+bool StatsReader::attach(const std::string& name) {
+    detach();
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(StatsSegmentHeader)) {
+        ::close(fd);
+        return false;
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    base_ = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        return false;
+    }
+    auto* hdr = static_cast<const StatsSegmentHeader*>(base_);
+    if (hdr->magic != STATS_MAGIC || hdr->version != STATS_VERSION ||
+        sizeof(StatsSegmentHeader) + hdr->capacity * sizeof(StatsEntry) > bytes_) {
+        detach();
+        return false;
+    }
+    return true;
+}
+
+void StatsReader::detach() {
+    if (base_) ::munmap(base_, bytes_);
+    base_ = nullptr;
+}
+
+bool StatsReader::read(std::vector<MetricSample>& out, int64_t* updatedNs) const {
+    if (!base_) return false;
+    auto* hdr = static_cast<const StatsSegmentHeader*>(base_);
+    const StatsEntry* entries = entriesOf(base_);
+    for (;;) {
+        uint64_t seq = hdr->seq.load(std::memory_order_acquire);
+        if (seq == 0) return false;
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t count = std::min(hdr->count, hdr->capacity);
+        out.clear();
+        out.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            const StatsEntry& e = entries[i];
+            out.push_back({std::string(e.name, strnlen(e.name, STATS_NAME_LEN)),
+                           static_cast<MetricKind>(e.kind), e.value});
+        }
+        int64_t updated = hdr->updatedNs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (hdr->seq.load(std::memory_order_relaxed) == seq) {
+            if (updatedNs) *updatedNs = updated;
+            return true;
+        }
+    }
+}
+
+}
@@ -1,20 +1,212 @@
 #include "net/tcp_connection.h"
+#include "utils/binary_protocol.h"
 #include <sys/socket.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 
 namespace net {
 
-std::string TcpConnection::read() {
-    char buf[4096];
-    ssize_t n = ::recv(fd_, buf, sizeof(buf), 0);
-    if (n <= 0) return {};
-    return std::string(buf, n);
+TcpConnection::SendResult TcpConnection::queueSend(const char* data, size_t len, bool droppable) {
+    std::lock_guard<std::mutex> lock(txMtx_);
+    if (txClosed_) return SendResult::CLOSED;
+
+    size_t queued = tx_.size() + len;
+    if (queued > hardLimit_) {
+        // Drop the backlog and cut the peer off; the reactor sees the
+        // shutdown as a close and reclaims the connection.
+        txClosed_ = true;
+        tx_.clear();
+        ::shutdown(fd_, SHUT_RDWR);
+        return SendResult::OVERFLOW;
+    }
+    if (droppable && queued > softLimit_) return SendResult::DROPPED;
+
+    tx_.append(data, len);
+    return SendResult::QUEUED;
+}
+
+TcpConnection::FlushResult TcpConnection::flush(const InterestFunc& apply) {
+    std::lock_guard<std::mutex> lock(txMtx_);
+    FlushResult result = FlushResult::DONE;
+    while (!tx_.empty()) {
+        ssize_t n = tx_.writeTo(fd_);
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            result = FlushResult::PENDING;
+        } else {
+            txClosed_ = true;
+            tx_.clear();
+            result = FlushResult::FAILED;
+        }
+        break;
+    }
+
+    // Still under the send lock, so concurrent flushers cannot reorder.
+    setWriteInterest(result == FlushResult::PENDING, apply);
+    return result;
+}
+
+uint32_t TcpConnection::interestLocked() const {
+    uint32_t events = EPOLLET;
+    if (!readPaused_.load(std::memory_order_relaxed)) events |= EPOLLIN;
+    if (writeInterest_) events |= EPOLLOUT;
+    return events;
+}
+
+uint32_t TcpConnection::interest() const {
+    std::lock_guard<std::mutex> lock(interestMtx_);
+    return interestLocked();
+}
+
+void TcpConnection::setWriteInterest(bool want, const InterestFunc& apply) {
+    std::lock_guard<std::mutex> lock(interestMtx_);
+    if (writeInterest_ == want) return;
+    writeInterest_ = want;
+    apply(interestLocked());
+}
+
+bool TcpConnection::pauseReading(const InterestFunc& apply) {
+    std::lock_guard<std::mutex> lock(interestMtx_);
+    if (readPaused_.exchange(true, std::memory_order_acq_rel)) return false;
+    apply(interestLocked());
+    return true;
+}
+
+bool TcpConnection::resumeReading(const InterestFunc& apply) {
+    std::lock_guard<std::mutex> lock(interestMtx_);
+    if (!readPaused_.exchange(false, std::memory_order_acq_rel)) return false;
+    apply(interestLocked());
+    return true;
+}
+
+void TcpConnection::rearm(const InterestFunc& apply) {
+    std::lock_guard<std::mutex> lock(interestMtx_);
+    apply(interestLocked());
+}
+
+size_t TcpConnection::pendingSendBytes() const {
+    std::lock_guard<std::mutex> lock(txMtx_);
+    return tx_.size();
 }
 
-bool TcpConnection::send(const std::string& data) {
-    ssize_t n = ::send(fd_, data.data(), data.size(), 0);
-    return n == (ssize_t)data.size();
+bool TcpConnection::fillRecvRing() {
+    while (rx_.writable() > 0) {
+        ssize_t n = rx_.readFrom(fd_);
+        if (n > 0) continue;
+        if (n == 0) return false;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    rxStarved_.store(true, std::memory_order_release);
+    return true;
+}
+
+size_t TcpConnection::takeReceived(const char* data, size_t len) {
+    size_t n = rx_.write(data, len);
+    if (n < len) rxStarved_.store(true, std::memory_order_release);
+    return n;
+}
+
+void TcpConnection::detectProtocol() {
+    if (protocolKnown_ || rx_.readable() == 0) return;
+    protocol_ = static_cast<uint8_t>(*rx_.at(0)) == utils::BIN_MAGIC
+                    ? dispatch::WireProtocol::BINARY
+                    : dispatch::WireProtocol::JSON;
+    protocolKnown_ = true;
+}
+
+void TcpConnection::shutdownSocket() {
+    ::shutdown(fd_, SHUT_RDWR);
+}
+
+bool TcpConnection::drainFrames(const FrameBatchHandler& handler) {
+    size_t avail = rx_.readable();
+    size_t off = 0;
+    bool bad = false;
+    frames_.clear();
+    frameEnds_.clear();
+
+    // The readable region wraps at most once, so at most one frame needs
+    // the wrapped_ copy per drain.
+    while (off < avail) {
+        std::string_view frame;
+        size_t used = 0;
+        bool ok = (protocol_ == dispatch::WireProtocol::BINARY)
+                      ? nextBinaryFrame(off, avail, frame, used, bad)
+                      : nextJsonFrame(off, avail, frame, used);
+        if (!ok) break;
+        off += used;
+        if (!frame.empty()) {
+            frames_.push_back(frame);
+            frameEnds_.push_back(off);
+        }
+    }
+
+    if (!frames_.empty()) {
+        size_t taken = handler(frames_);
+        if (taken < frames_.size()) {
+            // Keep the refused frames; a refused wrapped frame is rebuilt.
+            rx_.consume(taken ? frameEnds_[taken - 1] : 0);
+            return !bad;
+        }
+    }
+    rx_.consume(off);
+
+    // A full ring that holds no complete frame will never make progress.
+    return !bad && !(off == 0 && avail == rx_.capacity());
+}
+
+bool TcpConnection::nextJsonFrame(size_t off, size_t avail, std::string_view& frame, size_t& used) {
+    const char* p = rx_.at(off);
+    size_t contig = std::min(rx_.contiguous(off), avail - off);
+
+    size_t len;
+    if (auto* nl = static_cast<const char*>(std::memchr(p, '\n', contig))) {
+        len = static_cast<size_t>(nl - p);
+        frame = std::string_view(p, len);
+    } else {
+        size_t rest = avail - off - contig;
+        const char* p2 = rx_.at(off + contig);
+        auto* nl2 = rest ? static_cast<const char*>(std::memchr(p2, '\n', rest)) : nullptr;
+        if (!nl2) return false;
+        len = contig + static_cast<size_t>(nl2 - p2);
+        wrapped_.resize(len);
+        rx_.copyOut(off, len, wrapped_.data());
+        frame = wrapped_;
+    }
+    used = len + 1;
+    if (!frame.empty() && frame.back() == '\r') frame.remove_suffix(1);
+    return true;
+}
+
+bool TcpConnection::nextBinaryFrame(size_t off, size_t avail, std::string_view& frame,
+                                    size_t& used, bool& bad) {
+    char hdr[sizeof(utils::BinHeader)];
+    size_t have = std::min(avail - off, sizeof(hdr));
+    rx_.copyOut(off, have, hdr);
+    if (utils::binFrameLength(hdr, have) < 0) {
+        bad = true;
+        return false;
+    }
+    if (have < sizeof(hdr)) return false;
+
+    utils::BinHeader h;
+    std::memcpy(&h, hdr, sizeof(h));
+    size_t len = h.length;
+    if (avail - off < len) return false;
+
+    if (rx_.contiguous(off) >= len) {
+        frame = std::string_view(rx_.at(off), len);
+    } else {
+        wrapped_.resize(len);
+        rx_.copyOut(off, len, wrapped_.data());
+        frame = wrapped_;
+    }
+    used = len;
+    return true;
 }
 
 }
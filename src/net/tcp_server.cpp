@@ -1,34 +1,70 @@
-#include <netinet/in.h>
-#include <cstring>
 #include "net/tcp_server.h"
 #include "utils/logger.h"
+#include "utils/binary_protocol.h"
 #include "utils/message_parser.h"
 
 using namespace utils;
 
 namespace net {
 
-TcpServer::TcpServer(EpollReactor& reactor,
+namespace {
+std::atomic<int> nextServerId{0};
+}
+
+TcpServer::TcpServer(Reactor& reactor,
                      dispatch::Dispatcher& dispatcher,
                      const std::string& host,
                      uint16_t port,
-                     size_t threadCount)
+                     size_t threadCount,
+                     ConnectionRegistry* registry)
     : reactor_(reactor),
       dispatcher_(dispatcher),
-      threadPool_(threadCount)
+      threadPool_(threadCount),
+      registry_(registry)
 {
+    if (!registry_) {
+        ownedRegistry_ = std::make_unique<ConnectionRegistry>();
+        registry_ = ownedRegistry_.get();
+    }
+    reliefListenerId_ = dispatcher_.addReliefListener([this](engine::MatchingEngine* engine) {
+        resumeForEngine(engine);
+    });
     listenFd_ = createListenSocket(host, port, 128);
     if (listenFd_ < 0) {
         LOG_ERROR("[TcpServer] Failed to create listen socket");
         throw std::runtime_error("listen socket error");
     }
+    registerMetrics();
 }
 
 TcpServer::~TcpServer() {
+    dispatcher_.removeReliefListener(reliefListenerId_);
     shutdownServer();
     if (listenFd_ >= 0) close(listenFd_);
 }
 
+void TcpServer::registerMetrics() {
+    std::string id = std::to_string(nextServerId.fetch_add(1, std::memory_order_relaxed));
+    auto name = [&id](const char* metric) { return labelled(metric, "server", id); };
+
+    metrics_.counter(name("tcp_accepted_total"), accepted_);
+    metrics_.counter(name("tcp_closed_total"), closed_);
+    metrics_.counter(name("tcp_rejected_total"), rejected_);
+    metrics_.counter(name("tcp_frames_total"), frames_);
+    metrics_.counter(name("tcp_bad_frames_total"), badFrames_);
+    metrics_.counter(name("tcp_slow_consumer_total"), slowConsumers_);
+    metrics_.counter(name("tcp_backpressure_pauses_total"), pauses_);
+    metrics_.gauge(name("tcp_connections"), [this] {
+        return static_cast<int64_t>(accepted_.value() - closed_.value());
+    });
+    metrics_.gauge(name("tcp_paused_connections"), [this] {
+        std::lock_guard<std::mutex> lock(pausedMtx_);
+        size_t n = 0;
+        for (const auto& [engine, conns] : paused_) n += conns.size();
+        return static_cast<int64_t>(n);
+    });
+}
+
 bool TcpServer::startServer() {
     threadPool_.startWorkers();
     return startListening();
@@ -40,76 +76,209 @@ void TcpServer::shutdownServer() {
 
 bool TcpServer::startListening() {
     LOG_INFO("[TcpServer] Listening for connections...");
-    reactor_.registerEventHandler(listenFd_, EPOLLIN, [this](int fd, uint32_t events) {
-        handleAccept(fd, events);
-    });
-    return true;
+    return reactor_.registerAcceptor(listenFd_, [this](int connFd) { handleAccept(connFd); });
 }
 
-void TcpServer::handleAccept(int listenFd, uint32_t) {
-    sockaddr_in client{};
-    socklen_t len = sizeof(client);
-    int connFd = accept4(listenFd, reinterpret_cast<sockaddr*>(&client), &len, SOCK_NONBLOCK);
-    if (connFd < 0) {
-        int err = errno;
-        if (err == EAGAIN || err == EWOULDBLOCK) {
-            return;
-        }
-        LOG_ERROR("[TcpServer] accept4() failed, errno=" + std::to_string(err) +
-                  " (" + std::string(strerror(err)) + ")");
+void TcpServer::handleAccept(int connFd) {
+    auto conn = std::make_shared<TcpConnection>(connFd);
+    dispatch::SessionId session = registry_->add(conn);
+    if (session == dispatch::INVALID_SESSION) {
+        LOG_WARN("[TcpServer] connection registry full, rejecting fd=" + std::to_string(connFd));
+        rejected_.inc();
+        return;
     }
+    conn->setSessionId(session);
 
-    conns_.try_emplace(connFd, connFd);
+    // Input goes straight into the ring where the reactor completes reads.
+    if (!reactor_.registerReceiver(connFd, conn->interest(),
+                                   std::make_unique<ConnectionHandler>(*this, conn))) {
+        registry_->remove(session);
+        rejected_.inc();
+        return;
+    }
+    accepted_.inc();
 
-    reactor_.registerEventHandler(connFd, EPOLLIN, [this](int fd, uint32_t events) {
-        handleRead(fd, events);
-    });
+    LOG_INFO("[TcpServer] New connection accepted, fd=" + std::to_string(connFd) +
+             " session=" + std::to_string(session));
+}
 
-    LOG_INFO("[TcpServer] New connection accepted, fd=" + std::to_string(connFd));
+void TcpServer::ConnectionHandler::handleEvent(int, uint32_t events) {
+    // Write first: a read may close and drop the connection.
+    if (events & EPOLLOUT) server_.handleWrite(*conn_);
+    if (events & ~EPOLLOUT) server_.handleRead(conn_, events);
 }
 
-void TcpServer::handleRead(int connFd, uint32_t) {
-    auto it = conns_.find(connFd);
-    if (it == conns_.end()) {
-        LOG_WARN("[TcpServer] Read event for unknown fd=" + std::to_string(connFd));
-        return;
+size_t TcpServer::ConnectionHandler::handleData(int, const char* data, size_t len) {
+    return server_.handleData(conn_, data, len);
+}
+
+void TcpServer::handleRead(const std::shared_ptr<TcpConnection>& conn, uint32_t) {
+    afterReceive(conn, conn->fillRecvRing());
+}
+
+size_t TcpServer::handleData(const std::shared_ptr<TcpConnection>& conn, const char* data, size_t len) {
+    if (len == 0) {
+        afterReceive(conn, false);
+        return 0;
+    }
+    size_t taken = conn->takeReceived(data, len);
+    afterReceive(conn, true);
+    return taken;
+}
+
+void TcpServer::afterReceive(const std::shared_ptr<TcpConnection>& conn, bool open) {
+    int connFd = conn->socketFd();
+    if (!conn->protocolKnown()) {
+        conn->detectProtocol();
+        if (conn->protocolKnown()) {
+            LOG_INFO("[TcpServer] fd=" + std::to_string(connFd) + " protocol=" +
+                     (conn->protocol() == dispatch::WireProtocol::BINARY ? "BINARY" : "JSON"));
+        }
     }
-    auto data = it->second.read();
-    if (data.empty()) {
+    // Frames that arrived ahead of a FIN are still delivered.
+    if (conn->protocolKnown()) scheduleDrain(conn);
+
+    if (!open) {
         LOG_INFO("[TcpServer] Connection closed, fd=" + std::to_string(connFd));
+        closed_.inc();
+        // The socket closes with the last reference: the reactor's ends
+        // with this batch, the registry's after its grace period.
+        registry_->remove(conn->sessionId());
         reactor_.unregisterEventHandler(connFd);
-        conns_.erase(it);
-        return;
     }
+}
+
+void TcpServer::handleWrite(TcpConnection& conn) {
+    conn.flush(interestUpdater(conn.socketFd()));
+}
+
+TcpConnection::InterestFunc TcpServer::interestUpdater(int connFd) {
+    return [this, connFd](uint32_t events) { reactor_.updateEventMask(connFd, events); };
+}
+
+bool TcpServer::queueSend(dispatch::SessionId session, const std::string& payload) {
+    Rcu::ReadGuard guard;
+    TcpConnection* conn = registry_->lookup(session);
+    if (!conn) return false;
+
+    switch (conn->queueSend(payload.data(), payload.size())) {
+        case TcpConnection::SendResult::QUEUED:
+            break;
+        case TcpConnection::SendResult::OVERFLOW:
+            LOG_WARN("[TcpServer] slow consumer over send limit, disconnecting fd=" +
+                     std::to_string(conn->socketFd()));
+            slowConsumers_.inc();
+            return false;
+        default:
+            return false;
+    }
+    if (conn->markFlushQueued()) flushList_.push_back(conn->shared_from_this());
+    return true;
+}
+
+void TcpServer::flushPending() {
+    for (auto& conn : flushList_) {
+        conn->clearFlushQueued();
+        conn->flush(interestUpdater(conn->socketFd()));
+    }
+    flushList_.clear();
+    registry_->reclaim();
+}
 
-    threadPool_.submitTask([this, connFd, raw = std::move(data)]() mutable {
+void TcpServer::scheduleDrain(const std::shared_ptr<TcpConnection>& conn) {
+    if (!conn->requestDrain()) return;
+
+    // Pin every drain of a connection to one worker so its messages reach
+    // the engine in the order they arrived.
+    threadPool_.submitTask(static_cast<size_t>(conn->socketFd()), [this, conn]() {
+        conn->beginDrain();
+        bool ok = conn->drainFrames([&](const std::vector<std::string_view>& frames) {
+            return routeFrames(conn, frames);
+        });
+        if (!ok) {
+            LOG_WARN("[TcpServer] unframeable input, closing fd=" + std::to_string(conn->socketFd()));
+            badFrames_.inc();
+            conn->shutdownSocket();
+        }
+        // Ring space is free again; have the reactor report, or hand over,
+        // what is still unread.
+        if (conn->takeRecvStarved()) conn->rearm(interestUpdater(conn->socketFd()));
+    });
+}
+
+size_t TcpServer::routeFrames(const std::shared_ptr<TcpConnection>& conn,
+                              const std::vector<std::string_view>& frames) {
+    int connFd = conn->socketFd();
+    bool binary = conn->protocol() == dispatch::WireProtocol::BINARY;
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::string_view frame = frames[i];
         try {
-            auto msg = parseMsg(raw);
+            dispatch::DispatchMsg msg;
+            if (binary) {
+                if (!decodeBinaryOrder(frame.data(), frame.size(), msg)) {
+                    LOG_WARN("[TcpServer] unknown binary template=" +
+                             std::to_string(static_cast<uint8_t>(frame[1])) +
+                             " fd=" + std::to_string(connFd));
+                    badFrames_.inc();
+                    continue;
+                }
+            } else {
+                msg = parseMsg(frame);
+            }
 
-            msg.fd = connFd;
+            msg.sessionId = conn->sessionId();
 
-            if (!dispatcher_.routeInbound(std::move(msg))) {
+            engine::MatchingEngine* target = nullptr;
+            bool routed = dispatcher_.routeInbound(std::move(msg), &target);
+            if (!target) {
                 LOG_WARN("[TcpServer] routeInbound failed for fd="
                          + std::to_string(connFd));
+                continue;
+            }
+            // A refused frame stays in the ring and is retried on resume.
+            if (!routed || target->inboundCongested()) {
+                pauseForEngine(conn, target);
+                frames_.inc(routed ? i + 1 : i);
+                return routed ? i + 1 : i;
             }
 
         } catch (const std::exception& ex) {
             LOG_ERROR(std::string("[TcpServer] parse or dispatch failed fd=")
                       + std::to_string(connFd) + " ex=" + ex.what());
+            badFrames_.inc();
         }
-    });
+    }
+    frames_.inc(frames.size());
+    return frames.size();
 }
 
-TcpConnection* TcpServer::getConnection (int fd) {
-    auto it = conns_.find(fd);
-    if (it == conns_.end()) return nullptr;
-    return &(it->second);
+void TcpServer::pauseForEngine(const std::shared_ptr<TcpConnection>& conn,
+                               engine::MatchingEngine* engine) {
+    // Already paused means it is already listed under some engine.
+    if (!conn->pauseReading(interestUpdater(conn->socketFd()))) return;
+    pauses_.inc();
+    {
+        std::lock_guard<std::mutex> lock(pausedMtx_);
+        paused_[engine].push_back(conn);
+    }
+    // The engine may have drained before the connection was listed.
+    if (!engine->inboundCongested()) resumeForEngine(engine);
 }
 
-const TcpConnection* TcpServer::getConnection(int fd) const {
-    auto it = conns_.find(fd);
-    if (it == conns_.end()) return nullptr;
-    return &(it->second);
+void TcpServer::resumeForEngine(engine::MatchingEngine* engine) {
+    std::vector<std::shared_ptr<TcpConnection>> conns;
+    {
+        std::lock_guard<std::mutex> lock(pausedMtx_);
+        auto it = paused_.find(engine);
+        if (it == paused_.end()) return;
+        conns.swap(it->second);
+    }
+    for (auto& conn : conns) {
+        // Re-adding EPOLLIN re-arms the edge for bytes already queued in the
+        // socket; frames left in the ring need a drain of their own.
+        if (conn->resumeReading(interestUpdater(conn->socketFd()))) scheduleDrain(conn);
+    }
 }
 
 }
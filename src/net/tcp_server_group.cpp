@@ -0,0 +1,77 @@
+#include "net/tcp_server_group.h"
+#include "utils/logger.h"
+#include "utils/placement.h"
+
+using namespace utils;
+
+namespace net {
+
+TcpServerGroup::TcpServerGroup(dispatch::Dispatcher& dispatcher,
+                               const std::string& host,
+                               uint16_t port,
+                               size_t reactorCount,
+                               size_t workersPerReactor,
+                               ReactorKind kind)
+    : TcpServerGroup(reactorCount,
+                     [&dispatcher, host, port, workersPerReactor](Reactor& r, ConnectionRegistry& reg) {
+          return std::make_unique<TcpServer>(r, dispatcher, host, port, workersPerReactor, &reg);
+      }, kind) {}
+
+TcpServerGroup::TcpServerGroup(size_t reactorCount, ServerFactory factory, ReactorKind kind) {
+    if (reactorCount == 0) reactorCount = 1;
+    shards_.reserve(reactorCount);
+    for (size_t i = 0; i < reactorCount; ++i) {
+        // The shard's tables live on the node its reactor is pinned to.
+        ScopedMemoryNode local(Placement::nodeFor("reactor", i));
+        auto shard = std::make_unique<Shard>();
+        shard->reactor = makeReactor(kind, REACTOR_TIMEOUT_MS);
+        shard->registry = std::make_unique<ConnectionRegistry>(
+            SESSIONS_PER_SHARD, static_cast<uint32_t>(i * SESSIONS_PER_SHARD));
+        shard->server = factory(*shard->reactor, *shard->registry);
+        shards_.push_back(std::move(shard));
+    }
+}
+
+TcpServerGroup::~TcpServerGroup() {
+    stopGroup();
+    joinGroup();
+}
+
+bool TcpServerGroup::startGroup() {
+    if (started_) return true;
+    for (auto& shard : shards_) {
+        if (!shard->server->startServer()) return false;
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard* shard = shards_[i].get();
+        shard->loop = std::thread([shard, i] {
+            Placement::placeThread("reactor", i);
+            shard->reactor->runEventLoop();
+        });
+    }
+    started_ = true;
+    LOG_INFO("[TcpServerGroup] started " + std::to_string(shards_.size()) + " reactor threads");
+    return true;
+}
+
+void TcpServerGroup::stopGroup() {
+    for (auto& shard : shards_) shard->reactor->stopEventLoop();
+}
+
+void TcpServerGroup::joinGroup() {
+    for (auto& shard : shards_) {
+        if (shard->loop.joinable()) shard->loop.join();
+    }
+}
+
+bool TcpServerGroup::queueSend(dispatch::SessionId session, const std::string& payload) {
+    size_t shard = static_cast<uint32_t>(session) / SESSIONS_PER_SHARD;
+    if (shard >= shards_.size()) return false;
+    return shards_[shard]->server->queueSend(session, payload);
+}
+
+void TcpServerGroup::flushPending() {
+    for (auto& shard : shards_) shard->server->flushPending();
+}
+
+}
@@ -0,0 +1,110 @@
+#include "utils/clock.h"
+#include "utils/placement.h"
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace utils {
+
+namespace detail {
+ClockCalibration clockCalibration;
+}
+
+namespace {
+
+struct Sample {
+    uint64_t tsc;
+    int64_t mono;
+    int64_t real;
+};
+
+int64_t readNs(clockid_t id) {
+    timespec ts;
+    clock_gettime(id, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// The tightest of a few tick reads bracketing the two clock reads, paired
+// with the midpoint tick.
+Sample takeSample() {
+    Sample best{};
+    uint64_t bestSpan = std::numeric_limits<uint64_t>::max();
+    for (int i = 0; i < 5; ++i) {
+        uint64_t t0 = Clock::nowOrdered();
+        int64_t mono = readNs(CLOCK_MONOTONIC);
+        int64_t real = readNs(CLOCK_REALTIME);
+        uint64_t t1 = Clock::nowOrdered();
+        if (t1 - t0 < bestSpan) {
+            bestSpan = t1 - t0;
+            best = {t0 + (t1 - t0) / 2, mono, real};
+        }
+    }
+    return best;
+}
+
+std::once_flag initOnce;
+std::mutex calibrateMtx;
+// The rate is measured over everything since this first sample, so it gets
+// more precise the longer the process runs.
+Sample baseline;
+
+void publish(const Sample& s, double rate) {
+    auto& c = detail::clockCalibration;
+    uint32_t seq = c.seq.load(std::memory_order_relaxed);
+    c.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    c.tsc.store(s.tsc, std::memory_order_relaxed);
+    c.monoNs.store(s.mono, std::memory_order_relaxed);
+    c.realNs.store(s.real, std::memory_order_relaxed);
+    c.nsPerTick.store(rate, std::memory_order_relaxed);
+    c.seq.store(seq + 2, std::memory_order_release);
+}
+
+void calibrate() {
+    std::lock_guard<std::mutex> lock(calibrateMtx);
+    Sample s = takeSample();
+    double rate = detail::clockCalibration.nsPerTick.load(std::memory_order_relaxed);
+    if (s.tsc > baseline.tsc && s.mono > baseline.mono) {
+        rate = static_cast<double>(s.mono - baseline.mono) / static_cast<double>(s.tsc - baseline.tsc);
+    }
+    publish(s, rate);
+}
+
+}
+
+void Clock::init() {
+    std::call_once(initOnce, [] {
+        baseline = takeSample();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        calibrate();
+        // Lives for the whole process, like the time it keeps.
+        std::thread([] {
+            Placement::placeThread("clock");
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                calibrate();
+            }
+        }).detach();
+    });
+}
+
+void Clock::recalibrate() {
+    init();
+    calibrate();
+}
+
+bool Clock::invariantTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+}
@@ -1,57 +1,355 @@
 #include "utils/logger.h"
+#include "utils/placement.h"
+#include <signal.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std::chrono;
 
 namespace utils {
 
+namespace logdetail {
+std::atomic<uint8_t> componentLevels[static_cast<size_t>(LogComponent::COUNT)] = {
+    {3}, {3}, {3}, {3}, {3}, {3}};
+}
+
+using logdetail::ArgType;
+using logdetail::LogRing;
+using logdetail::RecordHeader;
+
+namespace {
+
+const char* levelTag(uint8_t level) {
+    switch (static_cast<LogLevel>(level)) {
+        case LogLevel::ERROR: return "[ERROR] ";
+        case LogLevel::WARN:  return "[WARN] ";
+        default:              return "[INFO] ";
+    }
+}
+
+constexpr const char* COMPONENT_NAMES[] = {"core", "engine", "dispatch", "net", "utils", "app"};
+static_assert(sizeof(COMPONENT_NAMES) / sizeof(COMPONENT_NAMES[0]) ==
+              static_cast<size_t>(LogComponent::COUNT), "one name per component");
+
+bool parseLevel(const std::string& name, LogLevel& level) {
+    if (name == "off"   || name == "0") level = LogLevel::OFF;
+    else if (name == "error" || name == "1") level = LogLevel::ERROR;
+    else if (name == "warn"  || name == "2") level = LogLevel::WARN;
+    else if (name == "info"  || name == "3") level = LogLevel::INFO;
+    else return false;
+    return true;
+}
+
+// Marks the thread's ring closed when the thread exits; the backend frees
+// it once drained.
+struct RingCloser {
+    LogRing* ring = nullptr;
+    ~RingCloser() {
+        if (ring) ring->closed.store(true, std::memory_order_release);
+    }
+};
+
+}
+
 Logger& Logger::instance() {
-    static Logger inst;
-    return inst;
+    // Never destroyed, so threads may still log during static destruction;
+    // at exit the rings are drained and logging turns synchronous.
+    static Logger* inst = [] {
+        auto* logger = new Logger;
+        std::atexit([] { instance().shutdown(); });
+        return logger;
+    }();
+    return *inst;
+}
+
+Logger::Logger() {
+    // Records carry raw ticks; the clock turns them into wall time.
+    Clock::init();
+    running_ = true;
+    backend_ = std::thread([this] { backendLoop(); });
+}
+
+LogRing* Logger::attachThread() {
+    thread_local RingCloser closer;
+    auto ring = std::make_unique<LogRing>();
+    LogRing* raw = ring.get();
+    {
+        std::lock_guard<std::mutex> lock(ringsMtx_);
+        rings_.push_back(std::move(ring));
+    }
+    closer.ring = raw;
+    tlsRing_ = raw;
+    return raw;
 }
 
 void Logger::setLogFile(const std::string& filename) {
+    flush();
     std::lock_guard<std::mutex> lock(mtx_);
     file_.open(filename, std::ios::app);
     toFile_ = true;
 }
 
 void Logger::disableFileLogging() {
+    flush();
     std::lock_guard<std::mutex> lock(mtx_);
     if (file_.is_open()) file_.close();
     toFile_ = false;
 }
 
-void Logger::info(const std::string& msg) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    std::string line = "[" + timestamp() + "][INFO] " + msg + "\n";
-    if (toFile_) file_ << line; else std::cout << line;
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(drainMtx_);
+    drainLocked();
 }
 
-void Logger::warn(const std::string& msg) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    std::string line = "[" + timestamp() + "][WARN] " + msg + "\n";
-    if (toFile_) file_ << line; else std::cout << line;
+void Logger::shutdown() {
+    if (running_.exchange(false) && backend_.joinable()) backend_.join();
+    stopped_.store(true, std::memory_order_relaxed);
+    flush();
 }
 
-void Logger::error(const std::string& msg) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    std::string line = "[" + timestamp() + "][ERROR] " + msg + "\n";
-    if (toFile_) file_ << line; else std::cerr << line;
+void Logger::setLevel(LogComponent component, LogLevel level) {
+    logdetail::componentLevels[static_cast<size_t>(component)].store(static_cast<uint8_t>(level),
+                                                                     std::memory_order_relaxed);
 }
 
-Logger::~Logger() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    if (file_.is_open()) {
-        file_.flush();
-        file_.close();
+LogLevel Logger::level(LogComponent component) {
+    return static_cast<LogLevel>(
+        logdetail::componentLevels[static_cast<size_t>(component)].load(std::memory_order_relaxed));
+}
+
+bool Logger::setLevels(const std::string& spec) {
+    constexpr size_t N = static_cast<size_t>(LogComponent::COUNT);
+    LogLevel levels[N];
+    for (size_t c = 0; c < N; ++c) levels[c] = level(static_cast<LogComponent>(c));
+
+    std::string text = spec;
+    for (size_t pos = text.find('#'); pos != std::string::npos; pos = text.find('#', pos)) {
+        size_t eol = text.find('\n', pos);
+        text.erase(pos, eol == std::string::npos ? std::string::npos : eol - pos);
+    }
+    std::replace(text.begin(), text.end(), ',', ' ');
+
+    std::istringstream in(text);
+    std::string entry;
+    while (in >> entry) {
+        std::transform(entry.begin(), entry.end(), entry.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        size_t eq = entry.find('=');
+        LogLevel lvl;
+        if (eq == std::string::npos || !parseLevel(entry.substr(eq + 1), lvl)) return false;
+        std::string name = entry.substr(0, eq);
+        if (name == "all") {
+            for (auto& l : levels) l = lvl;
+            continue;
+        }
+        auto it = std::find_if(std::begin(COMPONENT_NAMES), std::end(COMPONENT_NAMES),
+                               [&](const char* n) { return name == n; });
+        if (it == std::end(COMPONENT_NAMES)) return false;
+        levels[it - std::begin(COMPONENT_NAMES)] = lvl;
     }
+
+    for (size_t c = 0; c < N; ++c) setLevel(static_cast<LogComponent>(c), levels[c]);
+    return true;
+}
+
+bool Logger::watchLevelFile(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(levelFileMtx_);
+        levelFile_ = path;
+    }
+    struct sigaction sa{};
+    sa.sa_handler = &Logger::onReloadSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (::sigaction(SIGHUP, &sa, nullptr) != 0) return false;
+    reloadLevelFile();
+    return true;
+}
+
+void Logger::onReloadSignal(int) {
+    reloadRequested_.store(true, std::memory_order_relaxed);
+}
+
+void Logger::reloadLevelFile() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(levelFileMtx_);
+        path = levelFile_;
+    }
+    if (path.empty()) return;
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    if (!in || !setLevels(ss.str())) {
+        log(LogLevel::ERROR, "[Logger] bad log level file {}", path);
+        return;
+    }
+    log(LogLevel::INFO, "[Logger] log levels reloaded from {}", path);
+}
+
+void Logger::backendLoop() {
+    Placement::placeThread("logger");
+    while (running_.load(std::memory_order_relaxed)) {
+        if (reloadRequested_.exchange(false, std::memory_order_relaxed)) reloadLevelFile();
+        size_t written;
+        {
+            std::lock_guard<std::mutex> lock(drainMtx_);
+            written = drainLocked();
+        }
+        if (written == 0) std::this_thread::sleep_for(milliseconds(1));
+    }
+}
+
+size_t Logger::drainLocked() {
+    std::vector<LogRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMtx_);
+        rings.reserve(rings_.size());
+        for (auto& r : rings_) rings.push_back(r.get());
+    }
+    // A file takes every level in one stream so lines stay in time order;
+    // only the console splits ERROR onto stderr.
+    std::string& errOut = toFile_.load(std::memory_order_relaxed) ? outBuf_ : errBuf_;
+    size_t records = 0;
+    bool anyClosed = false;
+    for (LogRing* ring : rings) {
+        // Read closed first: a ring seen closed has no records still to come.
+        bool closed = ring->closed.load(std::memory_order_acquire);
+        uint64_t head = ring->head_.load(std::memory_order_relaxed);
+        uint64_t tail = ring->tail_.load(std::memory_order_acquire);
+        while (head != tail) {
+            size_t off = head & (LogRing::CAPACITY - 1);
+            if (LogRing::CAPACITY - off < sizeof(RecordHeader)) {
+                head += LogRing::CAPACITY - off;
+                continue;
+            }
+            const char* rec = ring->buf_.get() + off;
+            RecordHeader h;
+            std::memcpy(&h, rec, sizeof(h));
+            if (h.level != 0) {
+                formatRecord(h, rec + sizeof(h),
+                             static_cast<LogLevel>(h.level) == LogLevel::ERROR ? errOut : outBuf_);
+                ++records;
+            }
+            head += h.size;
+        }
+        ring->head_.store(head, std::memory_order_release);
+
+        uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped) {
+            droppedTotal_.fetch_add(dropped, std::memory_order_relaxed);
+            appendTimestamp(Clock::now(), outBuf_);
+            outBuf_ += "[WARN] [Logger] dropped " + std::to_string(dropped) + " message(s), ring full\n";
+        }
+        anyClosed |= closed;
+    }
+
+    if (anyClosed) {
+        std::lock_guard<std::mutex> lock(ringsMtx_);
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            LogRing* r = it->get();
+            bool drained = r->head_.load(std::memory_order_relaxed) ==
+                           r->tail_.load(std::memory_order_acquire);
+            if (r->closed.load(std::memory_order_acquire) && drained) {
+                it = rings_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (!outBuf_.empty() || !errBuf_.empty()) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (toFile_) {
+            file_ << outBuf_ << errBuf_;
+            file_.flush();
+        } else {
+            std::cout << outBuf_ << std::flush;
+            std::cerr << errBuf_;
+        }
+        outBuf_.clear();
+        errBuf_.clear();
+    }
+    return records;
 }
 
-std::string Logger::timestamp() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    auto t = system_clock::to_time_t(now);
-    char buf[32];
-    std::strftime(buf, sizeof(buf), "%F %T", std::localtime(&t));
-    return std::string(buf);
+void Logger::formatRecord(const RecordHeader& h, const char* args, std::string& out) {
+    appendTimestamp(h.tsc, out);
+    out += levelTag(h.level);
+
+    unsigned left = h.argc;
+    for (const char* f = h.fmt; *f;) {
+        if (f[0] != '{' || f[1] != '}' || left == 0) {
+            out.push_back(*f++);
+            continue;
+        }
+        f += 2;
+        --left;
+        auto type = static_cast<ArgType>(*args++);
+        char num[32];
+        switch (type) {
+            case ArgType::BOOL:
+                out += *args++ ? "true" : "false";
+                break;
+            case ArgType::CHAR:
+                out.push_back(*args++);
+                break;
+            case ArgType::STR: {
+                uint32_t len;
+                std::memcpy(&len, args, 4);
+                out.append(args + 4, len);
+                args += 4 + len;
+                break;
+            }
+            case ArgType::I64: {
+                int64_t v;
+                std::memcpy(&v, args, 8);
+                args += 8;
+                out.append(num, std::snprintf(num, sizeof(num), "%lld", static_cast<long long>(v)));
+                break;
+            }
+            case ArgType::U64: {
+                uint64_t v;
+                std::memcpy(&v, args, 8);
+                args += 8;
+                out.append(num, std::snprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(v)));
+                break;
+            }
+            case ArgType::F64: {
+                double v;
+                std::memcpy(&v, args, 8);
+                args += 8;
+                out.append(num, std::snprintf(num, sizeof(num), "%.10g", v));
+                break;
+            }
+        }
+    }
+    out.push_back('\n');
 }
 
-}
\ No newline at end of file
+void Logger::appendTimestamp(uint64_t tsc, std::string& out) {
+    int64_t ns = Clock::realtimeNs(tsc);
+    int64_t sec = ns / 1000000000;
+    // strftime only when the second changes.
+    if (sec != cachedSec_) {
+        std::time_t t = static_cast<std::time_t>(sec);
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        std::strftime(cachedSecText_, sizeof(cachedSecText_), "%F %T", &tm);
+        cachedSec_ = sec;
+    }
+    char frac[16];
+    std::snprintf(frac, sizeof(frac), ".%06lld]", static_cast<long long>((ns % 1000000000) / 1000));
+    out.push_back('[');
+    out += cachedSecText_;
+    out += frac;
+}
+
+}
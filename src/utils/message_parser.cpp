@@ -0,0 +1,244 @@
+#include "utils/message_parser.h"
+#include <charconv>
+#include <climits>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace dispatch;
+
+namespace utils {
+
+namespace {
+
+enum class Field { TYPE, SYMBOL, SIDE, PRICE, QTY, ORDER_ID, OTHER };
+
+Field fieldOf(std::string_view key) {
+    if (key == "type")    return Field::TYPE;
+    if (key == "symbol")  return Field::SYMBOL;
+    if (key == "side")    return Field::SIDE;
+    if (key == "price")   return Field::PRICE;
+    if (key == "qty")     return Field::QTY;
+    if (key == "orderId") return Field::ORDER_ID;
+    return Field::OTHER;
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline void skipWs(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+}
+
+// Length of the run of bytes that can appear verbatim in a string without
+// needing the generic parser: stops at '"', '\\', control characters and
+// non-ASCII bytes (the signed compare against 0x20 catches both).
+size_t plainRun(const char* p, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i quote  = _mm256_set1_epi8('"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i space  = _mm256_set1_epi8(0x20);
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                                     _mm256_cmpeq_epi8(v, bslash)),
+                                    _mm256_cmpgt_epi8(space, v));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+#elif defined(__SSE2__)
+    const __m128i quote  = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i space  = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                              _mm_cmpeq_epi8(v, bslash)),
+                                 _mm_cmplt_epi8(v, space));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+#endif
+    for (; i < n; ++i) {
+        auto c = static_cast<signed char>(p[i]);
+        if (c == '"' || c == '\\' || c < 0x20) return i;
+    }
+    return n;
+}
+
+// p points just past the opening quote.
+bool scanString(const char*& p, const char* end, std::string_view& out) {
+    size_t n = plainRun(p, static_cast<size_t>(end - p));
+    if (p + n == end || p[n] != '"') return false;
+    out = std::string_view(p, n);
+    p += n + 1;
+    return true;
+}
+
+// Validates one JSON number starting at p.
+bool scanNumber(const char*& p, const char* end, bool& integral) {
+    const char* s = p;
+    if (s < end && *s == '-') ++s;
+    if (s == end) return false;
+    if (*s == '0') {
+        ++s;
+    } else if (*s >= '1' && *s <= '9') {
+        while (s < end && isDigit(*s)) ++s;
+    } else {
+        return false;
+    }
+    integral = true;
+    if (s < end && *s == '.') {
+        ++s;
+        if (s == end || !isDigit(*s)) return false;
+        while (s < end && isDigit(*s)) ++s;
+        integral = false;
+    }
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        ++s;
+        if (s < end && (*s == '+' || *s == '-')) ++s;
+        if (s == end || !isDigit(*s)) return false;
+        while (s < end && isDigit(*s)) ++s;
+        integral = false;
+    }
+    p = s;
+    return true;
+}
+
+// Integers that fit 64 bits convert the way nlohmann does (integer, then
+// cast); everything else goes through the correctly rounded decimal parse.
+bool toDouble(std::string_view tok, bool integral, double& out) {
+    const char* b = tok.data();
+    const char* e = b + tok.size();
+    if (integral) {
+        if (*b == '-') {
+            int64_t v;
+            auto r = std::from_chars(b, e, v);
+            if (r.ec == std::errc() && r.ptr == e) { out = static_cast<double>(v); return true; }
+        } else {
+            uint64_t v;
+            auto r = std::from_chars(b, e, v);
+            if (r.ec == std::errc() && r.ptr == e) { out = static_cast<double>(v); return true; }
+        }
+    }
+    auto r = std::from_chars(b, e, out);
+    return r.ec == std::errc() && r.ptr == e;
+}
+
+// parseMsgJson() reads qty/orderId as int; only take values that survive
+// that unchanged and leave coercions (floats, big integers) to it.
+bool toInt(std::string_view tok, bool integral, int& out) {
+    if (!integral) return false;
+    int64_t v;
+    auto r = std::from_chars(tok.data(), tok.data() + tok.size(), v);
+    if (r.ec != std::errc() || r.ptr != tok.data() + tok.size()) return false;
+    if (v < INT_MIN || v > INT_MAX) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+bool skipLiteral(const char*& p, const char* end) {
+    for (std::string_view lit : {"true", "false", "null"}) {
+        if (static_cast<size_t>(end - p) >= lit.size() && std::string_view(p, lit.size()) == lit) {
+            p += lit.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+bool parseOrderFast(std::string_view data, DispatchMsg& msg) {
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    std::string_view type = "UNKNOWN";
+    std::string_view symbol;
+    std::string_view side = "BUY";
+    double price = 0.0;
+    int qty = 0;
+    int orderId = 0;
+
+    skipWs(p, end);
+    if (p == end || *p != '{') return false;
+    ++p;
+    skipWs(p, end);
+
+    if (p < end && *p == '}') {
+        ++p;
+    } else {
+        while (true) {
+            skipWs(p, end);
+            if (p == end || *p != '"') return false;
+            ++p;
+            std::string_view key;
+            if (!scanString(p, end, key)) return false;
+            skipWs(p, end);
+            if (p == end || *p != ':') return false;
+            ++p;
+            skipWs(p, end);
+            if (p == end) return false;
+
+            Field field = fieldOf(key);
+            if (*p == '"') {
+                ++p;
+                std::string_view val;
+                if (!scanString(p, end, val)) return false;
+                switch (field) {
+                    case Field::TYPE:   type = val; break;
+                    case Field::SYMBOL: symbol = val; break;
+                    case Field::SIDE:   side = val; break;
+                    case Field::OTHER:  break;
+                    default:            return false;
+                }
+            } else if (*p == '-' || isDigit(*p)) {
+                const char* start = p;
+                bool integral = false;
+                if (!scanNumber(p, end, integral)) return false;
+                std::string_view tok(start, static_cast<size_t>(p - start));
+                switch (field) {
+                    case Field::PRICE:    if (!toDouble(tok, integral, price)) return false; break;
+                    case Field::QTY:      if (!toInt(tok, integral, qty)) return false; break;
+                    case Field::ORDER_ID: if (!toInt(tok, integral, orderId)) return false; break;
+                    case Field::OTHER: {
+                        // Ignored, but the generic parser still rejects overflow.
+                        double ignored;
+                        if (!toDouble(tok, integral, ignored)) return false;
+                        break;
+                    }
+                    default:              return false;
+                }
+            } else if (field != Field::OTHER || !skipLiteral(p, end)) {
+                return false;
+            }
+
+            skipWs(p, end);
+            if (p == end) return false;
+            if (*p == ',') { ++p; continue; }
+            if (*p == '}') { ++p; break; }
+            return false;
+        }
+    }
+    skipWs(p, end);
+    if (p != end) return false;
+
+    if (type == "NEW_ORDER") msg.type = MsgType::NEW_ORDER;
+    else if (type == "CANCEL_ORDER") msg.type = MsgType::CANCEL_ORDER;
+    else if (type == "MODIFY_ORDER") msg.type = MsgType::MODIFY_ORDER;
+    else if (type == "QUERY_ORDER") msg.type = MsgType::QUERY_ORDER;
+    else msg.type = MsgType::UNKNOWN;
+
+    msg.symbol.assign(symbol.data(), symbol.size());
+    msg.side    = (side == "BUY") ? core::Side::BUY : core::Side::SELL;
+    msg.price   = price;
+    msg.qty     = qty;
+    msg.orderId = orderId;
+    return true;
+}
+
+}
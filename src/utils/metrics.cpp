@@ -0,0 +1,83 @@
+#include "utils/metrics.h"
+#include <algorithm>
+#include <string_view>
+
+namespace utils {
+
+namespace detail {
+
+size_t assignMetricShard() {
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed) % Counter::SHARDS;
+}
+
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // Never destroyed: components may unregister during static destruction.
+    static MetricsRegistry* inst = new MetricsRegistry;
+    return *inst;
+}
+
+uint64_t MetricsRegistry::addCounter(std::string name, const Counter& counter) {
+    return add({0, std::move(name), MetricKind::COUNTER, &counter, nullptr});
+}
+
+uint64_t MetricsRegistry::addCounter(std::string name, GaugeFunc sample) {
+    return add({0, std::move(name), MetricKind::COUNTER, nullptr, std::move(sample)});
+}
+
+uint64_t MetricsRegistry::addGauge(std::string name, GaugeFunc sample) {
+    return add({0, std::move(name), MetricKind::GAUGE, nullptr, std::move(sample)});
+}
+
+uint64_t MetricsRegistry::add(Entry entry) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entry.id = nextId_++;
+    entries_.push_back(std::move(entry));
+    return entries_.back().id;
+}
+
+void MetricsRegistry::remove(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = std::find_if(entries_.begin(), entries_.end(), [id](const Entry& e) { return e.id == id; });
+    if (it != entries_.end()) entries_.erase(it);
+}
+
+std::vector<MetricSample> MetricsRegistry::snapshot() const {
+    std::vector<MetricSample> out;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        out.reserve(entries_.size());
+        for (const auto& e : entries_) {
+            int64_t v = e.counter ? static_cast<int64_t>(e.counter->value()) : e.sample();
+            out.push_back({e.name, e.kind, v});
+        }
+    }
+    // By metric, then labels, so each metric's series stay together.
+    std::sort(out.begin(), out.end(), [](const MetricSample& a, const MetricSample& b) {
+        std::string_view an(a.name), bn(b.name);
+        auto abase = an.substr(0, an.find('{')), bbase = bn.substr(0, bn.find('{'));
+        return abase != bbase ? abase < bbase : an < bn;
+    });
+    return out;
+}
+
+std::string MetricsRegistry::renderText() const {
+    std::string out;
+    std::string lastBase;
+    for (const auto& s : snapshot()) {
+        std::string base = s.name.substr(0, s.name.find('{'));
+        if (base != lastBase) {
+            out += "# TYPE " + base + (s.kind == MetricKind::COUNTER ? " counter\n" : " gauge\n");
+            lastBase = base;
+        }
+        out += s.name;
+        out.push_back(' ');
+        out += std::to_string(s.value);
+        out.push_back('\n');
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,140 @@
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include "utils/placement.h"
+
+namespace utils {
+
+namespace {
+
+std::mutex placementMtx;
+std::unordered_map<std::string, std::vector<int>> roleCpus;
+
+constexpr int MAX_NODES = 64;
+
+// "3" or "4-7".
+bool parseCpus(std::string_view text, std::vector<int>& out) {
+    auto number = [](std::string_view s, int& v) {
+        if (s.empty() || s.size() > 5) return false;
+        v = 0;
+        for (char ch : s) {
+            if (!std::isdigit(static_cast<unsigned char>(ch))) return false;
+            v = v * 10 + (ch - '0');
+        }
+        return v < CPU_SETSIZE;
+    };
+    size_t dash = text.find('-');
+    int lo, hi;
+    if (!number(text.substr(0, dash), lo)) return false;
+    hi = lo;
+    if (dash != std::string_view::npos && !number(text.substr(dash + 1), hi)) return false;
+    if (hi < lo) return false;
+    for (int c = lo; c <= hi; ++c) out.push_back(c);
+    return true;
+}
+
+}
+
+bool Placement::configure(const std::string& spec) {
+    std::unordered_map<std::string, std::vector<int>> roles;
+    std::string text = spec;
+    std::replace(text.begin(), text.end(), ',', ' ');
+
+    std::istringstream in(text);
+    std::string entry;
+    while (in >> entry) {
+        size_t eq = entry.find('=');
+        if (eq == std::string::npos || eq == 0) return false;
+        std::string role = entry.substr(0, eq);
+        std::transform(role.begin(), role.end(), role.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+        // Ranges for one role may be split with ':', e.g. pool=2-3:6-7.
+        std::vector<int>& cpus = roles[role];
+        std::string_view list(entry);
+        list.remove_prefix(eq + 1);
+        while (!list.empty()) {
+            size_t colon = list.find(':');
+            if (!parseCpus(list.substr(0, colon), cpus)) return false;
+            list.remove_prefix(colon == std::string_view::npos ? list.size() : colon + 1);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(placementMtx);
+    roleCpus = std::move(roles);
+    return true;
+}
+
+std::vector<int> Placement::cpusFor(const std::string& role) {
+    std::lock_guard<std::mutex> lock(placementMtx);
+    auto it = roleCpus.find(role);
+    return it == roleCpus.end() ? std::vector<int>{} : it->second;
+}
+
+int Placement::placeThread(const std::string& role, size_t index) {
+    nameThread(role + "-" + std::to_string(index));
+    std::vector<int> cpus = cpusFor(role);
+    if (cpus.empty()) return -1;
+    int cpu = cpus[index % cpus.size()];
+    return pinThread(cpu) ? cpu : -1;
+}
+
+int Placement::nodeOfCpu(int cpu) {
+    // The cpu's sysfs directory links to its node as nodeN.
+    for (int node = 0; node < MAX_NODES; ++node) {
+        std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/node" + std::to_string(node);
+        if (::access(path.c_str(), F_OK) == 0) return node;
+    }
+    return -1;
+}
+
+int Placement::nodeFor(const std::string& role, size_t index) {
+    std::vector<int> cpus = cpusFor(role);
+    return cpus.empty() ? -1 : nodeOfCpu(cpus[index % cpus.size()]);
+}
+
+int Placement::currentNode() {
+    unsigned cpu = 0, node = 0;
+    if (::getcpu(&cpu, &node) != 0) return -1;
+    return static_cast<int>(node);
+}
+
+bool pinThread(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool lockMemory() {
+    rlimit lim{};
+    int flags = MCL_CURRENT;
+    if (::getrlimit(RLIMIT_MEMLOCK, &lim) == 0 && lim.rlim_cur == RLIM_INFINITY) flags |= MCL_FUTURE;
+    return ::mlockall(flags) == 0;
+}
+
+void nameThread(const std::string& name) {
+    ::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str());
+}
+
+ScopedMemoryNode::ScopedMemoryNode(int node) {
+    if (node < 0 || node >= MAX_NODES) return;
+    unsigned long mask = 1ul << node;
+    active_ = ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, MAX_NODES + 1) == 0;
+}
+
+ScopedMemoryNode::~ScopedMemoryNode() {
+    if (active_) ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+}
+
+}
@@ -0,0 +1,50 @@
+#include "utils/rcu.h"
+#include <stdexcept>
+#include <thread>
+
+namespace utils {
+
+Rcu& Rcu::instance() {
+    static Rcu inst;
+    return inst;
+}
+
+detail::RcuReaderState::~RcuReaderState() {
+    if (slot) {
+        slot->epoch.store(0, std::memory_order_release);
+        slot->owned.store(false, std::memory_order_release);
+    }
+}
+
+detail::RcuReaderSlot* Rcu::acquireSlot() {
+    for (auto& s : slots_) {
+        bool expected = false;
+        if (!s.owned.load(std::memory_order_relaxed) &&
+            s.owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return &s;
+        }
+    }
+    throw std::runtime_error("Rcu reader slots exhausted");
+}
+
+uint64_t Rcu::retire() {
+    uint64_t target = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return target;
+}
+
+bool Rcu::elapsed(uint64_t ticket) const {
+    for (const auto& s : slots_) {
+        if (!s.owned.load(std::memory_order_acquire)) continue;
+        uint64_t e = s.epoch.load(std::memory_order_acquire);
+        if (e != 0 && e < ticket) return false;
+    }
+    return true;
+}
+
+void Rcu::synchronize() {
+    uint64_t target = retire();
+    while (!elapsed(target)) std::this_thread::yield();
+}
+
+}
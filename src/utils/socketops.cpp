@@ -1,6 +1,7 @@
 #include "utils/socketops.h"
 #include "utils/logger.h"
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
@@ -72,4 +73,52 @@ int createListenSocket(const std::string& host, uint16_t port, int backlog) {
     return fd;
 }
 
-}
\ No newline at end of file
+int createUnixListenSocket(const std::string& path, int backlog) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("[SocketOps] Unix socket path too long: " + path);
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("[SocketOps] socket(AF_UNIX) failed: " + std::string(std::strerror(errno)));
+        return -1;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        LOG_ERROR("[SocketOps] bind(" + path + ") failed: " + std::string(std::strerror(errno)));
+        close(fd);
+        return -1;
+    }
+
+    setNonBlocking(fd);
+    if (listen(fd, backlog) < 0) {
+        LOG_ERROR("[SocketOps] listen(" + path + ") failed: " + std::string(std::strerror(errno)));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int connectUnixSocket(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}
@@ -1,47 +1,207 @@
 #include "utils/thread_pool.h"
+#include "utils/lock_free_queue.h"
 #include "utils/logger.h"
+#include "utils/placement.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace utils {
 
-ThreadPool::ThreadPool(size_t nThreads)
-    : nThreads_(nThreads ? nThreads : 1) {}
+namespace {
 
+constexpr int SPIN_ROUNDS  = 256;
+constexpr int YIELD_ROUNDS = 16;
+
+// Pool workers are numbered across every pool for placement.
+std::atomic<size_t> nextWorkerSlot{0};
+
+}
+
+struct ThreadPool::Worker {
+    explicit Worker(size_t capacity) : pinned(capacity), shared(capacity) {}
+
+    LockFreeQueue<Task> pinned;   // keyed tasks, run only by this worker
+    LockFreeQueue<Task> shared;   // open to thieves
+    // Spill for both queues, run only by this worker. While it holds
+    // anything, pinned tasks queue behind it to stay in submission order.
+    std::mutex overflowMtx;
+    std::deque<Task> overflow;
+    std::atomic<size_t> overflowed{0};
+    alignas(64) std::atomic<bool> parked{false};
+    std::mutex parkMtx;
+    std::condition_variable parkCv;
+};
+
+ThreadPool::ThreadPool(size_t nThreads, size_t queueCapacity)
+    : nThreads_(nThreads ? nThreads : 1)
+{
+    workers_.reserve(nThreads_);
+    for (size_t i = 0; i < nThreads_; ++i) workers_.push_back(std::make_unique<Worker>(queueCapacity));
+    registerMetrics();
+}
+
+void ThreadPool::registerMetrics() {
+    std::string id = std::to_string(id_);
+    auto name = [&id](const char* metric) { return labelled(metric, "pool", id); };
+
+    metrics_.counter(name("pool_tasks_total"), executed_);
+    metrics_.counter(name("pool_stolen_total"), stolen_);
+    metrics_.counter(name("pool_spilled_total"), spilled_);
+    metrics_.gauge(name("pool_queued_tasks"), [this] {
+        size_t n = 0;
+        for (const auto& w : workers_) {
+            n += w->pinned.size() + w->shared.size() + w->overflowed.load(std::memory_order_relaxed);
+        }
+        return static_cast<int64_t>(n);
+    });
+    metrics_.gauge(name("pool_parked_workers"), [this] {
+        return static_cast<int64_t>(parkedWorkers_.load(std::memory_order_relaxed));
+    });
+}
 
 ThreadPool::~ThreadPool() { shutdown(); }
 
+int ThreadPool::nextInstanceId() {
+    static std::atomic<int> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
 void ThreadPool::startWorkers() {
     if (poolRunning_.exchange(true)) return;
     for (size_t i = 0; i < nThreads_; ++i) {
-        workers_.emplace_back([this, i] { runWorkerLoop(i); });
+        size_t slot = nextWorkerSlot.fetch_add(1, std::memory_order_relaxed);
+        threads_.emplace_back([this, i, slot] {
+            Placement::placeThread("pool", slot);
+            runWorkerLoop(i);
+        });
     }
 }
 
 void ThreadPool::shutdown() {
     if (!poolRunning_.exchange(false)) return;
-    cv_.notify_all();
-    for (auto &t : workers_) {
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->parkMtx);
+        w->parkCv.notify_all();
+    }
+    for (auto &t : threads_) {
         if (t.joinable()) t.join();
     }
 }
 
+bool ThreadPool::enqueue(size_t idx, bool pinned, Task&& task) {
+    if (!poolRunning_.load(std::memory_order_acquire)) return false;
+    Worker& w = *workers_[idx];
+    LockFreeQueue<Task>& q = pinned ? w.pinned : w.shared;
+    // A failed push leaves the task where it is.
+    if ((pinned && w.overflowed.load(std::memory_order_acquire) > 0) || !q.push(std::move(task))) {
+        std::lock_guard<std::mutex> lock(w.overflowMtx);
+        w.overflow.push_back(std::move(task));
+        w.overflowed.fetch_add(1, std::memory_order_release);
+        spilled_.inc();
+    }
+
+    // Pairs with the fence in park(): either the worker sees the task or we
+    // see it parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w.parked.load(std::memory_order_relaxed)) {
+        wake(w);
+    } else if (!pinned && parkedWorkers_.load(std::memory_order_relaxed) > 0) {
+        // The owner is busy; hand the task to an idle worker to steal.
+        for (size_t k = 1; k < nThreads_; ++k) {
+            Worker& other = *workers_[(idx + k) % nThreads_];
+            if (other.parked.load(std::memory_order_relaxed)) {
+                wake(other);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+void ThreadPool::wake(Worker& w) {
+    std::lock_guard<std::mutex> lock(w.parkMtx);
+    w.parked.store(false, std::memory_order_relaxed);
+    w.parkCv.notify_one();
+}
+
+bool ThreadPool::findTask(size_t id, Task& out) {
+    Worker& self = *workers_[id];
+    if (self.pinned.pop(out) || self.shared.pop(out) || popOverflow(self, out)) return true;
+    for (size_t k = 1; k < nThreads_; ++k) {
+        if (workers_[(id + k) % nThreads_]->shared.pop(out)) {
+            stolen_.inc();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::popOverflow(Worker& w, Task& out) {
+    if (w.overflowed.load(std::memory_order_acquire) == 0) return false;
+    std::lock_guard<std::mutex> lock(w.overflowMtx);
+    if (w.overflow.empty()) return false;
+    out = std::move(w.overflow.front());
+    w.overflow.pop_front();
+    w.overflowed.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+bool ThreadPool::hasWork(size_t id) const {
+    const Worker& self = *workers_[id];
+    if (!self.pinned.empty() || self.overflowed.load(std::memory_order_relaxed) > 0) return true;
+    for (auto& w : workers_) {
+        if (!w->shared.empty()) return true;
+    }
+    return false;
+}
+
+void ThreadPool::park(size_t id) {
+    Worker& self = *workers_[id];
+    std::unique_lock<std::mutex> lock(self.parkMtx);
+    self.parked.store(true, std::memory_order_relaxed);
+    parkedWorkers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!hasWork(id) && poolRunning_.load(std::memory_order_acquire)) {
+        self.parkCv.wait(lock, [&] {
+            return !self.parked.load(std::memory_order_relaxed) ||
+                   !poolRunning_.load(std::memory_order_acquire);
+        });
+    }
+    self.parked.store(false, std::memory_order_relaxed);
+    parkedWorkers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
 void ThreadPool::runWorkerLoop(size_t id) {
-    LOG_INFO("[ThreadPool] Worker #" + std::to_string(id) + " started");
+    LOG_INFO("[ThreadPool] Worker #{} started", id);
+    Task task;
+    int idle = 0;
     while (true) {
-        std::function<void()> taskFn;
-        {
-            std::unique_lock<std::mutex> lock(mtx_);
-            cv_.wait(lock, [&]{ return !poolRunning_ || !tasks_.empty(); });
-            if (!poolRunning_ && tasks_.empty()) break;
-            taskFn = std::move(tasks_.front());
-            tasks_.pop();
+        if (findTask(id, task)) {
+            idle = 0;
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_ERROR("[ThreadPool] Worker #{} exception: {}", id, std::string_view(e.what()));
+            } catch (...) {
+                LOG_ERROR("[ThreadPool] Worker #{} unknown exception", id);
+            }
+            // Drop the captures now rather than when the next task arrives.
+            task.reset();
+            executed_.inc();
+            continue;
         }
 
-        try {
-            if (taskFn) taskFn();
-        } catch (const std::exception& e) {
-            LOG_ERROR("[ThreadPool] Worker #" + std::to_string(id) + " exception: " + e.what());
-        } catch (...) {
-            LOG_ERROR("[ThreadPool] Worker #" + std::to_string(id) + " unknown exception");
+        // Queued tasks still run after shutdown; exit once none are left.
+        if (!poolRunning_.load(std::memory_order_acquire) && !hasWork(id)) break;
+
+        if (++idle <= SPIN_ROUNDS) {
+            lfq::cpuRelax();
+        } else if (idle <= SPIN_ROUNDS + YIELD_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            park(id);
+            idle = 0;
         }
     }
 }
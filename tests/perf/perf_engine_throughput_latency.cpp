@@ -25,7 +25,7 @@ dispatch::DispatchMsg makeNewOrder(const std::string& sym, Side sd, double price
     m.side    = sd;
     m.price   = price;
     m.qty     = qty;
-    m.fd      = -1;
+    m.sessionId = INVALID_SESSION;
     m.orderId = nextOrderId();
     return m;
 }
@@ -35,7 +35,7 @@ dispatch::DispatchMsg makeCancelOrder(const std::string& sym, uint64_t orderId)
     m.type    = MsgType::CANCEL_ORDER;
     m.symbol  = sym;
     m.orderId = orderId;
-    m.fd      = -1;
+    m.sessionId = INVALID_SESSION;
     return m;
 }
 
@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <memory>
 #include <chrono>
 #include <thread>
 #include <vector>
@@ -9,11 +12,13 @@
 #include <netinet/in.h>
 #include <unistd.h>
 
-#include "net/epoll_reactor.h"
+#include "net/reactor.h"
 #include "net/tcp_server.h"
+#include "net/tcp_server_group.h"
 #include "dispatch/dispatcher.h"
 #include "engine/matching_engine.h"
 #include "engine/engine_router.h"
+#include "utils/binary_protocol.h"
 #include "utils/logger.h"
 
 using namespace std::chrono;
@@ -21,32 +26,58 @@ using namespace net;
 using namespace dispatch;
 using namespace engine;
 using namespace utils;
+using namespace core;
 
 static std::atomic<uint64_t> gAcceptCount{0};
 static std::atomic<uint64_t> gReadCount{0};
 
 class TpsTcpServer : public TcpServer {
 public:
-    TpsTcpServer(EpollReactor& r, Dispatcher& d,
+    TpsTcpServer(Reactor& r, ConnectionRegistry& reg, Dispatcher& d,
                  const std::string& ip, int port)
-        : TcpServer(r, d, ip, port) {}
+        : TcpServer(r, d, ip, port, std::thread::hardware_concurrency(), &reg) {}
 
 protected:
-    void handleAccept(int listenFd, uint32_t events) override {
+    void handleAccept(int connFd) override {
         gAcceptCount.fetch_add(1, std::memory_order_relaxed);
-        TcpServer::handleAccept(listenFd, events);
+        TcpServer::handleAccept(connFd);
     }
 
-    void handleRead(int connFd, uint32_t events) override {
+    void handleRead(const std::shared_ptr<TcpConnection>& conn, uint32_t events) override {
         gReadCount.fetch_add(1, std::memory_order_relaxed);
-        TcpServer::handleRead(connFd, events);
+        TcpServer::handleRead(conn, events);
+    }
+
+    size_t handleData(const std::shared_ptr<TcpConnection>& conn, const char* data, size_t len) override {
+        gReadCount.fetch_add(1, std::memory_order_relaxed);
+        return TcpServer::handleData(conn, data, len);
     }
 };
 
-void clientStormWorker(int port, std::atomic<bool>& running, int clientId) {
-    const char* msg =
-        "{\"type\":\"NEW_ORDER\",\"symbol\":\"AAPL\",\"side\":\"BUY\","
-        "\"price\":100.01,\"qty\":100}\n";
+// Alternating buy/sell at one price so the book stays shallow.
+std::string buildPayload(bool binary) {
+    if (!binary) {
+        return "{\"type\":\"NEW_ORDER\",\"symbol\":\"AAPL\",\"side\":\"BUY\","
+               "\"price\":100.01,\"qty\":100}\n"
+               "{\"type\":\"NEW_ORDER\",\"symbol\":\"AAPL\",\"side\":\"SELL\","
+               "\"price\":100.01,\"qty\":100}\n";
+    }
+    std::string out;
+    for (Side side : {Side::BUY, Side::SELL}) {
+        DispatchMsg m;
+        m.type   = MsgType::NEW_ORDER;
+        m.symbol = "AAPL";
+        m.side   = side;
+        m.price  = 100.01;
+        m.qty    = 100;
+        char frame[BIN_MAX_FRAME];
+        out.append(frame, encodeBinaryOrder(m, frame, sizeof(frame)));
+    }
+    return out;
+}
+
+void clientStormWorker(int port, std::atomic<bool>& running, int clientId, bool binary) {
+    const std::string msg = buildPayload(binary);
 
     int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (fd < 0) {
@@ -75,20 +106,24 @@ void clientStormWorker(int port, std::atomic<bool>& running, int clientId) {
 
 
     while (running.load(std::memory_order_acquire)) {
-        ::send(fd, msg, std::strlen(msg), MSG_NOSIGNAL);
+        ::send(fd, msg.data(), msg.size(), MSG_NOSIGNAL);
     }
 
     ::close(fd);
 }
 
-int main() {
-    const int PORT       = 9000;
-    const int TEST_SEC   = 5;
-    const int CLIENT_NUM = 8;
-
-    std::cout << "=== Gateway TPS Benchmark Starting ===" << std::endl;
+int main(int argc, char** argv) {
+    // perf_gateway_tps [json|binary] [reactors] [clients] [epoll|uring]
+    const bool BINARY      = argc > 1 && std::string(argv[1]) == "binary";
+    const bool URING       = argc > 4 && std::string(argv[4]) == "uring";
+    const size_t REACTORS  = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1;
+    const int PORT         = 9000;
+    const int TEST_SEC     = 5;
+    const int CLIENT_NUM   = argc > 3 ? std::max(1, std::atoi(argv[3])) : 8;
 
-    EpollReactor reactor;
+    std::cout << "=== Gateway TPS Benchmark Starting (" << (BINARY ? "binary" : "json")
+              << ", " << REACTORS << (URING ? " io_uring" : " epoll") << " reactors, "
+              << CLIENT_NUM << " clients) ===" << std::endl;
 
     Dispatcher dispatcher(1024);
     dispatcher.startDispatcher();
@@ -104,29 +139,29 @@ int main() {
     engine->startEngine();
     dispatcher.attachEngine(engine);
 
-    TpsTcpServer server(reactor, dispatcher, "0.0.0.0", PORT);
-    server.startServer();
+    TcpServerGroup servers(REACTORS, [&](Reactor& r, ConnectionRegistry& reg) {
+        return std::make_unique<TpsTcpServer>(r, reg, dispatcher, "0.0.0.0", PORT);
+    }, URING ? ReactorKind::IO_URING : ReactorKind::EPOLL);
+    servers.startGroup();
 
-    dispatcher.setSender([&](int fd, const std::string& payload){
+    dispatcher.setSender([&](SessionId, const std::string&){
         return true;
     });
 
-    std::thread reactorThread([&]{
-        reactor.runEventLoop();
-    });
-
     std::atomic<bool> running{true};
     std::vector<std::thread> clients;
     clients.reserve(CLIENT_NUM);
     for (int i = 0; i < CLIENT_NUM; ++i) {
-        clients.emplace_back(clientStormWorker, PORT, std::ref(running), i + 1);
+        clients.emplace_back(clientStormWorker, PORT, std::ref(running), i + 1, BINARY);
     }
 
     auto t0 = steady_clock::now();
+    uint64_t ordersStart = engine->inboundProcessed_.load(std::memory_order_relaxed);
     std::this_thread::sleep_for(std::chrono::seconds(TEST_SEC));
     running.store(false, std::memory_order_release);
 
     for (auto& t : clients) t.join();
+    uint64_t orders = engine->inboundProcessed_.load(std::memory_order_relaxed) - ordersStart;
 
     auto t1 = steady_clock::now();
     double sec = std::max(1e-6, duration<double>(t1 - t0).count());
@@ -139,7 +174,9 @@ int main() {
     std::cout << "[Total Read  ] = " << totalR << "\n";
     std::cout << "[Accept TPS  ] = " << (totalA / sec) << "\n";
     std::cout << "[Read   TPS  ] = " << (totalR / sec) << "\n";
-    std::cout << "[Benchmark] Gateway TPS Benchmark Finished.\n";
+    std::cout << "[Orders      ] = " << orders << "\n";
+    std::cout << "[Orders/sec  ] = " << (orders / sec) << "\n";
+    std::cout << "[Benchmark] Gateway TPS Benchmark Finished." << std::endl;
     
     ::_exit(0);
 }
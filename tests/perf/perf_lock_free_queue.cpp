@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include "concurrentqueue/concurrentqueue.h"
+#include "dispatch/dispatch_msg.h"
+#include "utils/lock_free_queue.h"
+
+using namespace std::chrono;
+using namespace utils;
+using dispatch::DispatchMsg;
+
+// Queue throughput on the engine's own message type, producers and one
+// consumer on separate threads. boost::lockfree::queue is left out: it
+// only takes trivially copyable types, which DispatchMsg is not.
+static constexpr size_t CAPACITY = 8192;
+static constexpr size_t BATCH = 32;
+
+static DispatchMsg makeMsg(uint64_t i) {
+    DispatchMsg m;
+    m.type    = dispatch::MsgType::NEW_ORDER;
+    m.symbol  = "AAPL";
+    m.price   = 100.0 + (i % 100) * 0.01;
+    m.qty     = 10;
+    m.orderId = i;
+    return m;
+}
+
+// push(msg) / pop(msg) wrap one implementation; returns messages per second.
+template<typename Push, typename Pop>
+static double run(int producers, int perProducer, Push push, Pop pop) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            std::vector<DispatchMsg> batch(BATCH);
+            for (size_t j = 0; j < BATCH; ++j) batch[j] = makeMsg(p);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < perProducer;) {
+                size_t n = push(batch, std::min<size_t>(BATCH, perProducer - i));
+                if (n == 0) std::this_thread::yield();
+                i += static_cast<int>(n);
+            }
+        });
+    }
+
+    const uint64_t total = static_cast<uint64_t>(producers) * perProducer;
+    std::vector<DispatchMsg> out(BATCH);
+    uint64_t received = 0;
+    auto t0 = steady_clock::now();
+    go.store(true, std::memory_order_release);
+    while (received < total) {
+        size_t n = pop(out);
+        if (n == 0) std::this_thread::yield();
+        received += n;
+    }
+    double secs = duration<double>(steady_clock::now() - t0).count();
+    for (auto& t : threads) t.join();
+    return total / secs;
+}
+
+static void report(const char* name, double rate) {
+    std::cout << "  " << name << ": " << static_cast<uint64_t>(rate) << " msgs/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    // perf_lock_free_queue [messages per producer]
+    const int N = argc > 1 ? std::max(1000, std::atoi(argv[1])) : 500000;
+    std::cout << "=== Lock-Free Queue Benchmark (" << N << " msgs/producer, DispatchMsg) ===" << std::endl;
+
+    std::cout << "[spsc, single]" << std::endl;
+    {
+        SpscQueue<DispatchMsg> q(CAPACITY);
+        report("utils::SpscQueue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t) { return q.push(b[0]) ? 1 : 0; },
+            [&](std::vector<DispatchMsg>& o) { return q.pop(o[0]) ? 1 : 0; }));
+    }
+    {
+        boost::lockfree::spsc_queue<DispatchMsg> q(CAPACITY);
+        report("boost::lockfree::spsc_queue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t) { return q.push(b[0]) ? 1 : 0; },
+            [&](std::vector<DispatchMsg>& o) { return q.pop(o[0]) ? 1 : 0; }));
+    }
+    {
+        moodycamel::ConcurrentQueue<DispatchMsg> q(CAPACITY);
+        report("moodycamel::ConcurrentQueue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t) { return q.enqueue(b[0]) ? 1 : 0; },
+            [&](std::vector<DispatchMsg>& o) { return q.try_dequeue(o[0]) ? 1 : 0; }));
+    }
+
+    std::cout << "[spsc, batch of " << BATCH << "]" << std::endl;
+    {
+        SpscQueue<DispatchMsg> q(CAPACITY);
+        report("utils::SpscQueue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t n) { return q.pushBatch(b.data(), n); },
+            [&](std::vector<DispatchMsg>& o) { return q.popBatch(o.data(), o.size()); }));
+    }
+    {
+        boost::lockfree::spsc_queue<DispatchMsg> q(CAPACITY);
+        report("boost::lockfree::spsc_queue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t n) { return q.push(b.data(), n); },
+            [&](std::vector<DispatchMsg>& o) { return q.pop(o.data(), o.size()); }));
+    }
+    {
+        moodycamel::ConcurrentQueue<DispatchMsg> q(CAPACITY);
+        report("moodycamel::ConcurrentQueue", run(1, N,
+            [&](std::vector<DispatchMsg>& b, size_t n) { return q.enqueue_bulk(b.data(), n) ? n : 0; },
+            [&](std::vector<DispatchMsg>& o) { return q.try_dequeue_bulk(o.data(), o.size()); }));
+    }
+
+    for (int producers : {2, 4}) {
+        std::cout << "[mpsc, " << producers << " producers, batch of " << BATCH << "]" << std::endl;
+        {
+            MpscQueue<DispatchMsg> q(CAPACITY);
+            report("utils::MpscQueue", run(producers, N,
+                [&](std::vector<DispatchMsg>& b, size_t n) { return q.pushBatch(b.data(), n); },
+                [&](std::vector<DispatchMsg>& o) { return q.popBatch(o.data(), o.size()); }));
+        }
+        {
+            LockFreeQueue<DispatchMsg> q(CAPACITY);
+            report("utils::LockFreeQueue", run(producers, N,
+                [&](std::vector<DispatchMsg>& b, size_t n) { return q.pushBatch(b.data(), n); },
+                [&](std::vector<DispatchMsg>& o) { return q.popBatch(o.data(), o.size()); }));
+        }
+        {
+            moodycamel::ConcurrentQueue<DispatchMsg> q(CAPACITY);
+            report("moodycamel::ConcurrentQueue", run(producers, N,
+                [&](std::vector<DispatchMsg>& b, size_t n) { return q.enqueue_bulk(b.data(), n) ? n : 0; },
+                [&](std::vector<DispatchMsg>& o) { return q.try_dequeue_bulk(o.data(), o.size()); }));
+        }
+    }
+
+    std::cout << "[Benchmark] Lock-Free Queue Benchmark Finished." << std::endl;
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/message_encoder.h"
+#include "dispatch/dispatch_msg.h"
+
+using namespace std::chrono;
+using namespace dispatch;
+
+// Encodes the same mix of ACK / fill / cancel reports with the DOM encoder
+// and the direct-to-buffer one.
+int main() {
+    const int N      = 200000;
+    const int ROUNDS = 5;
+
+    std::vector<DispatchMsg> reports;
+    reports.reserve(N);
+    for (int i = 0; i < N; ++i) {
+        DispatchMsg m;
+        m.symbol  = "MAOTAI";
+        m.orderId = 1000000 + i;
+        switch (i % 3) {
+            case 0:
+                m.type   = MsgType::ACK;
+                m.status = "ACCEPTED";
+                break;
+            case 1:
+                m.type    = MsgType::TRADE_REPORT;
+                m.price   = 1800.0 + (i % 500) * 0.01;
+                m.qty     = 1 + i % 100;
+                m.makerId = 500000 + i;
+                m.takerId = 1000000 + i;
+                break;
+            default:
+                m.type   = MsgType::CANCEL_REPORT;
+                m.status = "CANCELED";
+                break;
+        }
+        reports.push_back(std::move(m));
+    }
+
+    std::cout << "=== Message Encoder Benchmark (" << N << " reports x " << ROUNDS << ") ===\n";
+
+    size_t sink = 0;
+    auto t0 = steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (const auto& m : reports) sink += utils::encodeMsgJson(m).size();
+    }
+    double domSec = duration<double>(steady_clock::now() - t0).count();
+
+    std::string buf;
+    t0 = steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (const auto& m : reports) {
+            utils::encodeMsg(m, buf);
+            sink += buf.size();
+        }
+    }
+    double fastSec = duration<double>(steady_clock::now() - t0).count();
+
+    double total = double(N) * ROUNDS;
+    std::cout << "[DOM encoder     ] = " << (total / domSec) << " msgs/sec\n";
+    std::cout << "[Direct encoder  ] = " << (total / fastSec) << " msgs/sec\n";
+    std::cout << "[Speedup         ] = " << (domSec / fastSec) << "x\n";
+    std::cout << "[Bytes           ] = " << sink << "\n";
+    return 0;
+}
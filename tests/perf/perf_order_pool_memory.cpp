@@ -0,0 +1,120 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stack>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/matching_engine.h"
+#include "dispatch/dispatch_msg.h"
+
+using namespace dispatch;
+using namespace core;
+
+static double rssMb() {
+    std::ifstream statm("/proc/self/statm");
+    size_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return static_cast<double>(resident) * static_cast<double>(::sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+// What every book used to carry: its own fully built pool.
+struct PerBookPool {
+    explicit PerBookPool(size_t capacity) : orders(capacity) {
+        for (auto& o : orders) freeList.push(&o);
+    }
+    std::vector<Order> orders;
+    std::stack<Order*> freeList;
+};
+
+static void perBookBaseline(size_t symbols, size_t poolSize) {
+    double before = rssMb();
+    std::vector<std::unique_ptr<PerBookPool>> pools;
+    for (size_t i = 0; i < symbols; ++i) pools.push_back(std::make_unique<PerBookPool>(poolSize));
+    double perSymbol = (rssMb() - before) / static_cast<double>(symbols);
+    std::cout << "[per-book pools] " << symbols << " symbols x " << poolSize << " orders: "
+              << perSymbol << " MB/symbol, " << perSymbol * 10000 / 1024
+              << " GB for 10000 symbols (extrapolated)" << std::endl;
+}
+
+static void pushAll(engine::MatchingEngine& eng, const std::vector<DispatchMsg>& orders) {
+    for (const auto& o : orders) {
+        while (!eng.pushInbound(DispatchMsg(o))) {
+            DispatchMsg out;
+            while (eng.popOutbound(out)) {}
+            std::this_thread::yield();
+        }
+    }
+    DispatchMsg out;
+    while (eng.inboundProcessed_.load() < orders.size()) {
+        while (eng.popOutbound(out)) {}
+        std::this_thread::yield();
+    }
+    while (eng.popOutbound(out)) {}
+}
+
+static void sharedArena(size_t symbols, size_t hotSymbols, size_t hotDepth) {
+    double before = rssMb();
+    engine::MatchingEngine eng(1 << 16, 1 << 16);
+    for (size_t i = 0; i < symbols; ++i) eng.registerSymbol("S" + std::to_string(i));
+    eng.startEngine();
+    double registered = rssMb();
+
+    // One resting order on every symbol, then deep books on the hot ones.
+    std::vector<DispatchMsg> orders;
+    auto rest = [&](size_t sym, double price) {
+        DispatchMsg m;
+        m.type = MsgType::NEW_ORDER;
+        m.symbol = "S" + std::to_string(sym);
+        m.side = Side::BUY;
+        m.price = price;
+        m.qty = 1;
+        orders.push_back(std::move(m));
+    };
+    for (size_t i = 0; i < symbols; ++i) rest(i, 100.0);
+    for (size_t h = 0; h < hotSymbols; ++h) {
+        for (size_t d = 0; d < hotDepth; ++d) rest(h, 90.0 + static_cast<double>(d % 100) * 0.1);
+    }
+    pushAll(eng, orders);
+    double loaded = rssMb();
+
+    const auto& arena = eng.orderArena();
+    std::cout << "[shared arena] " << symbols << " symbols registered: +" << registered - before
+              << " MB; after 1 order each and " << hotSymbols << " hot books of " << hotDepth
+              << ": +" << loaded - before << " MB, " << arena.chunksInUse() << " chunks ("
+              << arena.chunksInUse() * OrderArena::CHUNK_ORDERS * sizeof(Order) / (1 << 20)
+              << " MB of orders)" << std::endl;
+    eng.stopEngine();
+}
+
+template<typename Fn>
+static void isolated(Fn fn) {
+    std::cout.flush();
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        fn();
+        std::cout.flush();
+        std::_Exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+}
+
+int main(int argc, char** argv) {
+    // perf_order_pool_memory [symbols]
+    const size_t SYMBOLS = argc > 1 ? std::max(100, std::atoi(argv[1])) : 10000;
+    const size_t HOT = 50, HOT_DEPTH = 20000;
+    std::cout << "=== Order Pool Memory Benchmark (" << SYMBOLS << " symbols, " << sizeof(Order)
+              << "-byte orders) ===" << std::endl;
+
+    isolated([&] { perBookBaseline(std::min<size_t>(SYMBOLS, 200), 100000); });
+    isolated([&] { sharedArena(SYMBOLS, HOT, HOT_DEPTH); });
+
+    std::cout << "[Benchmark] Order Pool Memory Benchmark Finished." << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "engine/matching_engine.h"
+#include "dispatch/dispatcher.h"
+#include "dispatch/dispatch_msg.h"
+#include "core/order.h"
+
+using namespace std::chrono;
+using namespace dispatch;
+using namespace core;
+
+// Sweep-heavy flow: every round rests LEVELS single-lot asks, then one
+// aggressive buy takes them all out (ACK + LEVELS fills on one order).
+int main() {
+    const int TEST_SEC = 3;
+    const int LEVELS   = 50;
+
+    auto* engPtr = new engine::MatchingEngine(1 << 16, 1 << 16);
+    auto& eng = *engPtr;
+    eng.registerSymbol("SWEEP", 1 << 16);
+    eng.startEngine();
+
+    std::atomic<uint64_t> delivered{0};
+    Dispatcher dispatcher(1024);
+    dispatcher.setSender([&](int, const std::string&) {
+        delivered.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    });
+    dispatcher.attachEngine(&eng);
+    dispatcher.startDispatcher();
+
+    std::cout << "=== Outbound Notification Benchmark (sweep " << LEVELS << " levels) ===\n";
+
+    std::atomic<bool> running{true};
+    uint64_t rounds = 0;
+    std::thread producer([&] {
+        while (running.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < LEVELS; ++i) {
+                DispatchMsg ask;
+                ask.type   = MsgType::NEW_ORDER;
+                ask.symbol = "SWEEP";
+                ask.side   = Side::SELL;
+                ask.price  = 100.0 + i * 0.01;
+                ask.qty    = 1;
+                while (!eng.pushInbound(std::move(ask))) std::this_thread::yield();
+            }
+            DispatchMsg sweep;
+            sweep.type   = MsgType::NEW_ORDER;
+            sweep.symbol = "SWEEP";
+            sweep.side   = Side::BUY;
+            sweep.price  = 200.0;
+            sweep.qty    = LEVELS;
+            while (!eng.pushInbound(std::move(sweep))) std::this_thread::yield();
+            ++rounds;
+        }
+    });
+
+    auto t0 = steady_clock::now();
+    std::this_thread::sleep_for(seconds(TEST_SEC));
+    running.store(false);
+    producer.join();
+
+    uint64_t expected = rounds * (LEVELS + LEVELS + 1);
+    auto deadline = steady_clock::now() + seconds(5);
+    while (delivered.load() < expected && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    double sec = duration<double>(steady_clock::now() - t0).count();
+
+    dispatcher.stopDispatcher();
+    eng.stopEngine();
+
+    uint64_t msgs  = delivered.load();
+    uint64_t notes = dispatcher.notifications();
+
+    std::cout << "[Rounds          ] = " << rounds << "\n";
+    std::cout << "[Reports         ] = " << msgs << " / " << expected << "\n";
+    std::cout << "[Reports/sec     ] = " << (msgs / sec) << "\n";
+    std::cout << "[Notifications   ] = " << notes << "\n";
+    std::cout << "[Reports/notify  ] = " << (notes ? double(msgs) / notes : 0.0) << "\n";
+    std::cout << "[Inbound/notify  ] = "
+              << (notes ? double(rounds * (LEVELS + 1)) / notes : 0.0) << "\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/clock.h"
+#include "utils/placement.h"
+
+using namespace std::chrono;
+using namespace utils;
+
+struct Jitter {
+    uint64_t p50, p99, p9999, max;
+    uint64_t over10us;
+    uint64_t migrations;
+};
+
+// A hot loop like the matching thread's: read the clock, note the gap since
+// the previous read. Gaps are time the thread was not running its loop,
+// preempted or moved to another core.
+static Jitter measureLoop(double seconds) {
+    const uint64_t end = Clock::now() + Clock::fromNanos(static_cast<int64_t>(seconds * 1e9));
+    std::vector<uint64_t> gaps;
+    gaps.reserve(1 << 24);
+    uint64_t migrations = 0;
+    int lastCpu = ::sched_getcpu();
+    uint64_t prev = Clock::now();
+    uint64_t iter = 0;
+    while (prev < end) {
+        uint64_t now = Clock::now();
+        if (gaps.size() < gaps.capacity()) gaps.push_back(now - prev);
+        prev = now;
+        if ((++iter & 1023) == 0) {
+            int cpu = ::sched_getcpu();
+            migrations += cpu != lastCpu;
+            lastCpu = cpu;
+        }
+    }
+    std::sort(gaps.begin(), gaps.end());
+    auto ns = [](uint64_t ticks) { return static_cast<uint64_t>(Clock::toNanos(ticks)); };
+    uint64_t over = static_cast<uint64_t>(gaps.end() - std::upper_bound(gaps.begin(), gaps.end(),
+                                                                        Clock::fromNanos(10000)));
+    return {ns(gaps[gaps.size() / 2]), ns(gaps[gaps.size() * 99 / 100]),
+            ns(gaps[gaps.size() * 9999 / 10000]), ns(gaps.back()), over, migrations};
+}
+
+// Background load: threads that burn cpu in short bursts, like reactor and
+// pool workers under traffic.
+static Jitter run(bool placed, size_t noiseThreads, double seconds) {
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> noise;
+    for (size_t i = 0; i < noiseThreads; ++i) {
+        noise.emplace_back([&, i] {
+            if (placed) Placement::placeThread("pool", i);
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto until = steady_clock::now() + microseconds(200);
+                while (steady_clock::now() < until) {}
+                std::this_thread::sleep_for(microseconds(50));
+            }
+        });
+    }
+
+    Jitter j{};
+    std::thread engine([&] {
+        if (placed) Placement::placeThread("engine");
+        j = measureLoop(seconds);
+    });
+    engine.join();
+    stop = true;
+    for (auto& t : noise) t.join();
+    return j;
+}
+
+int main(int argc, char** argv) {
+    // perf_placement [seconds per run]
+    const double SECONDS = argc > 1 ? std::max(0.5, std::atof(argv[1])) : 3.0;
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    Clock::init();
+
+    // The engine gets the last core; the noise shares the rest, or the same
+    // core when there is only one.
+    int engineCpu = static_cast<int>(cores) - 1;
+    std::string spec = "engine=" + std::to_string(engineCpu) +
+                       ",pool=" + (cores > 1 ? "0-" + std::to_string(engineCpu - 1) : std::string("0"));
+    Placement::configure(spec);
+    size_t noiseThreads = cores;
+
+    std::cout << "=== Placement Jitter Benchmark (" << cores << " cores, " << noiseThreads
+              << " noise threads, " << SECONDS << "s per run, " << spec << ") ===" << std::endl;
+
+    for (bool placed : {false, true}) {
+        Jitter j = run(placed, noiseThreads, SECONDS);
+        std::cout << (placed ? "[pinned]   " : "[unpinned] ") << "gap p50=" << j.p50 << "ns p99=" << j.p99
+                  << "ns p99.99=" << j.p9999 << "ns max=" << j.max << "ns >10us=" << j.over10us
+                  << " migrations=" << j.migrations << std::endl;
+    }
+    std::cout << "[Benchmark] Placement Jitter Benchmark Finished." << std::endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "net/shm_client.h"
+#include "net/shm_gateway.h"
+#include "net/tcp_server_group.h"
+#include "dispatch/dispatcher.h"
+#include "engine/engine_router.h"
+#include "engine/matching_engine.h"
+#include "utils/binary_protocol.h"
+
+using namespace std::chrono;
+using namespace net;
+using namespace dispatch;
+using namespace engine;
+using namespace utils;
+using namespace core;
+
+// Order-to-ACK round trip, one order in flight, through the shared-memory
+// gateway and through TCP loopback with the binary protocol. Orders
+// alternate buy/sell at one price so the book stays empty.
+static DispatchMsg makeOrder(uint64_t i) {
+    DispatchMsg m;
+    m.type   = MsgType::NEW_ORDER;
+    m.symbol = "AAPL";
+    m.side   = (i & 1) ? Side::SELL : Side::BUY;
+    m.price  = 100.01;
+    m.qty    = 1;
+    return m;
+}
+
+static void printStats(const char* name, std::vector<uint64_t>& ns) {
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p) { return ns[std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()))]; };
+    std::cout << "[" << name << "] p50=" << pct(0.50) << "ns p99=" << pct(0.99)
+              << "ns p99.9=" << pct(0.999) << "ns max=" << ns.back() << "ns\n";
+}
+
+static std::vector<uint64_t> runShm(const std::string& name, int rounds) {
+    std::vector<uint64_t> samples;
+    ShmClient client;
+    if (!client.attach(name)) {
+        std::cerr << "[shm] attach failed\n";
+        return samples;
+    }
+    samples.reserve(rounds);
+    DispatchMsg report;
+    for (int i = 0; i < rounds; ++i) {
+        auto t0 = steady_clock::now();
+        while (!client.submit(makeOrder(i))) std::this_thread::yield();
+        // Yield rather than spin so the gateway threads get the core on
+        // hosts with fewer cores than busy threads.
+        while (!(client.poll(report) && report.type == MsgType::ACK)) std::this_thread::yield();
+        samples.push_back(duration_cast<nanoseconds>(steady_clock::now() - t0).count());
+    }
+    return samples;
+}
+
+static std::vector<uint64_t> runTcp(int port, int rounds) {
+    std::vector<uint64_t> samples;
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "[tcp] connect failed\n";
+        ::close(fd);
+        return samples;
+    }
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    samples.reserve(rounds);
+    std::string pending;
+    char buf[4096];
+    for (int i = 0; i < rounds; ++i) {
+        char frame[BIN_MAX_FRAME];
+        size_t len = encodeBinaryOrder(makeOrder(i), frame, sizeof(frame));
+        auto t0 = steady_clock::now();
+        ::send(fd, frame, len, 0);
+        bool acked = false;
+        while (!acked) {
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                std::cerr << "[tcp] connection lost\n";
+                ::close(fd);
+                return samples;
+            }
+            pending.append(buf, static_cast<size_t>(n));
+            int flen;
+            while ((flen = binFrameLength(pending.data(), pending.size())) > 0) {
+                acked |= static_cast<BinTemplate>(pending[1]) == BinTemplate::ACK;
+                pending.erase(0, static_cast<size_t>(flen));
+            }
+        }
+        samples.push_back(duration_cast<nanoseconds>(steady_clock::now() - t0).count());
+    }
+    ::close(fd);
+    return samples;
+}
+
+int main(int argc, char** argv) {
+    // perf_shm_rtt [rounds]
+    const int ROUNDS = argc > 1 ? std::max(1000, std::atoi(argv[1])) : 20000;
+    const int WARMUP = 1000;
+    const int PORT   = 9001;
+    const std::string SHM_NAME = "/orderbook_perf_rtt";
+
+    std::cout << "=== Order Entry RTT Benchmark (" << ROUNDS << " rounds) ===" << std::endl;
+
+    auto* engine = new MatchingEngine();
+    engine->registerSymbol("AAPL", 100000);
+    EngineRouter::instance().bindSymbolToEngine("AAPL", engine);
+    engine->startEngine();
+
+    Dispatcher dispatcher(1024);
+    TcpServerGroup servers(dispatcher, "127.0.0.1", PORT, 1, 1);
+    ShmGateway shm(dispatcher, SHM_NAME);
+    dispatcher.setSender([&](SessionId session, const std::string& payload) {
+        if (isShmSession(session)) return shm.queueSend(session, payload);
+        return servers.queueSend(session, payload);
+    });
+    dispatcher.setFlusher([&] { servers.flushPending(); });
+    dispatcher.attachEngine(engine);
+    dispatcher.startDispatcher();
+    servers.startGroup();
+    shm.startGateway();
+
+    runShm(SHM_NAME, WARMUP);
+    auto shmNs = runShm(SHM_NAME, ROUNDS);
+    runTcp(PORT, WARMUP);
+    auto tcpNs = runTcp(PORT, ROUNDS);
+
+    std::cout << "\n===== Order Entry RTT Results =====\n";
+    if (!shmNs.empty()) printStats("shm", shmNs);
+    if (!tcpNs.empty()) printStats("tcp", tcpNs);
+    std::cout << "[Benchmark] Order Entry RTT Benchmark Finished." << std::endl;
+
+    shm.stopGateway();
+    ::_exit(0);
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "utils/thread_pool.h"
+
+using namespace std::chrono;
+using namespace utils;
+
+// The pool this one replaced: a mutex, a condition variable and a queue of
+// std::function per worker, round-robin submit, no stealing.
+class MutexPool {
+public:
+    explicit MutexPool(size_t n) : queues_(n) {
+        for (size_t i = 0; i < n; ++i) threads_.emplace_back([this, i] { run(queues_[i]); });
+    }
+    ~MutexPool() {
+        running_ = false;
+        for (auto& q : queues_) {
+            std::lock_guard<std::mutex> lock(q.mtx);
+            q.cv.notify_all();
+        }
+        for (auto& t : threads_) t.join();
+    }
+    template<typename F>
+    bool submitTask(F&& fn) {
+        Queue& q = queues_[next_++ % queues_.size()];
+        {
+            std::lock_guard<std::mutex> lock(q.mtx);
+            q.tasks.emplace(std::forward<F>(fn));
+        }
+        q.cv.notify_one();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::queue<std::function<void()>> tasks;
+    };
+    void run(Queue& q) {
+        while (true) {
+            std::function<void()> fn;
+            {
+                std::unique_lock<std::mutex> lock(q.mtx);
+                q.cv.wait(lock, [&] { return !running_ || !q.tasks.empty(); });
+                if (q.tasks.empty()) return;
+                fn = std::move(q.tasks.front());
+                q.tasks.pop();
+            }
+            fn();
+        }
+    }
+    std::vector<Queue> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{true};
+    size_t next_ = 0;
+};
+
+struct Result {
+    double tasksPerSec;
+    uint64_t p50;
+    uint64_t p99;
+};
+
+// Throughput: one producer floods the pool with tiny tasks. Latency: one
+// task at a time, timed from submit to the moment it starts running.
+template<typename Pool>
+static Result measure(Pool& pool, int floodTasks, int pingTasks) {
+    std::atomic<int> done{0};
+    auto t0 = steady_clock::now();
+    for (int i = 0; i < floodTasks; ++i) {
+        pool.submitTask([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+    }
+    while (done.load(std::memory_order_relaxed) < floodTasks) std::this_thread::yield();
+    double secs = duration<double>(steady_clock::now() - t0).count();
+
+    std::vector<uint64_t> lat;
+    lat.reserve(pingTasks);
+    for (int i = 0; i < pingTasks; ++i) {
+        std::atomic<bool> ran{false};
+        auto submitted = steady_clock::now();
+        pool.submitTask([&] {
+            lat.push_back(duration_cast<nanoseconds>(steady_clock::now() - submitted).count());
+            ran.store(true, std::memory_order_release);
+        });
+        while (!ran.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    std::sort(lat.begin(), lat.end());
+    return {floodTasks / secs, lat[lat.size() / 2], lat[lat.size() * 99 / 100]};
+}
+
+int main(int argc, char** argv) {
+    // perf_thread_pool [flood tasks]
+    const int FLOOD = argc > 1 ? std::max(1000, std::atoi(argv[1])) : 200000;
+    const int PING  = 2000;
+    const size_t THREADS[] = {1, 2, 4, 8, 16, 32, 64};
+
+    std::cout << "=== ThreadPool Benchmark (" << FLOOD << " tasks, "
+              << std::thread::hardware_concurrency() << " cores) ===" << std::endl;
+
+    for (size_t n : THREADS) {
+        Result steal, mutex;
+        {
+            ThreadPool pool(n);
+            pool.startWorkers();
+            steal = measure(pool, FLOOD, PING);
+        }
+        {
+            MutexPool pool(n);
+            mutex = measure(pool, FLOOD, PING);
+        }
+        std::cout << "[threads=" << n << "] stealing: " << static_cast<uint64_t>(steal.tasksPerSec)
+                  << " tasks/s p50=" << steal.p50 << "ns p99=" << steal.p99 << "ns | mutex: "
+                  << static_cast<uint64_t>(mutex.tasksPerSec) << " tasks/s p50=" << mutex.p50
+                  << "ns p99=" << mutex.p99 << "ns" << std::endl;
+    }
+    std::cout << "[Benchmark] ThreadPool Benchmark Finished." << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "engine/matching_engine.h"
+#include "dispatch/dispatch_msg.h"
+#include "utils/placement.h"
+
+using namespace std::chrono;
+using namespace dispatch;
+using namespace core;
+
+static DispatchMsg makeOrder(int i, const char* symbol) {
+    // A resting sell, then a buy that takes it, at a drifting price so new
+    // levels keep appearing.
+    DispatchMsg m;
+    m.type = MsgType::NEW_ORDER;
+    m.symbol = symbol;
+    m.side = (i % 2 == 0) ? Side::SELL : Side::BUY;
+    m.price = 100.0 + (i / 2) % 512;
+    m.qty = 1;
+    return m;
+}
+
+// Runs in a fresh process so nothing from another scenario is warm.
+static void firstOrders(bool warm, int orders) {
+    if (warm && !utils::lockMemory()) std::cout << "  (mlockall failed, continuing unlocked)" << std::endl;
+
+    engine::MatchingEngine eng(orders * 2, orders * 4);
+    eng.registerSymbol("AAPL");
+    if (warm) eng.setWarmup(10000);
+    auto t0 = steady_clock::now();
+    eng.startEngine();
+    double startMs = duration<double, std::milli>(steady_clock::now() - t0).count();
+
+    for (int i = 0; i < orders; ++i) {
+        while (!eng.pushInbound(makeOrder(i, "AAPL"))) std::this_thread::yield();
+        // Outbound reports are not the subject here; keep the queue small.
+        DispatchMsg out;
+        while (eng.popOutbound(out)) {}
+    }
+    while (eng.inboundProcessed_.load() < static_cast<uint64_t>(orders)) std::this_thread::yield();
+    eng.stopEngine();
+
+    std::vector<uint64_t> lat = eng.collectLatency();
+    auto mean = [&](size_t from, size_t n) {
+        uint64_t sum = 0;
+        for (size_t i = from; i < from + n; ++i) sum += lat[i];
+        return sum / n;
+    };
+    // In arrival order: the very first orders against the steady state.
+    uint64_t first100 = mean(0, 100), last1000 = mean(lat.size() - 1000, 1000);
+    std::sort(lat.begin(), lat.end());
+    auto q = [&](double p) { return lat[std::min(lat.size() - 1, static_cast<size_t>(lat.size() * p))]; };
+    std::cout << (warm ? "[warm] " : "[cold] ") << "start=" << startMs << "ms first " << lat.size()
+              << " orders: p50=" << q(0.5) << "ns p99=" << q(0.99) << "ns p99.9=" << q(0.999)
+              << "ns max=" << lat.back() << "ns | mean first 100=" << first100
+              << "ns last 1000=" << last1000 << "ns" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    // perf_warmup [orders]
+    const int ORDERS = argc > 1 ? std::max(1000, std::atoi(argv[1])) : 10000;
+    std::cout << "=== Startup Warm-up Benchmark (first " << ORDERS << " orders) ===" << std::endl;
+
+    for (bool warm : {false, true}) {
+        std::cout.flush();
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            firstOrders(warm, ORDERS);
+            std::cout.flush();
+            std::_Exit(0);
+        }
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+    }
+    std::cout << "[Benchmark] Startup Warm-up Benchmark Finished." << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "utils/binary_protocol.h"
+#include <string>
+
+using namespace dispatch;
+using namespace utils;
+
+TEST(BinaryProtocolTest, OrderRoundTrip) {
+    DispatchMsg in;
+    in.type    = MsgType::MODIFY_ORDER;
+    in.symbol  = "MAOTAI";
+    in.side    = core::Side::SELL;
+    in.price   = 1799.25;
+    in.qty     = 300;
+    in.orderId = 123456789;
+
+    char buf[BIN_MAX_FRAME];
+    size_t n = encodeBinaryOrder(in, buf, sizeof(buf));
+    ASSERT_EQ(n, sizeof(BinModifyOrder));
+    ASSERT_EQ(binFrameLength(buf, n), static_cast<int>(n));
+
+    DispatchMsg out;
+    ASSERT_TRUE(decodeBinaryOrder(buf, n, out));
+    EXPECT_EQ(out.protocol, WireProtocol::BINARY);
+    EXPECT_EQ(out.type, in.type);
+    EXPECT_EQ(out.symbol, in.symbol);
+    EXPECT_EQ(out.side, in.side);
+    EXPECT_EQ(out.price, in.price);
+    EXPECT_EQ(out.qty, in.qty);
+    EXPECT_EQ(out.orderId, in.orderId);
+}
+
+TEST(BinaryProtocolTest, ReportRoundTrip) {
+    DispatchMsg trade;
+    trade.type    = MsgType::TRADE_REPORT;
+    trade.symbol  = "ICBC";
+    trade.price   = 5.12;
+    trade.qty     = 7;
+    trade.makerId = 11;
+    trade.takerId = 12;
+
+    std::string buf;
+    ASSERT_EQ(encodeBinaryReport(trade, buf), sizeof(BinTradeReport));
+    DispatchMsg back;
+    ASSERT_TRUE(decodeBinaryReport(buf.data(), buf.size(), back));
+    EXPECT_EQ(back.type, MsgType::TRADE_REPORT);
+    EXPECT_EQ(back.symbol, "ICBC");
+    EXPECT_EQ(back.price, 5.12);
+    EXPECT_EQ(back.qty, 7u);
+    EXPECT_EQ(back.makerId, 11u);
+    EXPECT_EQ(back.takerId, 12u);
+
+    DispatchMsg cancel;
+    cancel.type    = MsgType::CANCEL_REPORT;
+    cancel.symbol  = "ICBC";
+    cancel.orderId = 99;
+    cancel.status  = "NOT_FOUND";
+    ASSERT_EQ(encodeBinaryReport(cancel, buf), sizeof(BinStatusReport));
+    ASSERT_TRUE(decodeBinaryReport(buf.data(), buf.size(), back));
+    EXPECT_EQ(back.type, MsgType::CANCEL_REPORT);
+    EXPECT_EQ(back.orderId, 99u);
+    EXPECT_EQ(back.status, "NOT_FOUND");
+
+    cancel.symbol = "SYMBOL_LONGER_THAN_16";
+    EXPECT_EQ(encodeBinaryReport(cancel, buf), 0u);
+}
+
+TEST(BinaryProtocolTest, RejectsMalformedFrames) {
+    char junk[] = "{\"type\":\"NEW_ORDER\"}";
+    EXPECT_EQ(binFrameLength(junk, sizeof(junk) - 1), -1);
+
+    BinHeader hdr{BIN_MAGIC, static_cast<uint8_t>(BinTemplate::NEW_ORDER), 2};
+    EXPECT_EQ(binFrameLength(reinterpret_cast<const char*>(&hdr), sizeof(hdr)), -1);
+
+    DispatchMsg order;
+    order.type = MsgType::NEW_ORDER;
+    order.symbol = "A";
+    char buf[64];
+    size_t n = encodeBinaryOrder(order, buf, sizeof(buf));
+    DispatchMsg out;
+    EXPECT_FALSE(decodeBinaryOrder(buf, n - 1, out));
+    buf[1] = 77;
+    EXPECT_FALSE(decodeBinaryOrder(buf, n, out));
+}
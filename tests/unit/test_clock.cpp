@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "utils/clock.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace utils;
+using namespace std::chrono;
+
+static int64_t systemNs() {
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+TEST(ClockTest, RealtimeTracksSystemClock) {
+    Clock::init();
+    int64_t before = systemNs();
+    int64_t ours = Clock::wallNs();
+    int64_t after = systemNs();
+    // Calibration error plus scheduling noise; well under a millisecond on
+    // an idle host.
+    EXPECT_GT(ours, before - 1000000);
+    EXPECT_LT(ours, after + 1000000);
+}
+
+TEST(ClockTest, IntervalsMatchSteadyClock) {
+    auto s0 = steady_clock::now();
+    uint64_t t0 = Clock::now();
+    std::this_thread::sleep_for(milliseconds(20));
+    uint64_t t1 = Clock::nowOrdered();
+    auto s1 = steady_clock::now();
+
+    int64_t expected = duration_cast<nanoseconds>(s1 - s0).count();
+    EXPECT_LT(std::llabs(Clock::toNanos(t1 - t0) - expected), expected / 20);
+    EXPECT_NEAR(static_cast<double>(Clock::fromNanos(Clock::toNanos(t1 - t0))),
+                static_cast<double>(t1 - t0), 0.001 * (t1 - t0));
+}
+
+TEST(ClockTest, RecalibrationKeepsReadingsInPlace) {
+    uint64_t t = Clock::now();
+    int64_t mono = Clock::monotonicNs(t);
+    std::this_thread::sleep_for(milliseconds(5));
+    Clock::recalibrate();
+    // The same tick reading maps to (almost) the same instant afterwards,
+    // and later readings never map earlier.
+    EXPECT_LT(std::llabs(Clock::monotonicNs(t) - mono), 100000);
+    EXPECT_GE(Clock::monotonicNs(Clock::now()), Clock::monotonicNs(t));
+}
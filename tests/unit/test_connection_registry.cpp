@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "net/connection_registry.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace net;
+using namespace utils;
+
+TEST(ConnectionRegistryTest, StaleSessionMissesReusedSlot) {
+    ConnectionRegistry reg(4);
+    auto a = std::make_shared<TcpConnection>(-1);
+    SessionId ida = reg.add(a);
+    ASSERT_NE(ida, dispatch::INVALID_SESSION);
+    {
+        Rcu::ReadGuard guard;
+        EXPECT_EQ(reg.lookup(ida), a.get());
+    }
+
+    ASSERT_TRUE(reg.remove(ida));
+    EXPECT_FALSE(reg.remove(ida));
+
+    // Same slot, next generation.
+    auto b = std::make_shared<TcpConnection>(-1);
+    SessionId idb = reg.add(b);
+    EXPECT_EQ(static_cast<uint32_t>(idb), static_cast<uint32_t>(ida));
+    EXPECT_NE(idb, ida);
+
+    Rcu::ReadGuard guard;
+    EXPECT_EQ(reg.lookup(ida), nullptr);
+    EXPECT_EQ(reg.lookup(idb), b.get());
+}
+
+TEST(ConnectionRegistryTest, DisjointRangesAndCapacity) {
+    ConnectionRegistry first(2, 0), second(2, 2);
+    SessionId a = first.add(std::make_shared<TcpConnection>(-1));
+    SessionId b = first.add(std::make_shared<TcpConnection>(-1));
+    EXPECT_EQ(first.add(std::make_shared<TcpConnection>(-1)), dispatch::INVALID_SESSION);
+    SessionId c = second.add(std::make_shared<TcpConnection>(-1));
+
+    Rcu::ReadGuard guard;
+    EXPECT_NE(first.lookup(a), nullptr);
+    EXPECT_NE(first.lookup(b), nullptr);
+    EXPECT_EQ(first.lookup(c), nullptr);
+    EXPECT_NE(second.lookup(c), nullptr);
+    EXPECT_EQ(second.lookup(a), nullptr);
+}
+
+TEST(ConnectionRegistryTest, RemovedConnectionOutlivesReaders) {
+    ConnectionRegistry reg(4);
+    auto conn = std::make_shared<TcpConnection>(-1);
+    std::weak_ptr<TcpConnection> watch = conn;
+    SessionId id = reg.add(std::move(conn));
+
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        Rcu::ReadGuard guard;
+        TcpConnection* c = reg.lookup(id);
+        stage.store(1);
+        while (stage.load() != 2) std::this_thread::yield();
+        // Still safe to use after remove(): the grace period is pending.
+        EXPECT_EQ(c->sessionId(), dispatch::INVALID_SESSION);
+    });
+    while (stage.load() != 1) std::this_thread::yield();
+
+    ASSERT_TRUE(reg.remove(id));
+    reg.reclaim();
+    EXPECT_FALSE(watch.expired());
+    EXPECT_EQ(reg.retiredCount(), 1u);
+
+    stage.store(2);
+    reader.join();
+    reg.reclaim();
+    EXPECT_TRUE(watch.expired());
+    EXPECT_EQ(reg.retiredCount(), 0u);
+}
+
+TEST(ConnectionRegistryTest, LookupsUnderChurn) {
+    ConnectionRegistry reg(64);
+    std::atomic<bool> stop{false};
+    std::vector<SessionId> ids(64, dispatch::INVALID_SESSION);
+    std::atomic<SessionId> published[64];
+    for (auto& p : published) p.store(dispatch::INVALID_SESSION);
+
+    std::thread reader([&] {
+        uint64_t hits = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            for (auto& p : published) {
+                SessionId id = p.load(std::memory_order_acquire);
+                Rcu::ReadGuard guard;
+                if (TcpConnection* c = reg.lookup(id)) {
+                    // A hit is always the connection the id was issued for.
+                    EXPECT_EQ(c->sessionId(), id);
+                    ++hits;
+                }
+            }
+        }
+        EXPECT_GT(hits, 0u);
+    });
+
+    for (int round = 0; round < 20000; ++round) {
+        size_t k = round % ids.size();
+        if (ids[k] != dispatch::INVALID_SESSION) {
+            ASSERT_TRUE(reg.remove(ids[k]));
+        }
+        auto conn = std::make_shared<TcpConnection>(-1);
+        TcpConnection* raw = conn.get();
+        ids[k] = reg.add(std::move(conn));
+        raw->setSessionId(ids[k]);
+        published[k].store(ids[k], std::memory_order_release);
+    }
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(reg.size(), ids.size());
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "engine/engine_router.h"
+#include "engine/matching_engine.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+
+using namespace engine;
+
+TEST(EngineRouterTest, RouteUnknownSymbol) {
+    EXPECT_EQ(EngineRouter::instance().route("ROUTER_UNKNOWN"), nullptr);
+}
+
+TEST(EngineRouterTest, RebindIsVisibleToCachedReaders) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    auto& router = EngineRouter::instance();
+
+    router.bindSymbolToEngine("ROUTER_REBIND", a.get());
+    EXPECT_EQ(router.route("ROUTER_REBIND"), a.get());
+    EXPECT_EQ(router.route("ROUTER_REBIND"), a.get());
+
+    router.bindSymbolToEngine("ROUTER_REBIND", b.get());
+    EXPECT_EQ(router.route("ROUTER_REBIND"), b.get());
+}
+
+TEST(EngineRouterTest, ConcurrentRouteDuringRebind) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    auto& router = EngineRouter::instance();
+    router.bindSymbolToEngine("ROUTER_CONC", a.get());
+
+    std::atomic<bool> running{true};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (running.load(std::memory_order_relaxed)) {
+                auto* e = router.route("ROUTER_CONC");
+                if (e != a.get() && e != b.get()) bad++;
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        router.bindSymbolToEngine("ROUTER_CONC", (i % 2) ? a.get() : b.get());
+        router.bindSymbolToEngine("ROUTER_OTHER_" + std::to_string(i % 8), a.get());
+    }
+    running = false;
+    for (auto& th : readers) th.join();
+
+    EXPECT_EQ(bad.load(), 0);
+    EXPECT_EQ(router.route("ROUTER_CONC"), a.get());
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "net/epoll_reactor.h"
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace net;
+
+namespace {
+
+struct SocketPair {
+    SocketPair() { ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds); }
+    ~SocketPair() { ::close(fds[0]); ::close(fds[1]); }
+    int fds[2] = {-1, -1};
+};
+
+}
+
+// Two fds are ready in the same batch. Whichever handler runs first drops
+// the other fd and registers a new handler under its number; the event
+// already fetched for the old registration must reach neither handler.
+TEST(EpollReactorTest, StaleEventSkipsReusedFd) {
+    EpollReactor reactor(16, 20);
+    SocketPair a, b;
+    ASSERT_EQ(::write(a.fds[1], "x", 1), 1);
+    ASSERT_EQ(::write(b.fds[1], "x", 1), 1);
+
+    int first = -1, stale = 0, replaced = 0;
+    auto handler = [&](int fd, uint32_t) {
+        if (first >= 0) { ++stale; return; }
+        first = fd;
+        int other = fd == a.fds[0] ? b.fds[0] : a.fds[0];
+        EXPECT_TRUE(reactor.unregisterEventHandler(other));
+        EXPECT_TRUE(reactor.registerEventHandler(other, EPOLLIN, [&](int, uint32_t) { ++replaced; }));
+        // The fd may even drop itself from inside its own handler.
+        EXPECT_TRUE(reactor.unregisterEventHandler(fd));
+        reactor.stopEventLoop();
+    };
+    ASSERT_TRUE(reactor.registerEventHandler(a.fds[0], EPOLLIN, handler));
+    ASSERT_TRUE(reactor.registerEventHandler(b.fds[0], EPOLLIN, handler));
+
+    reactor.runEventLoop();
+    EXPECT_GE(first, 0);
+    EXPECT_EQ(stale, 0);
+    EXPECT_EQ(replaced, 0);
+}
+
+TEST(EpollReactorTest, RejectsDuplicateRegistration) {
+    EpollReactor reactor(16, 20);
+    SocketPair sp;
+    ASSERT_TRUE(reactor.registerEventHandler(sp.fds[0], EPOLLIN, [](int, uint32_t) {}));
+    EXPECT_FALSE(reactor.registerEventHandler(sp.fds[0], EPOLLIN, [](int, uint32_t) {}));
+    EXPECT_TRUE(reactor.unregisterEventHandler(sp.fds[0]));
+    EXPECT_FALSE(reactor.unregisterEventHandler(sp.fds[0]));
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "net/io_uring_reactor.h"
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace net;
+
+namespace {
+
+struct SocketPair {
+    SocketPair() { ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds); }
+    ~SocketPair() { ::close(fds[0]); ::close(fds[1]); }
+    int fds[2] = {-1, -1};
+};
+
+class DataHandler final : public EventHandler {
+public:
+    using Func = std::function<size_t(const char* data, size_t len)>;
+    explicit DataHandler(Func fn) : fn_(std::move(fn)) {}
+    void handleEvent(int, uint32_t) override {}
+    size_t handleData(int, const char* data, size_t len) override { return fn_(data, len); }
+
+private:
+    Func fn_;
+};
+
+}
+
+TEST(IoUringReactorTest, ReadinessIsLevelTriggered) {
+    if (!IoUringReactor::supported()) GTEST_SKIP() << "io_uring unavailable";
+    IoUringReactor reactor(64, 20);
+    SocketPair sp;
+
+    // One byte per callback: the second byte must still raise an event.
+    int calls = 0;
+    ASSERT_TRUE(reactor.registerEventHandler(sp.fds[0], EPOLLIN, [&](int fd, uint32_t events) {
+        EXPECT_TRUE(events & EPOLLIN);
+        char c;
+        ASSERT_EQ(::read(fd, &c, 1), 1);
+        if (++calls == 2) reactor.stopEventLoop();
+    }));
+    ASSERT_EQ(::write(sp.fds[1], "ab", 2), 2);
+
+    std::thread loop([&] { reactor.runEventLoop(); });
+    loop.join();
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(IoUringReactorTest, MaskUpdateFromAnotherThreadWakesLoop) {
+    if (!IoUringReactor::supported()) GTEST_SKIP() << "io_uring unavailable";
+    IoUringReactor reactor(64);
+    SocketPair sp;
+
+    std::atomic<int> writable{0};
+    ASSERT_TRUE(reactor.registerEventHandler(sp.fds[0], EPOLLIN, [&](int fd, uint32_t events) {
+        if (events & EPOLLOUT) {
+            writable.fetch_add(1);
+            EXPECT_TRUE(reactor.unregisterEventHandler(fd));
+            reactor.stopEventLoop();
+        }
+    }));
+
+    // No timeout: only the eventfd wake lets the loop see the new mask.
+    std::thread loop([&] { reactor.runEventLoop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(reactor.updateEventMask(sp.fds[0], EPOLLIN | EPOLLOUT));
+    loop.join();
+    EXPECT_EQ(writable.load(), 1);
+    EXPECT_FALSE(reactor.unregisterEventHandler(sp.fds[0]));
+}
+
+TEST(IoUringReactorTest, ReceiverGetsBytesThenEndOfStream) {
+    if (!IoUringReactor::supported()) GTEST_SKIP() << "io_uring unavailable";
+    IoUringReactor reactor(64, 20);
+    if (!reactor.completesReads()) GTEST_SKIP() << "no multishot recv";
+    SocketPair sp;
+
+    std::string got;
+    bool ended = false;
+    ASSERT_TRUE(reactor.registerReceiver(sp.fds[0], EPOLLIN, std::make_unique<DataHandler>(
+        [&](const char* data, size_t len) {
+            if (len == 0) {
+                ended = true;
+                EXPECT_TRUE(reactor.unregisterEventHandler(sp.fds[0]));
+                reactor.stopEventLoop();
+            }
+            got.append(data ? data : "", len);
+            return len;
+        })));
+    ASSERT_EQ(::write(sp.fds[1], "hello ", 6), 6);
+    ASSERT_EQ(::write(sp.fds[1], "world", 5), 5);
+    ::shutdown(sp.fds[1], SHUT_WR);
+
+    std::thread loop([&] { reactor.runEventLoop(); });
+    loop.join();
+    EXPECT_TRUE(ended);
+    EXPECT_EQ(got, "hello world");
+}
+
+TEST(IoUringReactorTest, HeldBytesComeBackOnMaskUpdate) {
+    if (!IoUringReactor::supported()) GTEST_SKIP() << "io_uring unavailable";
+    IoUringReactor reactor(64, 20);
+    if (!reactor.completesReads()) GTEST_SKIP() << "no multishot recv";
+    SocketPair sp;
+
+    std::mutex mtx;
+    std::string got;
+    size_t budget = 3;
+    ASSERT_TRUE(reactor.registerReceiver(sp.fds[0], EPOLLIN, std::make_unique<DataHandler>(
+        [&](const char* data, size_t len) {
+            std::lock_guard<std::mutex> lock(mtx);
+            size_t n = std::min(len, budget);
+            budget -= n;
+            got.append(data, n);
+            if (got.size() == 10) reactor.stopEventLoop();
+            return n;
+        })));
+    ASSERT_EQ(::write(sp.fds[1], "abcdefgh", 8), 8);
+
+    std::thread loop([&] { reactor.runEventLoop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        EXPECT_EQ(got, "abc");
+        budget = 100;
+    }
+    // Same mask: only the update itself releases the held bytes.
+    EXPECT_TRUE(reactor.updateEventMask(sp.fds[0], EPOLLIN));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(::write(sp.fds[1], "ij", 2), 2);
+    loop.join();
+    EXPECT_EQ(got, "abcdefghij");
+}
+
+TEST(IoUringReactorTest, MultishotAcceptHandsOverEveryConnection) {
+    if (!IoUringReactor::supported()) GTEST_SKIP() << "io_uring unavailable";
+    IoUringReactor reactor(64, 20);
+    int listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    ASSERT_GE(listenFd, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::listen(listenFd, 16), 0);
+    socklen_t len = sizeof(addr);
+    ASSERT_EQ(::getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len), 0);
+
+    constexpr int CLIENTS = 3;
+    int accepted = 0;
+    ASSERT_TRUE(reactor.registerAcceptor(listenFd, [&](int connFd) {
+        ::close(connFd);
+        if (++accepted == CLIENTS) {
+            EXPECT_TRUE(reactor.unregisterEventHandler(listenFd));
+            reactor.stopEventLoop();
+        }
+    }));
+
+    int clients[CLIENTS];
+    for (int& fd : clients) {
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    }
+    std::thread loop([&] { reactor.runEventLoop(); });
+    loop.join();
+    EXPECT_EQ(accepted, CLIENTS);
+    for (int fd : clients) ::close(fd);
+    ::close(listenFd);
+}
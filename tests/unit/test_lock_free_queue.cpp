@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
 #include <thread>
 #include <vector>
 #include <atomic>
@@ -47,3 +49,143 @@ TEST(LockFreeQueueTest, CircularReuse) {
     EXPECT_TRUE((results == std::vector<int>{2, 100, 200}));
 }
 
+
+TEST(LockFreeQueueTest, FailedPushLeavesNoHole) {
+    LockFreeQueue<int> q(4);
+    for (int i = 0; i < 4; ++i) q.push(i);
+    for (int i = 0; i < 3; ++i) EXPECT_FALSE(q.push(100 + i));
+
+    int x;
+    ASSERT_TRUE(q.pop(x));
+    EXPECT_EQ(x, 0);
+    EXPECT_TRUE(q.push(4));
+    for (int i = 1; i <= 4; ++i) {
+        ASSERT_TRUE(q.pop(x));
+        EXPECT_EQ(x, i);
+    }
+    EXPECT_FALSE(q.pop(x));
+}
+
+TEST(LockFreeQueueTest, ManyProducersManyConsumers) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+    LockFreeQueue<int> q(256);
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 1; i <= kPerProducer; ++i) {
+                while (!q.push(p * kPerProducer + i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+            int v;
+            while (popped.load() < kProducers * kPerProducer) {
+                if (q.pop(v)) {
+                    sum += v;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    long long n = kProducers * kPerProducer;
+    EXPECT_EQ(popped.load(), n);
+    EXPECT_EQ(sum.load(), n * (n + 1) / 2);
+}
+
+TEST(SpscQueueTest, BatchesWrapAndStopAtCapacity) {
+    SpscQueue<int> q(8);
+    int in[10], out[10];
+    for (int i = 0; i < 10; ++i) in[i] = i;
+
+    EXPECT_EQ(q.pushBatch(in, 5), 5u);
+    EXPECT_EQ(q.popBatch(out, 3), 3u);
+    EXPECT_EQ(q.pushBatch(in + 5, 5), 5u);
+    EXPECT_EQ(q.pushBatch(in, 10), 1u);
+    EXPECT_EQ(q.size(), 8u);
+
+    EXPECT_EQ(q.popBatch(out, 10), 8u);
+    for (int i = 0; i < 7; ++i) EXPECT_EQ(out[i], i + 3);
+    EXPECT_EQ(out[7], 0);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(SpscQueueTest, ProducerAndConsumerThreadsKeepOrder) {
+    constexpr int kItems = 100000;
+    SpscQueue<int> q(64);
+    std::thread producer([&] {
+        for (int i = 0; i < kItems; ++i) {
+            while (!q.push(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    int buf[16];
+    while (expected < kItems) {
+        size_t n = q.popBatch(buf, 16);
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(buf[i], expected++);
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+}
+
+TEST(MpscQueueTest, BatchProducersDeliverEveryItemInProducerOrder) {
+    constexpr int kProducers = 3;
+    constexpr int kPerProducer = 30000;
+    MpscQueue<int> q(128);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            int batch[7];
+            for (int i = 0; i < kPerProducer;) {
+                int n = std::min(7, kPerProducer - i);
+                for (int j = 0; j < n; ++j) batch[j] = p * kPerProducer + i + j;
+                size_t sent = q.pushBatch(batch, n);
+                // Single pushes share the ring with batch pushes.
+                if (sent == 0 && q.push(batch[0])) sent = 1;
+                i += static_cast<int>(sent);
+                if (sent == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> last(kProducers, -1);
+    int received = 0;
+    int mismatches = 0;
+    int buf[32];
+    while (received < kProducers * kPerProducer) {
+        size_t n = q.popBatch(buf, 32);
+        for (size_t i = 0; i < n; ++i) {
+            int p = buf[i] / kPerProducer;
+            if (buf[i] % kPerProducer != last[p] + 1) mismatches++;
+            last[p] = buf[i] % kPerProducer;
+        }
+        received += static_cast<int>(n);
+        if (n == 0) std::this_thread::yield();
+    }
+    for (auto& t : producers) t.join();
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_TRUE(q.empty());
+}
+
+TEST(MpscQueueTest, PopWaitTimesOutThenSeesLatePush) {
+    MpscQueue<int> q(4);
+    int v = 0;
+    EXPECT_FALSE(q.popWait(v, std::chrono::milliseconds(5)));
+
+    std::thread late([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        q.push(42);
+    });
+    EXPECT_TRUE(q.popWait(v, std::chrono::seconds(5)));
+    EXPECT_EQ(v, 42);
+    late.join();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "utils/logger.h"
+#include <signal.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace utils;
+
+namespace {
+
+// Runs fn with the logger writing to a scratch file and returns the file.
+template<typename Fn>
+std::string captureLog(const char* tag, Fn fn) {
+    std::string path = "/tmp/ob_logger_" + std::string(tag) + "_" + std::to_string(::getpid()) + ".log";
+    std::remove(path.c_str());
+    Logger::instance().setLogFile(path);
+    fn();
+    Logger::instance().flush();
+    Logger::instance().disableFileLogging();
+
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::remove(path.c_str());
+    return ss.str();
+}
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+}
+
+TEST(LoggerTest, FormatsDeferredArguments) {
+    std::string symbol = "XPEV";
+    auto text = captureLog("fmt", [&] {
+        Logger::instance().log(LogLevel::INFO, "[LoggerTest] {} n={} d={} px={} ok={} c={}",
+                               symbol, 42u, -7, 100.25, true, 'x');
+        Logger::instance().log(LogLevel::WARN, std::string("[LoggerTest] prebuilt ") + symbol);
+        Logger::instance().log(LogLevel::ERROR, "[LoggerTest] missing {} {}", 1);
+    });
+    EXPECT_NE(text.find("[INFO] [LoggerTest] XPEV n=42 d=-7 px=100.25 ok=true c=x\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("[WARN] [LoggerTest] prebuilt XPEV\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("[ERROR] [LoggerTest] missing 1 {}\n"), std::string::npos) << text;
+}
+
+TEST(LoggerTest, FileKeepsErrorLinesInOrder) {
+    auto text = captureLog("order", [] {
+        Logger::instance().log(LogLevel::INFO, "[LoggerTest] first");
+        Logger::instance().log(LogLevel::ERROR, "[LoggerTest] second");
+        Logger::instance().log(LogLevel::INFO, "[LoggerTest] third");
+    });
+    size_t first = text.find("[LoggerTest] first");
+    size_t second = text.find("[LoggerTest] second");
+    size_t third = text.find("[LoggerTest] third");
+    ASSERT_NE(third, std::string::npos) << text;
+    EXPECT_LT(first, second) << text;
+    EXPECT_LT(second, third) << text;
+}
+
+TEST(LoggerTest, CharPointersAreCopiedAsStrings) {
+    bool buy = false;
+    const char* none = nullptr;
+    char name[] = "NIO";
+    auto text = captureLog("cstr", [&] {
+        Logger::instance().log(LogLevel::INFO, "[LoggerTest] {} side={} lit={} none={}",
+                               name, buy ? "BUY" : "SELL", "abc", none);
+        name[0] = 'X';
+    });
+    EXPECT_NE(text.find("[LoggerTest] NIO side=SELL lit=abc none=(null)\n"), std::string::npos) << text;
+}
+
+TEST(LoggerTest, ThreadsLogThroughTheirOwnRings) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    uint64_t droppedBefore = Logger::instance().droppedMessages();
+
+    auto text = captureLog("mt", [&] {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    Logger::instance().log(LogLevel::INFO, "[LoggerTest] thread={} seq={}", t, i);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+    });
+
+    EXPECT_EQ(countOf(text, "[LoggerTest] thread="), static_cast<size_t>(kThreads * kPerThread));
+    EXPECT_EQ(Logger::instance().droppedMessages(), droppedBefore);
+    // Each thread's records come out in the order it wrote them.
+    for (int t = 0; t < kThreads; ++t) {
+        std::string prefix = "thread=" + std::to_string(t) + " seq=";
+        size_t last = 0;
+        for (int i = 0; i < kPerThread; i += 499) {
+            size_t pos = text.find(prefix + std::to_string(i) + "\n");
+            ASSERT_NE(pos, std::string::npos);
+            EXPECT_GE(pos, last);
+            last = pos;
+        }
+    }
+}
+
+TEST(LoggerTest, LevelSpecSetsComponentsIndependently) {
+    ASSERT_TRUE(Logger::setLevels("all=info"));
+    ASSERT_TRUE(Logger::setLevels("engine=warn, NET=off  # quiet the gateway\ncore=1"));
+    EXPECT_FALSE(logEnabled(LogComponent::ENGINE, LogLevel::INFO));
+    EXPECT_TRUE(logEnabled(LogComponent::ENGINE, LogLevel::WARN));
+    EXPECT_FALSE(logEnabled(LogComponent::NET, LogLevel::ERROR));
+    EXPECT_EQ(Logger::level(LogComponent::CORE), LogLevel::ERROR);
+    EXPECT_TRUE(logEnabled(LogComponent::DISPATCH, LogLevel::INFO));
+
+    // A bad entry leaves every level as it was.
+    EXPECT_FALSE(Logger::setLevels("dispatch=off engine=loud"));
+    EXPECT_FALSE(Logger::setLevels("gateway=info"));
+    EXPECT_EQ(Logger::level(LogComponent::DISPATCH), LogLevel::INFO);
+    EXPECT_EQ(Logger::level(LogComponent::ENGINE), LogLevel::WARN);
+
+    ASSERT_TRUE(Logger::setLevels("all=info"));
+}
+
+TEST(LoggerTest, SighupReloadsLevelFile) {
+    std::string path = "/tmp/ob_log_levels_" + std::to_string(::getpid());
+    std::ofstream(path) << "all=info\n";
+    ASSERT_TRUE(Logger::instance().watchLevelFile(path));
+    EXPECT_EQ(Logger::level(LogComponent::ENGINE), LogLevel::INFO);
+
+    std::ofstream(path) << "engine=error\ndispatch=off\n";
+    ASSERT_EQ(::raise(SIGHUP), 0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (Logger::level(LogComponent::DISPATCH) != LogLevel::OFF &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(Logger::level(LogComponent::DISPATCH), LogLevel::OFF);
+    EXPECT_EQ(Logger::level(LogComponent::ENGINE), LogLevel::ERROR);
+
+    std::remove(path.c_str());
+    ASSERT_TRUE(Logger::setLevels("all=info"));
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include "engine/matching_engine.h"
 #include "dispatch/dispatch_msg.h"
+#include "dispatch/dispatcher.h"
 #include "core/order_book.h"
+#include <pthread.h>
+#include <algorithm>
+#include <limits>
 #include <thread>
 #include <atomic>
 #include <unordered_set>
@@ -31,7 +35,7 @@ TEST_F(MatchingEngineTest, BasicOrderFlow) {
     DispatchMsg msg;
     msg.type = MsgType::NEW_ORDER;
     msg.symbol = "XPEV";
-    msg.fd = 1;
+    msg.sessionId = 1;
     msg.side = Side::BUY;
     msg.price = 100.5;
     msg.qty = 10;
@@ -53,9 +57,43 @@ TEST_F(MatchingEngineTest, BasicOrderFlow) {
     EXPECT_FALSE(foundTrade);
 }
 
+TEST_F(MatchingEngineTest, ModifyIsCancelReplace) {
+    DispatchMsg rest = { .sessionId = 1, .type = MsgType::NEW_ORDER, .symbol = "BYD", .side = Side::SELL, .price = 101, .qty = 5 };
+    DispatchMsg modify = { .sessionId = 1, .type = MsgType::MODIFY_ORDER, .symbol = "BYD", .side = Side::SELL, .price = 100, .qty = 5, .orderId = 1 };
+    DispatchMsg take = { .sessionId = 2, .type = MsgType::NEW_ORDER, .symbol = "BYD", .side = Side::BUY, .price = 100, .qty = 5 };
+    DispatchMsg stale = { .sessionId = 1, .type = MsgType::MODIFY_ORDER, .symbol = "BYD", .side = Side::SELL, .price = 99, .qty = 5, .orderId = 1 };
+
+    ASSERT_TRUE(engine->pushInbound(std::move(rest)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(engine->pushInbound(std::move(modify)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(engine->pushInbound(std::move(take)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(engine->pushInbound(std::move(stale)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::vector<DispatchMsg> reports;
+    DispatchMsg out;
+    while (engine->popOutbound(out)) reports.push_back(out);
+
+    int cancelOk = 0, notFound = 0, trades = 0;
+    for (const auto& r : reports) {
+        if (r.type == MsgType::CANCEL_REPORT && r.status == "CANCEL_OK") ++cancelOk;
+        if (r.type == MsgType::CANCEL_REPORT && r.status == "NOT_FOUND") ++notFound;
+        if (r.type == MsgType::TRADE_REPORT) {
+            ++trades;
+            EXPECT_EQ(r.price, 100);
+            EXPECT_NE(r.makerId, 1u);
+        }
+    }
+    EXPECT_EQ(cancelOk, 1);
+    EXPECT_EQ(notFound, 1);
+    EXPECT_EQ(trades, 1);
+}
+
 TEST_F(MatchingEngineTest, MultiSymbolRouting) {
-    DispatchMsg xpev = { .fd = 1, .type = MsgType::NEW_ORDER, .symbol = "XPEV", .side = Side::BUY, .price = 100, .qty = 10 };
-    DispatchMsg byd = { .fd = 2, .type = MsgType::NEW_ORDER, .symbol = "BYD", .side = Side::SELL, .price = 200, .qty = 5 };
+    DispatchMsg xpev = { .sessionId = 1, .type = MsgType::NEW_ORDER, .symbol = "XPEV", .side = Side::BUY, .price = 100, .qty = 10 };
+    DispatchMsg byd = { .sessionId = 2, .type = MsgType::NEW_ORDER, .symbol = "BYD", .side = Side::SELL, .price = 200, .qty = 5 };
 
     EXPECT_TRUE(engine->pushInbound(std::move(xpev)));
     EXPECT_TRUE(engine->pushInbound(std::move(byd)));
@@ -85,7 +123,7 @@ TEST_F(MatchingEngineTest, MultiThreadedPushInboundSafety) {
                 DispatchMsg msg;
                 msg.type = MsgType::NEW_ORDER;
                 msg.symbol = "XPEV";
-                msg.fd = t;
+                msg.sessionId = t;
                 msg.side = Side::BUY;
                 msg.price = 100.0 + t;
                 msg.qty = 1;
@@ -109,3 +147,160 @@ TEST_F(MatchingEngineTest, StopEngineIsGraceful) {
     engine->stopEngine();
     EXPECT_TRUE(true);
 }
+
+TEST(MatchingEngineBackpressureTest, CongestsAtHighWatermarkAndRelievesAtLow) {
+    auto eng = std::make_unique<MatchingEngine>(64);
+    eng->registerSymbol("XPEV");
+    eng->setInboundWatermarks(8, 2);
+    std::atomic<int> reliefs{0};
+    eng->setInboundReliefCallback([&] { reliefs++; });
+
+    for (int i = 0; i < 10; ++i) {
+        DispatchMsg msg;
+        msg.type = MsgType::NEW_ORDER;
+        msg.symbol = "XPEV";
+        msg.sessionId = 1;
+        msg.side = Side::BUY;
+        msg.price = 100.0;
+        msg.qty = 1;
+        ASSERT_TRUE(eng->pushInbound(std::move(msg)));
+    }
+    EXPECT_TRUE(eng->inboundCongested());
+
+    eng->startEngine();
+    for (int i = 0; i < 200 && eng->inboundCongested(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_FALSE(eng->inboundCongested());
+    EXPECT_EQ(reliefs.load(), 1);
+    eng->stopEngine();
+}
+
+TEST(MatchingEngineBackpressureTest, DispatcherRunsReliefListenersOffTheEngineThread) {
+    auto eng = std::make_unique<MatchingEngine>(64);
+    eng->registerSymbol("XPEV");
+    eng->setInboundWatermarks(8, 2);
+    Dispatcher dispatcher;
+    dispatcher.attachEngine(eng.get());
+    std::atomic<bool> relieved{false};
+    char listenerThread[16] = {};
+    dispatcher.addReliefListener([&](MatchingEngine* relievedEngine) {
+        EXPECT_EQ(relievedEngine, eng.get());
+        ::pthread_getname_np(::pthread_self(), listenerThread, sizeof(listenerThread));
+        relieved = true;
+    });
+    dispatcher.startDispatcher();
+
+    for (int i = 0; i < 10; ++i) {
+        DispatchMsg msg;
+        msg.type = MsgType::NEW_ORDER;
+        msg.symbol = "XPEV";
+        msg.side = Side::BUY;
+        msg.price = 100.0;
+        msg.qty = 1;
+        ASSERT_TRUE(eng->pushInbound(std::move(msg)));
+    }
+    eng->startEngine();
+    for (int i = 0; i < 400 && !relieved; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(relieved);
+    EXPECT_EQ(std::string(listenerThread).rfind("dispatcher-", 0), 0u) << listenerThread;
+    dispatcher.stopDispatcher();
+    eng->stopEngine();
+}
+
+// Out of order storage the engine rejects the order and keeps matching.
+TEST(MatchingEngineCapacityTest, FullBookRejectsAndKeepsTrading) {
+    auto eng = std::make_unique<MatchingEngine>();
+    eng->registerSymbol("CAP", 2);
+    eng->startEngine();
+
+    auto order = [](Side side, double price) {
+        DispatchMsg msg;
+        msg.type = MsgType::NEW_ORDER;
+        msg.symbol = "CAP";
+        msg.sessionId = 7;
+        msg.side = side;
+        msg.price = price;
+        msg.qty = 1;
+        return msg;
+    };
+    ASSERT_TRUE(eng->pushInbound(order(Side::BUY, 90.0)));
+    ASSERT_TRUE(eng->pushInbound(order(Side::BUY, 91.0)));
+    ASSERT_TRUE(eng->pushInbound(order(Side::BUY, 92.0)));
+    ASSERT_TRUE(eng->pushInbound(order(Side::SELL, 91.0)));
+    for (int i = 0; i < 200 && eng->inboundProcessed_.load() < 4; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    int rejects = 0;
+    int trades = 0;
+    DispatchMsg out;
+    while (eng->popOutbound(out)) {
+        if (out.type == MsgType::UNKNOWN) {
+            ++rejects;
+            EXPECT_EQ(out.status, "BOOK_FULL");
+            EXPECT_EQ(out.qty, 1u);
+            EXPECT_EQ(out.sessionId, 7u);
+        }
+        if (out.type == MsgType::TRADE_REPORT) {
+            ++trades;
+            EXPECT_EQ(out.price, 91.0);
+        }
+    }
+    EXPECT_EQ(rejects, 1);
+    EXPECT_EQ(trades, 1);
+    eng->stopEngine();
+}
+
+// The warm engine must behave exactly like a cold one: ids start at 1 and
+// the books are empty. Also times the first 10k orders it processes.
+TEST(MatchingEngineWarmupTest, FirstOrdersAfterShadowWarmUp) {
+    constexpr int kOrders = 10000;
+    auto eng = std::make_unique<MatchingEngine>(kOrders * 2, kOrders * 4);
+    eng->registerSymbol("XPEV", 20000);
+    eng->setWarmup(5000, 256);
+    eng->startEngine();
+
+    // Rest a sell, then take it: every other order trades.
+    auto order = [](int i) {
+        DispatchMsg msg;
+        msg.type = MsgType::NEW_ORDER;
+        msg.symbol = "XPEV";
+        msg.sessionId = 1;
+        msg.side = (i % 2 == 0) ? Side::SELL : Side::BUY;
+        msg.price = 100.0 + (i / 2) % 16;
+        msg.qty = 1;
+        return msg;
+    };
+    for (int i = 0; i < kOrders; ++i) {
+        while (!eng->pushInbound(order(i))) std::this_thread::yield();
+    }
+    std::vector<uint64_t> lat;
+    for (int i = 0; i < 500 && eng->inboundProcessed_.load() < kOrders; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    lat = eng->collectLatency();
+    ASSERT_EQ(lat.size(), static_cast<size_t>(kOrders));
+
+    uint64_t firstMaker = 0;
+    int trades = 0;
+    DispatchMsg out;
+    while (eng->popOutbound(out)) {
+        if (out.type != MsgType::TRADE_REPORT) continue;
+        if (trades++ == 0) firstMaker = out.makerId;
+    }
+    EXPECT_EQ(trades, kOrders / 2);
+    EXPECT_EQ(firstMaker, 1u);
+
+    std::sort(lat.begin(), lat.end());
+    RecordProperty("first10k_p50_ns", static_cast<int>(lat[lat.size() / 2]));
+    RecordProperty("first10k_p99_ns", static_cast<int>(lat[lat.size() * 99 / 100]));
+    RecordProperty("first10k_max_ns", static_cast<int>(std::min<uint64_t>(lat.back(), INT32_MAX)));
+    eng->stopEngine();
+}
+
+// A warm-up that throws must reach the caller, not leave it waiting.
+TEST(MatchingEngineWarmupTest, FailedWarmUpThrowsFromStartEngine) {
+    auto eng = std::make_unique<MatchingEngine>();
+    eng->registerSymbol("XPEV");
+    eng->setWarmup(64, std::numeric_limits<size_t>::max() / 2);
+    EXPECT_ANY_THROW(eng->startEngine());
+    eng->stopEngine();
+}
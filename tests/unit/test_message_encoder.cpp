@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "utils/message_encoder.h"
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace dispatch;
+using namespace utils;
+
+namespace {
+
+DispatchMsg randomReport(std::mt19937_64& rng) {
+    static const MsgType types[] = {MsgType::ACK, MsgType::TRADE_REPORT,
+                                    MsgType::CANCEL_REPORT, MsgType::UNKNOWN};
+    static const char* statuses[] = {"", "ACCEPTED", "REJECTED", "FILLED", "CANCELED"};
+    static const char* texts[] = {"", "ok", "order not found", "bad \"qty\"\tvalue\n"};
+
+    DispatchMsg m;
+    m.type = types[rng() % 4];
+    m.symbol = (rng() % 5 == 0) ? "" : "SYM" + std::to_string(rng() % 1000);
+    switch (rng() % 4) {
+        case 0: m.price = 0; break;
+        case 1: m.price = static_cast<double>(rng() % 100000) / 100.0; break;
+        case 2: m.price = std::uniform_real_distribution<double>(0, 1e6)(rng); break;
+        default: m.price = 1e-7 * static_cast<double>(rng() % 1000 + 1); break;
+    }
+    m.qty = (rng() % 4 == 0) ? 0 : static_cast<uint32_t>(rng());
+    m.orderId = (rng() % 3 == 0) ? 0 : rng();
+    m.makerId = (rng() % 3 == 0) ? 0 : rng() % 1000000;
+    m.takerId = (rng() % 3 == 0) ? 0 : rng() % 1000000;
+    m.status = statuses[rng() % 5];
+    m.msg = texts[rng() % 4];
+    return m;
+}
+
+}
+
+TEST(MessageEncoderTest, MatchesDomEncoderOnRandomReports) {
+    std::mt19937_64 rng(42);
+    std::string out;
+    for (int i = 0; i < 20000; ++i) {
+        DispatchMsg m = randomReport(rng);
+        encodeMsg(m, out);
+        ASSERT_EQ(out, encodeMsgJson(m)) << "iteration " << i;
+    }
+}
+
+TEST(MessageEncoderTest, EscapesLikeDomEncoder) {
+    DispatchMsg m;
+    m.type = MsgType::ACK;
+    m.status = "REJECTED";
+    for (int c = 1; c < 0x80; ++c) m.msg.push_back(static_cast<char>(c));
+    m.symbol = "A\\B\"C";
+    EXPECT_EQ(encodeMsg(m), encodeMsgJson(m));
+
+    m.msg = "utf8 \xc3\xa9\xe2\x82\xac";
+    EXPECT_EQ(encodeMsg(m), encodeMsgJson(m));
+}
+
+TEST(MessageEncoderTest, EdgeNumbers) {
+    DispatchMsg m;
+    m.type = MsgType::TRADE_REPORT;
+    m.orderId = std::numeric_limits<uint64_t>::max();
+    m.qty = std::numeric_limits<uint32_t>::max();
+    for (double p : {0.1, 1.0, 100.0, 1e21, 1e-5, 123456789.125,
+                     std::numeric_limits<double>::max(),
+                     std::numeric_limits<double>::denorm_min(),
+                     std::numeric_limits<double>::infinity()}) {
+        m.price = p;
+        EXPECT_EQ(encodeMsg(m), encodeMsgJson(m)) << p;
+    }
+}
+
+TEST(MessageEncoderTest, ReturnsZeroWhenBufferTooSmall) {
+    DispatchMsg m;
+    m.type = MsgType::ACK;
+    m.symbol = "MAOTAI";
+    m.orderId = 7;
+    std::string expected = encodeMsgJson(m);
+
+    char buf[64];
+    EXPECT_EQ(encodeMsgTo(m, buf, expected.size() - 1), 0u);
+    ASSERT_EQ(encodeMsgTo(m, buf, sizeof(buf)), expected.size());
+    EXPECT_EQ(std::string(buf, expected.size()), expected);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "utils/message_parser.h"
+#include <cstring>
+#include <random>
+#include <string>
+
+using namespace dispatch;
+using namespace utils;
+
+namespace {
+
+void expectSame(const DispatchMsg& a, const DispatchMsg& b, const std::string& input) {
+    EXPECT_EQ(a.type, b.type) << input;
+    if (a.type == MsgType::UNKNOWN && b.type == MsgType::UNKNOWN) return;
+    EXPECT_EQ(a.symbol, b.symbol) << input;
+    EXPECT_EQ(a.side, b.side) << input;
+    EXPECT_EQ(std::memcmp(&a.price, &b.price, sizeof(double)), 0)
+        << input << " fast=" << a.price << " json=" << b.price;
+    EXPECT_EQ(a.qty, b.qty) << input;
+    EXPECT_EQ(a.orderId, b.orderId) << input;
+}
+
+std::string pick(std::mt19937_64& rng, std::initializer_list<const char*> opts) {
+    return *(opts.begin() + rng() % opts.size());
+}
+
+std::string ws(std::mt19937_64& rng) {
+    return (rng() % 4 == 0) ? pick(rng, {" ", "\n", "\t ", "\r\n  "}) : "";
+}
+
+std::string randomValue(std::mt19937_64& rng) {
+    switch (rng() % 6) {
+        case 0: return "\"" + pick(rng, {"NEW_ORDER", "CANCEL_ORDER", "QUERY_ORDER", "BUY",
+                                         "SELL", "MAOTAI", "", "a\\\"b", "caf\xc3\xa9",
+                                         "tab\there", "\\u0041BC"}) + "\"";
+        case 1: return std::to_string(rng() % 100000);
+        case 2: return std::to_string(static_cast<double>(rng() % 10000000) / 1000.0);
+        case 3: return pick(rng, {"0", "-0", "-17", "1e3", "2.5E-2", "1.0", "01", "1.", "-",
+                                  "1e400", "1e-400", "2147483647", "2147483648", "-2147483649",
+                                  "18446744073709551616", "9007199254740993", "0.1e1"});
+        case 4: return pick(rng, {"true", "false", "null", "tru"});
+        default: return pick(rng, {"{}", "[1,2]", "{\"a\":1}", "\"x\""});
+    }
+}
+
+std::string randomPayload(std::mt19937_64& rng) {
+    static const char* keys[] = {"type", "symbol", "side", "price", "qty", "orderId",
+                                 "clientId", "note", "ty\\u0070e", ""};
+    std::string s = ws(rng) + "{";
+    int fields = static_cast<int>(rng() % 8);
+    for (int i = 0; i < fields; ++i) {
+        if (i) s += ws(rng) + ",";
+        std::string key = keys[rng() % 10];
+        std::string val;
+        // Mostly well-typed values so the fast path gets exercised.
+        if (rng() % 3) {
+            if (key == "type") val = "\"" + pick(rng, {"NEW_ORDER", "CANCEL_ORDER", "MODIFY_ORDER", "QUERY_ORDER", "X"}) + "\"";
+            else if (key == "symbol") val = "\"SYM" + std::to_string(rng() % 100) + "\"";
+            else if (key == "side") val = (rng() % 2) ? "\"BUY\"" : "\"SELL\"";
+            else if (key == "price") val = std::to_string(static_cast<double>(rng() % 1000000) / 100.0);
+            else val = std::to_string(rng() % 1000000);
+        } else {
+            val = randomValue(rng);
+        }
+        s += ws(rng) + "\"" + key + "\"" + ws(rng) + ":" + ws(rng) + val;
+    }
+    s += ws(rng) + "}" + ws(rng);
+
+    switch (rng() % 10) {
+        case 0: s.resize(rng() % (s.size() + 1)); break;
+        case 1: if (!s.empty()) s[rng() % s.size()] = static_cast<char>(rng()); break;
+        case 2: s += pick(rng, {"x", "{}", ",", "\n{}"}); break;
+        default: break;
+    }
+    return s;
+}
+
+}
+
+TEST(MessageParserTest, FastPathHandlesOrders) {
+    DispatchMsg m;
+    ASSERT_TRUE(parseOrderFast(R"({"type":"NEW_ORDER","symbol":"MAOTAI","side":"SELL","price":1800.5,"qty":10})", m));
+    EXPECT_EQ(m.type, MsgType::NEW_ORDER);
+    EXPECT_EQ(m.symbol, "MAOTAI");
+    EXPECT_EQ(m.side, core::Side::SELL);
+    EXPECT_DOUBLE_EQ(m.price, 1800.5);
+    EXPECT_EQ(m.qty, 10u);
+
+    DispatchMsg c;
+    ASSERT_TRUE(parseOrderFast(" { \"type\" : \"CANCEL_ORDER\", \"symbol\": \"ICBC\", \"orderId\": 42 }\n", c));
+    EXPECT_EQ(c.type, MsgType::CANCEL_ORDER);
+    EXPECT_EQ(c.orderId, 42u);
+}
+
+TEST(MessageParserTest, FallsBackOnUnusualShapes) {
+    DispatchMsg m;
+    EXPECT_FALSE(parseOrderFast(R"({"type":"NEW_ORDER","symbol":"A\"B"})", m));
+    EXPECT_FALSE(parseOrderFast(R"({"type":"NEW_ORDER","extra":{"a":1}})", m));
+    EXPECT_FALSE(parseOrderFast(R"({"type":"NEW_ORDER","qty":1.5})", m));
+    EXPECT_FALSE(parseOrderFast(R"({"type":"NEW_ORDER"} trailing)", m));
+    EXPECT_FALSE(parseOrderFast("[]", m));
+
+    DispatchMsg esc = parseMsg(R"({"type":"NEW_ORDER","symbol":"A\"B","qty":3})");
+    EXPECT_EQ(esc.type, MsgType::NEW_ORDER);
+    EXPECT_EQ(esc.symbol, "A\"B");
+    EXPECT_EQ(esc.qty, 3u);
+}
+
+TEST(MessageParserTest, FuzzMatchesJsonParser) {
+    std::mt19937_64 rng(7);
+    int fast = 0;
+    for (int i = 0; i < 50000; ++i) {
+        std::string input = randomPayload(rng);
+        DispatchMsg probe;
+        if (parseOrderFast(input, probe)) ++fast;
+        expectSame(parseMsg(input), parseMsgJson(input), input);
+        if (HasFailure()) break;
+    }
+    EXPECT_GT(fast, 10000);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "net/epoll_reactor.h"
+#include "net/stats_endpoint.h"
+#include "net/stats_segment.h"
+#include "utils/metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace utils;
+using namespace net;
+
+namespace {
+
+bool hasSample(const std::vector<MetricSample>& samples, const std::string& name, int64_t value) {
+    for (const auto& s : samples) {
+        if (s.name == name) return s.value == value;
+    }
+    return false;
+}
+
+std::string httpGet(uint16_t port, const std::string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return {};
+    }
+    timeval tv{2, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+    std::string response;
+    char buf[4096];
+    for (;;) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        response.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+}
+
+TEST(MetricsTest, CounterSumsEveryThreadsShard) {
+    constexpr int kThreads = 8;
+    constexpr int kIncrements = 100000;
+    Counter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kIncrements; ++i) counter.inc();
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(counter.value(), static_cast<uint64_t>(kThreads) * kIncrements);
+}
+
+TEST(MetricsTest, RenderGroupsSeriesUnderOneTypeLine) {
+    Counter a, b;
+    a.inc(3);
+    b.inc(5);
+    int64_t depth = 7;
+    {
+        MetricsScope scope;
+        scope.counter(labelled("test_render_total", "shard", "1"), b);
+        scope.gauge("test_render_depth", [&] { return depth; });
+        scope.counter(labelled("test_render_total", "shard", "0"), a);
+
+        std::string text = MetricsRegistry::instance().renderText();
+        EXPECT_NE(text.find("# TYPE test_render_total counter\n"
+                            "test_render_total{shard=\"0\"} 3\n"
+                            "test_render_total{shard=\"1\"} 5\n"), std::string::npos);
+        EXPECT_NE(text.find("# TYPE test_render_depth gauge\ntest_render_depth 7\n"), std::string::npos);
+    }
+    // The scope took its metrics with it.
+    EXPECT_EQ(MetricsRegistry::instance().renderText().find("test_render_"), std::string::npos);
+}
+
+TEST(MetricsTest, EndpointServesTextOverHttp) {
+    constexpr uint16_t kPort = 19741;
+    Counter served;
+    served.inc(42);
+    MetricsScope scope;
+    scope.counter("test_http_total", served);
+
+    EpollReactor reactor(64, 20);
+    StatsEndpoint endpoint(reactor, "127.0.0.1", kPort);
+    ASSERT_TRUE(endpoint.startEndpoint());
+    std::thread loop([&] { reactor.runEventLoop(); });
+
+    std::string ok = httpGet(kPort, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    std::string refused = httpGet(kPort, "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    reactor.stopEventLoop();
+    loop.join();
+
+    EXPECT_EQ(ok.compare(0, 15, "HTTP/1.1 200 OK"), 0) << ok;
+    EXPECT_NE(ok.find("\r\n\r\n"), std::string::npos);
+    EXPECT_NE(ok.find("test_http_total 42\n"), std::string::npos);
+    EXPECT_EQ(refused.compare(0, 12, "HTTP/1.1 405"), 0) << refused;
+}
+
+TEST(MetricsTest, SegmentPublishesSnapshotToReaders) {
+    const std::string name = "/ob_test_stats_" + std::to_string(::getpid());
+    Counter orders;
+    orders.inc(9);
+    MetricsScope scope;
+    scope.counter("test_shm_total", orders);
+    scope.gauge(labelled("test_shm_depth", "engine", "0"), [] { return int64_t{-4}; });
+
+    StatsPublisher publisher(name, 1024, std::chrono::hours(1));
+    ASSERT_TRUE(publisher.startPublisher());
+
+    StatsReader reader;
+    ASSERT_TRUE(reader.attach(name));
+    std::vector<MetricSample> samples;
+    int64_t updated = 0;
+    // The publisher thread writes once as it starts.
+    for (int i = 0; i < 2000 && !reader.read(samples, &updated); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(hasSample(samples, "test_shm_total", 9));
+    EXPECT_TRUE(hasSample(samples, "test_shm_depth{engine=\"0\"}", -4));
+    EXPECT_GT(updated, 0);
+
+    orders.inc();
+    publisher.publishNow();
+    ASSERT_TRUE(reader.read(samples));
+    EXPECT_TRUE(hasSample(samples, "test_shm_total", 10));
+    publisher.stopPublisher();
+}
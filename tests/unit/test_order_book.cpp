@@ -55,3 +55,96 @@ TEST_F(OrderBookTest, BestPriceUpdatesAfterMatch) {
     EXPECT_DOUBLE_EQ(book.bestAsk(), 102.0);
     EXPECT_DOUBLE_EQ(book.bestBid(), 99.0);
 }
+
+TEST_F(OrderBookTest, ShadowWarmUpRefusesALiveBook) {
+    EXPECT_FALSE(book.shadowWarmUp(1000));
+    EXPECT_EQ(book.orderIndex().size(), 4u);
+}
+
+TEST(OrderBookWarmUpTest, ShadowOrdersLeaveNothingBehind) {
+    OrderBook book{"APPL", 1000};
+    book.reserve(1000, 256);
+    ASSERT_TRUE(book.shadowWarmUp(5000));
+
+    EXPECT_TRUE(book.bids().empty());
+    EXPECT_TRUE(book.asks().empty());
+    EXPECT_TRUE(book.orderIndex().empty());
+    EXPECT_TRUE(book.getTradeEvents().empty());
+    EXPECT_EQ(book.commandCount(), 0u);
+    EXPECT_EQ(book.ordersInUse(), 0u);
+    EXPECT_DOUBLE_EQ(book.bestBid(), 0.0);
+
+    // Ids carry on as if the warm-up never ran.
+    EXPECT_EQ(book.addOrder(Side::BUY, 99.0, 10)->orderId, 1u);
+}
+
+TEST_F(OrderBookTest, RestoredImageTradesLikeTheOriginal) {
+    book.addOrder(Side::SELL, 101.0, 7);
+    OrderBook copy{"APPL", 10000};
+    copy.addOrder(Side::BUY, 50.0, 1);
+    copy.restore(book.image());
+    EXPECT_EQ(copy.orderIndex().size(), book.orderIndex().size());
+    EXPECT_DOUBLE_EQ(copy.bestAsk(), book.bestAsk());
+    EXPECT_DOUBLE_EQ(copy.bestBid(), book.bestBid());
+
+    book.matchOrder(Side::BUY, 101.0, 15);
+    copy.matchOrder(Side::BUY, 101.0, 15);
+    ASSERT_EQ(copy.getTradeEvents().size(), book.getTradeEvents().size());
+    for (size_t k = 0; k < book.getTradeEvents().size(); ++k) {
+        EXPECT_EQ(copy.getTradeEvents()[k].makerOrderId, book.getTradeEvents()[k].makerOrderId);
+        EXPECT_EQ(copy.getTradeEvents()[k].takerOrderId, book.getTradeEvents()[k].takerOrderId);
+        EXPECT_EQ(copy.getTradeEvents()[k].qty, book.getTradeEvents()[k].qty);
+    }
+}
+
+TEST(OrderArenaTest, BooksBorrowChunksFromSharedArena) {
+    constexpr size_t kChunk = OrderArena::CHUNK_ORDERS;
+    auto arena = std::make_shared<OrderArena>(4 * kChunk);
+    OrderBook hot{"HOT", arena, 100000};
+    OrderBook quiet{"QUIET", arena, 100000};
+    EXPECT_EQ(quiet.poolCapacity(), 0u);
+
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < 3 * kChunk; ++i) ids.push_back(hot.addOrder(Side::BUY, 90.0 + i % 10, 1)->orderId);
+    EXPECT_EQ(hot.poolCapacity(), 3 * kChunk);
+    for (size_t i = 0; i < kChunk; ++i) quiet.addOrder(Side::SELL, 110.0, 1);
+    EXPECT_EQ(arena->chunksInUse(), 4u);
+    EXPECT_EQ(quiet.addOrder(Side::SELL, 111.0, 1), nullptr);
+
+    // Once the hot book is flat again its chunks go back for the other.
+    for (uint64_t id : ids) ASSERT_TRUE(hot.cancelOrder(id));
+    hot.trimPool();
+    EXPECT_EQ(hot.poolCapacity(), kChunk);
+    EXPECT_NE(quiet.addOrder(Side::SELL, 111.0, 1), nullptr);
+    EXPECT_EQ(quiet.poolCapacity(), 2 * kChunk);
+    EXPECT_EQ(arena->chunksAllocated(), 4u);
+}
+
+TEST(OrderArenaTest, QuotaCapsLiveOrdersPerBook) {
+    auto arena = std::make_shared<OrderArena>();
+    OrderBook book{"CAPPED", arena, 10};
+    for (int i = 0; i < 10; ++i) book.addOrder(Side::BUY, 100.0, 1);
+    EXPECT_EQ(book.addOrder(Side::BUY, 100.0, 1), nullptr);
+    EXPECT_EQ(book.ordersInUse(), 10u);
+
+    // Filling an order frees its slot.
+    EXPECT_EQ(book.matchOrder(Side::SELL, 100.0, 1), 0u);
+    EXPECT_NE(book.addOrder(Side::BUY, 100.0, 1), nullptr);
+}
+
+TEST(OrderArenaTest, FullBookRefusesOnlyTheRemainder) {
+    auto arena = std::make_shared<OrderArena>();
+    OrderBook book{"FULL", arena, 4};
+    for (int i = 0; i < 4; ++i) book.addOrder(Side::SELL, 100.0, 1);
+
+    // The fills free their slots, so the remainder still rests.
+    EXPECT_EQ(book.matchOrder(Side::BUY, 100.0, 7), 0u);
+    EXPECT_EQ(book.getTradeEvents().size(), 4u);
+    EXPECT_EQ(book.ordersInUse(), 1u);
+    book.clearTradeEvents();
+
+    for (int i = 0; i < 3; ++i) ASSERT_NE(book.addOrder(Side::BUY, 99.0, 1), nullptr);
+    EXPECT_EQ(book.matchOrder(Side::BUY, 98.0, 5), 5u);
+    EXPECT_EQ(book.ordersInUse(), 4u);
+    EXPECT_EQ(book.bestBid(), 100.0);
+}
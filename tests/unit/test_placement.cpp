@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "utils/placement.h"
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+using namespace utils;
+
+TEST(PlacementTest, ParsesCpuListsPerRole) {
+    ASSERT_TRUE(Placement::configure("engine=2, Dispatcher=3 reactor=4-6 pool=0-1:8"));
+    EXPECT_EQ(Placement::cpusFor("engine"), (std::vector<int>{2}));
+    EXPECT_EQ(Placement::cpusFor("dispatcher"), (std::vector<int>{3}));
+    EXPECT_EQ(Placement::cpusFor("reactor"), (std::vector<int>{4, 5, 6}));
+    EXPECT_EQ(Placement::cpusFor("pool"), (std::vector<int>{0, 1, 8}));
+    EXPECT_TRUE(Placement::cpusFor("logger").empty());
+
+    // A bad spec changes nothing.
+    EXPECT_FALSE(Placement::configure("engine=x"));
+    EXPECT_FALSE(Placement::configure("reactor=5-4"));
+    EXPECT_FALSE(Placement::configure("=1"));
+    EXPECT_EQ(Placement::cpusFor("engine"), (std::vector<int>{2}));
+
+    ASSERT_TRUE(Placement::configure(""));
+    EXPECT_TRUE(Placement::cpusFor("engine").empty());
+}
+
+TEST(PlacementTest, PlacedThreadIsNamedAndPinned) {
+    ASSERT_TRUE(Placement::configure("engine=0"));
+    int cpu = -2, running = -2;
+    char name[16] = {};
+    std::thread t([&] {
+        cpu = Placement::placeThread("engine", 3);
+        running = ::sched_getcpu();
+        ::pthread_getname_np(::pthread_self(), name, sizeof(name));
+    });
+    t.join();
+    Placement::configure("");
+
+    EXPECT_EQ(cpu, 0);
+    EXPECT_EQ(running, 0);
+    EXPECT_STREQ(name, "engine-3");
+}
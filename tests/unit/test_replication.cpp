@@ -0,0 +1,323 @@
+#include <gtest/gtest.h>
+#include "engine/replication.h"
+#include "engine/matching_engine.h"
+#include "utils/socketops.h"
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dispatch;
+using namespace core;
+using namespace engine;
+
+namespace {
+
+uint64_t mixTrade(uint64_t h, const DispatchMsg& m) {
+    auto mix = [&](uint64_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+    mix(m.makerId);
+    mix(m.takerId);
+    mix(m.qty);
+    mix(static_cast<uint64_t>(m.price * 100));
+    return h;
+}
+
+DispatchMsg makeOrder(uint32_t i) {
+    DispatchMsg m;
+    m.type = (i % 7 == 6) ? MsgType::CANCEL_ORDER : MsgType::NEW_ORDER;
+    m.symbol = (i % 2) ? "REPL_A" : "REPL_B";
+    m.side = (i % 3) ? Side::BUY : Side::SELL;
+    m.price = 100.0 + static_cast<double>(i % 11) * 0.5;
+    m.qty = 1 + i % 13;
+    m.orderId = i / 2;
+    return m;
+}
+
+// Commands that leave the books untouched: cancels of unknown orders.
+void pushCancels(MatchingEngine& eng, uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        DispatchMsg m;
+        m.type = MsgType::CANCEL_ORDER;
+        m.symbol = "REPL_A";
+        m.orderId = 1000000 + i;
+        while (!eng.pushInbound(std::move(m))) {
+            DispatchMsg out;
+            while (eng.popOutbound(out)) {}
+        }
+    }
+    DispatchMsg out;
+    while (eng.lastCommandSeq() < n) {
+        while (eng.popOutbound(out)) {}
+        std::this_thread::yield();
+    }
+}
+
+}
+
+TEST(ReplicationTest, RecordRoundTrip) {
+    DispatchMsg m = makeOrder(5);
+    ReplRecord rec;
+    ASSERT_TRUE(encodeReplRecord(42, m, rec));
+    DispatchMsg back = decodeReplRecord(rec);
+    EXPECT_EQ(rec.seq, 42u);
+    EXPECT_EQ(back.symbol, m.symbol);
+    EXPECT_EQ(back.type, m.type);
+    EXPECT_EQ(back.side, m.side);
+    EXPECT_DOUBLE_EQ(back.price, m.price);
+    EXPECT_EQ(back.qty, m.qty);
+    EXPECT_EQ(back.orderId, m.orderId);
+}
+
+TEST(ReplicationTest, BackupProcessMirrorsPrimary) {
+    constexpr uint32_t kOrders = 5000;
+    const std::string path = "/tmp/orderbook_repl_" + std::to_string(::getpid()) + ".sock";
+
+    int pipeFds[2];
+    ASSERT_EQ(::pipe(pipeFds), 0);
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        ::close(pipeFds[0]);
+        auto backup = std::make_unique<MatchingEngine>();
+        backup->registerSymbol("REPL_A", 10000);
+        backup->registerSymbol("REPL_B", 10000);
+        backup->startEngine();
+
+        uint64_t hash = 0;
+        ReplicationFollower follower(*backup, path);
+        follower.setReportHandler([&](const DispatchMsg& m) {
+            if (m.type == MsgType::TRADE_REPORT) hash = mixTrade(hash, m);
+        });
+        if (!follower.startFollower()) ::_exit(2);
+        while (!follower.primaryLost()) ::usleep(1000);
+
+        uint64_t result[2] = {follower.promote(), hash};
+        backup->stopEngine();
+        ssize_t w = ::write(pipeFds[1], result, sizeof(result));
+        ::_exit(w == sizeof(result) ? 0 : 3);
+    }
+    ::close(pipeFds[1]);
+
+    auto primary = std::make_unique<MatchingEngine>();
+    primary->registerSymbol("REPL_A", 10000);
+    primary->registerSymbol("REPL_B", 10000);
+    ReplicationPublisher publisher(path);
+    publisher.attach(*primary);
+    ASSERT_TRUE(publisher.startPublisher());
+    primary->startEngine();
+
+    uint64_t hash = 0;
+    auto drain = [&] {
+        DispatchMsg out;
+        while (primary->popOutbound(out)) {
+            if (out.type == MsgType::TRADE_REPORT) hash = mixTrade(hash, out);
+        }
+    };
+
+    for (uint32_t i = 0; i < kOrders; ++i) {
+        DispatchMsg m = makeOrder(i);
+        while (!primary->pushInbound(std::move(m))) drain();
+        drain();
+    }
+    while (primary->lastCommandSeq() < kOrders) drain();
+    drain();
+
+    EXPECT_TRUE(publisher.waitForAck(kOrders, std::chrono::seconds(10)));
+    EXPECT_EQ(publisher.ackedSeq(), kOrders);
+    primary->stopEngine();
+    publisher.stopPublisher();
+
+    uint64_t result[2] = {0, 0};
+    EXPECT_EQ(::read(pipeFds[0], result, sizeof(result)), (ssize_t)sizeof(result));
+    ::close(pipeFds[0]);
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(result[0], kOrders);
+    EXPECT_EQ(result[1], hash);
+    EXPECT_NE(hash, 0u);
+}
+
+TEST(ReplicationTest, FullRingNeverStallsTheEngine) {
+    constexpr uint32_t kExtra = 1000;
+    auto primary = std::make_unique<MatchingEngine>();
+    primary->registerSymbol("REPL_A");
+    // The publisher is never started, so nothing drains its ring.
+    ReplicationPublisher publisher("/tmp/orderbook_repl_ring_" + std::to_string(::getpid()) + ".sock");
+    publisher.attach(*primary);
+    primary->startEngine();
+
+    pushCancels(*primary, ReplicationPublisher::RING_CAP + kExtra);
+    EXPECT_EQ(primary->lastCommandSeq(), ReplicationPublisher::RING_CAP + kExtra);
+    EXPECT_EQ(publisher.lostRecords(), kExtra);
+    primary->stopEngine();
+}
+
+TEST(ReplicationTest, StalledBackupIsDropped) {
+    const std::string path = "/tmp/orderbook_repl_stall_" + std::to_string(::getpid()) + ".sock";
+    auto primary = std::make_unique<MatchingEngine>();
+    primary->registerSymbol("REPL_A");
+    ReplicationPublisher publisher(path);
+    publisher.attach(*primary);
+    ASSERT_TRUE(publisher.startPublisher());
+    primary->startEngine();
+
+    // A backup that completes the handshake and then never reads.
+    int fd = utils::connectUnixSocket(path);
+    ASSERT_GE(fd, 0);
+    uint64_t lastSeq = 0;
+    ASSERT_EQ(::send(fd, &lastSeq, sizeof(lastSeq), 0), static_cast<ssize_t>(sizeof(lastSeq)));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!publisher.hasBackup() && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+    ASSERT_TRUE(publisher.hasBackup());
+
+    // Far more than the socket buffers hold.
+    pushCancels(*primary, 50000);
+    deadline = std::chrono::steady_clock::now() + ReplicationPublisher::BACKUP_STALL * 3;
+    while (publisher.hasBackup() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(publisher.hasBackup());
+    EXPECT_EQ(publisher.lostRecords(), 0u);
+
+    primary->stopEngine();
+    publisher.stopPublisher();
+    ::close(fd);
+}
+
+TEST(ReplicationTest, FollowerResyncsFromTheFirstMissingRecord) {
+    const std::string path = "/tmp/orderbook_repl_gap_" + std::to_string(::getpid()) + ".sock";
+    int listenFd = utils::createUnixListenSocket(path);
+    ASSERT_GE(listenFd, 0);
+
+    auto backup = std::make_unique<MatchingEngine>();
+    backup->registerSymbol("REPL_A");
+    backup->startEngine();
+    ReplicationFollower follower(*backup, path);
+    ASSERT_TRUE(follower.startFollower());
+
+    // A primary that answers a handshake and sends the given records.
+    auto serve = [&](std::initializer_list<uint64_t> seqs) {
+        int fd = -1;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while ((fd = ::accept(listenFd, nullptr, nullptr)) < 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_GE(fd, 0);
+        uint64_t lastSeq = ~0ull;
+        EXPECT_EQ(::recv(fd, &lastSeq, sizeof(lastSeq), MSG_WAITALL), static_cast<ssize_t>(sizeof(lastSeq)));
+        for (uint64_t seq : seqs) {
+            DispatchMsg m;
+            m.type = MsgType::CANCEL_ORDER;
+            m.symbol = "REPL_A";
+            m.orderId = seq;
+            ReplRecord rec;
+            encodeReplRecord(seq, m, rec);
+            EXPECT_EQ(::send(fd, &rec, sizeof(rec), MSG_NOSIGNAL), static_cast<ssize_t>(sizeof(rec)));
+        }
+        return std::make_pair(fd, lastSeq);
+    };
+
+    auto [first, firstHandshake] = serve({1, 2, 4, 5});
+    EXPECT_EQ(firstHandshake, 0u);
+    // Record 4 arrived after a hole: the follower reconnects asking for 3 on.
+    auto [second, secondHandshake] = serve({3, 4, 5});
+    EXPECT_EQ(secondHandshake, 2u);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (follower.receivedSeq() < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(follower.receivedSeq(), 5u);
+    EXPECT_FALSE(follower.primaryLost());
+
+    EXPECT_EQ(follower.promote(), 5u);
+    EXPECT_EQ(backup->lastCommandSeq(), 5u);
+    backup->stopEngine();
+    ::close(first);
+    ::close(second);
+    ::close(listenFd);
+    ::unlink(path.c_str());
+}
+
+TEST(ReplicationTest, BackupResyncsFromSnapshotAfterRingOverflow) {
+    constexpr uint32_t kResting = 50;
+    const std::string path = "/tmp/orderbook_repl_snap_" + std::to_string(::getpid()) + ".sock";
+    auto primary = std::make_unique<MatchingEngine>();
+    primary->registerSymbol("REPL_A");
+    ReplicationPublisher publisher(path);
+    publisher.attach(*primary);
+    primary->startEngine();
+
+    // Resting bids, then enough no-op commands to overflow the ring while
+    // nothing drains it: the log alone can no longer rebuild the book.
+    for (uint32_t i = 0; i < kResting; ++i) {
+        DispatchMsg m;
+        m.type = MsgType::NEW_ORDER;
+        m.symbol = "REPL_A";
+        m.side = Side::BUY;
+        m.price = 100.0 - static_cast<double>(i % 5);
+        m.qty = 10 + i;
+        ASSERT_TRUE(primary->pushInbound(std::move(m)));
+    }
+    pushCancels(*primary, ReplicationPublisher::RING_CAP + 100);
+    while (primary->lastCommandSeq() < kResting + ReplicationPublisher::RING_CAP + 100) std::this_thread::yield();
+    ASSERT_GT(publisher.lostRecords(), 0u);
+    ASSERT_TRUE(publisher.startPublisher());
+
+    auto backup = std::make_unique<MatchingEngine>();
+    backup->startEngine();
+    std::vector<DispatchMsg> backupTrades;
+    ReplicationFollower follower(*backup, path);
+    follower.setReportHandler([&](const DispatchMsg& m) {
+        if (m.type == MsgType::TRADE_REPORT) backupTrades.push_back(m);
+    });
+    ASSERT_TRUE(follower.startFollower());
+
+    uint64_t snapSeq = primary->lastCommandSeq();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (follower.receivedSeq() < snapSeq && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(follower.receivedSeq(), snapSeq);
+    EXPECT_EQ(follower.state(), ReplicationFollower::State::FOLLOWING);
+    EXPECT_EQ(follower.resyncCount(), 1u);
+    EXPECT_EQ(publisher.snapshotsSent(), 1u);
+
+    // A sweep through the restored book trades against the same ids.
+    DispatchMsg sweep;
+    sweep.type = MsgType::NEW_ORDER;
+    sweep.symbol = "REPL_A";
+    sweep.side = Side::SELL;
+    sweep.price = 90.0;
+    sweep.qty = 400;
+    ASSERT_TRUE(primary->pushInbound(std::move(sweep)));
+    std::vector<DispatchMsg> primaryTrades;
+    DispatchMsg out;
+    while (primary->lastCommandSeq() < snapSeq + 1) std::this_thread::yield();
+    while (primary->popOutbound(out)) {
+        if (out.type == MsgType::TRADE_REPORT) primaryTrades.push_back(out);
+    }
+    ASSERT_TRUE(publisher.waitForAck(snapSeq + 1, std::chrono::seconds(5)));
+    EXPECT_EQ(follower.promote(), snapSeq + 1);
+
+    ASSERT_FALSE(primaryTrades.empty());
+    ASSERT_EQ(backupTrades.size(), primaryTrades.size());
+    for (size_t k = 0; k < primaryTrades.size(); ++k) {
+        EXPECT_EQ(backupTrades[k].makerId, primaryTrades[k].makerId);
+        EXPECT_EQ(backupTrades[k].takerId, primaryTrades[k].takerId);
+        EXPECT_EQ(backupTrades[k].qty, primaryTrades[k].qty);
+        EXPECT_EQ(backupTrades[k].price, primaryTrades[k].price);
+    }
+
+    primary->stopEngine();
+    publisher.stopPublisher();
+    backup->stopEngine();
+}
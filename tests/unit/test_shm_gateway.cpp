@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "net/shm_client.h"
+#include "net/shm_gateway.h"
+#include "engine/engine_router.h"
+#include "engine/matching_engine.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+using namespace net;
+using namespace dispatch;
+using namespace engine;
+
+namespace {
+
+std::string segmentName(const char* tag) {
+    return "/ob_test_" + std::string(tag) + "_" + std::to_string(::getpid());
+}
+
+template<typename Pred>
+bool waitFor(Pred pred) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
+
+DispatchMsg newOrder(const std::string& symbol, core::Side side, double price, uint32_t qty) {
+    DispatchMsg msg;
+    msg.type = MsgType::NEW_ORDER;
+    msg.symbol = symbol;
+    msg.side = side;
+    msg.price = price;
+    msg.qty = qty;
+    return msg;
+}
+
+}
+
+TEST(ShmRingTest, PassesFramesInOrderAcrossWrap) {
+    constexpr uint32_t kSlots = 8;
+    constexpr uint32_t kFrames = 100000;
+    alignas(64) char storage[ShmRing::bytesFor(kSlots)];
+    auto* hdr = new (storage) ShmRingHeader;
+
+    ShmRing producer(hdr, kSlots);
+    ShmRing consumer(hdr, kSlots);
+    for (uint32_t i = 0; i < kSlots; ++i) ASSERT_TRUE(producer.tryPush(reinterpret_cast<char*>(&i), 4));
+    uint32_t extra = 0;
+    EXPECT_FALSE(producer.tryPush(reinterpret_cast<char*>(&extra), 4));
+    for (uint32_t i = 0; i < kSlots; ++i) {
+        ASSERT_NE(consumer.front(), nullptr);
+        consumer.pop();
+    }
+    EXPECT_EQ(consumer.front(), nullptr);
+
+    std::thread t([&] {
+        for (uint32_t i = 0; i < kFrames; ++i) {
+            while (!producer.tryPush(reinterpret_cast<char*>(&i), sizeof(i))) std::this_thread::yield();
+        }
+    });
+    uint32_t mismatches = 0;
+    for (uint32_t expect = 0; expect < kFrames; ++expect) {
+        const char* frame;
+        while (!(frame = consumer.front())) std::this_thread::yield();
+        uint32_t got;
+        std::memcpy(&got, frame, sizeof(got));
+        mismatches += got != expect;
+        consumer.pop();
+    }
+    t.join();
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_EQ(consumer.size(), 0u);
+}
+
+TEST(ShmGatewayTest, OrdersRoundTripThroughSharedMemory) {
+    auto eng = std::make_unique<MatchingEngine>();
+    eng->registerSymbol("SHM");
+    EngineRouter::instance().bindSymbolToEngine("SHM", eng.get());
+    eng->startEngine();
+
+    Dispatcher dispatcher;
+    ShmGateway gateway(dispatcher, segmentName("rt"));
+    dispatcher.setSender([&](SessionId session, const std::string& payload) {
+        return gateway.queueSend(session, payload);
+    });
+    dispatcher.attachEngine(eng.get());
+    dispatcher.startDispatcher();
+    ASSERT_TRUE(gateway.startGateway());
+
+    ShmClient client;
+    ASSERT_TRUE(client.attach(gateway.name()));
+    EXPECT_TRUE(isShmSession(client.sessionId()));
+
+    ASSERT_TRUE(client.submit(newOrder("SHM", core::Side::BUY, 10.0, 5)));
+    ASSERT_TRUE(client.submit(newOrder("SHM", core::Side::SELL, 10.0, 5)));
+
+    int acks = 0, trades = 0;
+    DispatchMsg report;
+    EXPECT_TRUE(waitFor([&] {
+        while (client.poll(report)) {
+            if (report.type == MsgType::ACK) ++acks;
+            if (report.type == MsgType::TRADE_REPORT) {
+                ++trades;
+                EXPECT_EQ(report.qty, 5u);
+            }
+        }
+        return acks == 2 && trades > 0;
+    }));
+    EXPECT_EQ(gateway.activeClients(), 1u);
+
+    client.detach();
+    gateway.stopGateway();
+    dispatcher.stopDispatcher();
+    eng->stopEngine();
+}
+
+TEST(ShmGatewayTest, DetachedBlockIsReusedUnderNewSession) {
+    Dispatcher dispatcher;
+    ShmGateway gateway(dispatcher, segmentName("reuse"), 1, 64);
+    ASSERT_TRUE(gateway.startGateway());
+
+    ShmClient first;
+    ASSERT_TRUE(first.attach(gateway.name()));
+    SessionId old = first.sessionId();
+    ASSERT_TRUE(waitFor([&] { return gateway.activeClients() == 1; }));
+
+    ShmClient second;
+    EXPECT_FALSE(second.attach(gateway.name()));
+
+    first.detach();
+    ASSERT_TRUE(waitFor([&] { return second.attach(gateway.name()); }));
+    EXPECT_NE(second.sessionId(), old);
+    ASSERT_TRUE(waitFor([&] { return gateway.activeClients() == 1; }));
+
+    // Reports for the closed session are refused, not delivered to its successor.
+    EXPECT_FALSE(gateway.queueSend(old, std::string(32, 'x')));
+    gateway.stopGateway();
+}
+
+TEST(ShmGatewayTest, ClientDyingWhileAttachingFreesItsBlock) {
+    Dispatcher dispatcher;
+    ShmGateway gateway(dispatcher, segmentName("attach"), 1, 64);
+    ASSERT_TRUE(gateway.startGateway());
+
+    // Claim the only block the way ShmClient does, for a process that then dies.
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) ::_exit(0);
+    ASSERT_EQ(::waitpid(child, nullptr, 0), child);
+
+    ShmLayout layout{1, 64};
+    int fd = ::shm_open(gateway.name().c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void* base = ::mmap(nullptr, layout.segmentBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(base, MAP_FAILED);
+    ShmClientHeader* hdr = layout.client(base, 0);
+    uint32_t expected = static_cast<uint32_t>(ShmClientState::FREE);
+    ASSERT_TRUE(hdr->state.compare_exchange_strong(expected, static_cast<uint32_t>(ShmClientState::ATTACHING)));
+    hdr->pid.store(child);
+
+    ShmClient client;
+    EXPECT_FALSE(client.attach(gateway.name()));
+    // Reclaimed after the grace period of one owner check.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    bool attached = false;
+    while (!attached && std::chrono::steady_clock::now() < deadline) {
+        attached = client.attach(gateway.name());
+        if (!attached) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_TRUE(attached);
+
+    client.detach();
+    ::munmap(base, layout.segmentBytes());
+    gateway.stopGateway();
+}
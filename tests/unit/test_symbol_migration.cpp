@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include "engine/symbol_migration.h"
+#include "engine/load_monitor.h"
+#include "engine/engine_router.h"
+#include "dispatch/dispatcher.h"
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+using namespace dispatch;
+using namespace core;
+using namespace engine;
+
+TEST(SymbolMigrationTest, MigrateUnderLoadKeepsOrder) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    a->registerSymbol("MIGR");
+    EngineRouter::instance().bindSymbolToEngine("MIGR", a.get());
+    a->startEngine();
+    b->startEngine();
+
+    Dispatcher dispatcher;
+    DispatchMsg maker;
+    maker.type = MsgType::NEW_ORDER;
+    maker.symbol = "MIGR";
+    maker.side = Side::SELL;
+    maker.price = 100.0;
+    maker.qty = 100000000;
+    ASSERT_TRUE(dispatcher.routeInbound(std::move(maker)));
+    while (a->inboundProcessed_.load() < 1) std::this_thread::yield();
+
+    constexpr uint32_t kOrders = 3000;
+    std::atomic<bool> producing{true};
+    std::atomic<uint32_t> sent{0};
+    std::thread producer([&] {
+        for (uint32_t i = 1; i <= kOrders; ++i) {
+            DispatchMsg m;
+            m.type = MsgType::NEW_ORDER;
+            m.symbol = "MIGR";
+            m.side = Side::BUY;
+            m.price = 100.0;
+            m.qty = i;
+            while (!dispatcher.routeInbound(std::move(m))) std::this_thread::yield();
+            sent.store(i, std::memory_order_relaxed);
+            // Keep the last third for after the rebind so b sees traffic.
+            if (i == 2 * kOrders / 3) {
+                while (EngineRouter::instance().route("MIGR") != b.get()) std::this_thread::yield();
+            }
+        }
+        producing = false;
+    });
+
+    std::vector<DispatchMsg> trades;
+    auto drain = [&] {
+        DispatchMsg out;
+        for (auto* e : {a.get(), b.get()}) {
+            while (e->popOutbound(out)) {
+                if (out.type == MsgType::TRADE_REPORT) trades.push_back(out);
+            }
+        }
+    };
+
+    std::thread migrator([&] {
+        while (sent.load(std::memory_order_relaxed) < kOrders / 3) std::this_thread::yield();
+        EXPECT_TRUE(migrateSymbol("MIGR", *a, *b));
+    });
+
+    while (producing || trades.size() < kOrders) {
+        drain();
+        std::this_thread::yield();
+    }
+    producer.join();
+    migrator.join();
+    drain();
+
+    ASSERT_EQ(trades.size(), kOrders);
+    for (size_t k = 0; k < trades.size(); ++k) {
+        EXPECT_EQ(trades[k].makerId, 1u);
+        EXPECT_EQ(trades[k].qty, k + 1);
+        EXPECT_EQ(trades[k].takerId, k + 2);
+    }
+    EXPECT_EQ(EngineRouter::instance().route("MIGR"), b.get());
+    EXPECT_GT(b->inboundProcessed_.load(), 0u);
+
+    a->stopEngine();
+    b->stopEngine();
+}
+
+TEST(SymbolMigrationTest, MigrateUnownedSymbolFails) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    EngineRouter::instance().bindSymbolToEngine("MIGR_NONE", a.get());
+    a->startEngine();
+    b->startEngine();
+    EXPECT_FALSE(migrateSymbol("MIGR_NONE", *a, *b));
+    // Rolled back: the route is where it was and b holds no reservation.
+    EXPECT_EQ(EngineRouter::instance().route("MIGR_NONE"), a.get());
+    EXPECT_TRUE(b->expectIncoming("MIGR_NONE"));
+    b->cancelIncoming("MIGR_NONE");
+    a->stopEngine();
+    b->stopEngine();
+}
+
+TEST(SymbolMigrationTest, SecondMigrationRejectedWhileInFlight) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    auto c = std::make_unique<MatchingEngine>();
+    a->registerSymbol("MIGR_BUSY");
+    EngineRouter::instance().bindSymbolToEngine("MIGR_BUSY", a.get());
+    b->startEngine();
+    c->startEngine();
+
+    // a is not running, so its fence waits and the first handover stays pending.
+    EXPECT_FALSE(migrateSymbol("MIGR_BUSY", *a, *b, std::chrono::milliseconds(10)));
+    EXPECT_FALSE(migrateSymbol("MIGR_BUSY", *a, *c, std::chrono::milliseconds(10)));
+    EXPECT_EQ(EngineRouter::instance().route("MIGR_BUSY"), b.get());
+    // The rejected attempt left no reservation behind on c.
+    EXPECT_TRUE(c->expectIncoming("MIGR_BUSY"));
+    c->cancelIncoming("MIGR_BUSY");
+
+    a->startEngine();
+    DispatchMsg order;
+    order.type = MsgType::NEW_ORDER;
+    order.symbol = "MIGR_BUSY";
+    order.side = Side::BUY;
+    order.price = 100.0;
+    order.qty = 1;
+    ASSERT_TRUE(b->pushInbound(std::move(order)));
+    bool acked = false;
+    DispatchMsg out;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!acked && std::chrono::steady_clock::now() < deadline) {
+        while (b->popOutbound(out)) acked |= out.type == MsgType::ACK;
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(acked);
+
+    a->stopEngine();
+    b->stopEngine();
+    c->stopEngine();
+}
+
+TEST(SymbolMigrationTest, HandsOverWhileProducerKeepsQueueFull) {
+    auto a = std::make_unique<MatchingEngine>(64, 4096);
+    auto b = std::make_unique<MatchingEngine>();
+    a->registerSymbol("MIGR_FULL");
+    a->registerSymbol("MIGR_FLOOD");
+    EngineRouter::instance().bindSymbolToEngine("MIGR_FULL", a.get());
+
+    // A producer that ignores inboundCongested(): every command applied
+    // puts another one back, so a's queue never runs dry.
+    std::atomic<bool> flooding{true};
+    auto flood = [&] {
+        DispatchMsg m;
+        m.type = MsgType::CANCEL_ORDER;
+        m.symbol = "MIGR_FLOOD";
+        m.orderId = 1;
+        return a->pushInbound(std::move(m));
+    };
+    a->setCommandSink([&](uint64_t, const DispatchMsg&) {
+        if (flooding.load(std::memory_order_relaxed)) flood();
+    });
+    while (flood()) {}
+    a->startEngine();
+    b->startEngine();
+
+    EXPECT_TRUE(migrateSymbol("MIGR_FULL", *a, *b, std::chrono::seconds(10)));
+    flooding = false;
+
+    DispatchMsg order;
+    order.type = MsgType::NEW_ORDER;
+    order.symbol = "MIGR_FULL";
+    order.side = Side::BUY;
+    order.price = 100.0;
+    order.qty = 1;
+    ASSERT_TRUE(b->pushInbound(std::move(order)));
+    bool acked = false;
+    DispatchMsg out;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!acked && std::chrono::steady_clock::now() < deadline) {
+        while (b->popOutbound(out)) acked |= out.type == MsgType::ACK;
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(acked);
+
+    a->stopEngine();
+    b->stopEngine();
+}
+
+TEST(LoadMonitorTest, IdleEnginesProduceNoSuggestion) {
+    auto a = std::make_unique<MatchingEngine>();
+    auto b = std::make_unique<MatchingEngine>();
+    a->registerSymbol("LM_A");
+    a->registerSymbol("LM_B");
+    LoadMonitor monitor({a.get(), b.get()});
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_FALSE(monitor.sample().has_value());
+    ASSERT_EQ(monitor.utilization().size(), 2u);
+}
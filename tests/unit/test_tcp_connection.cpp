@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "net/tcp_connection.h"
+#include "utils/binary_protocol.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+
+using namespace net;
+using namespace dispatch;
+
+namespace {
+
+struct SocketPair {
+    SocketPair() { ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds); }
+    ~SocketPair() { if (fds[1] >= 0) ::close(fds[1]); }
+    void write(const std::string& data) { ::send(fds[1], data.data(), data.size(), 0); }
+    void closePeer() { ::close(fds[1]); fds[1] = -1; }
+    int fds[2] = {-1, -1};
+};
+
+std::vector<std::string> drain(TcpConnection& conn, bool* ok = nullptr) {
+    std::vector<std::string> out;
+    bool res = conn.drainFrames([&](const std::vector<std::string_view>& frames) {
+        for (auto f : frames) out.emplace_back(f);
+        return frames.size();
+    });
+    if (ok) *ok = res;
+    return out;
+}
+
+}
+
+TEST(TcpConnectionTest, SplitsPipelinedJsonLines) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0]);
+
+    sp.write("{\"a\":1}\n{\"b\":2}\r\n\n{\"c\"");
+    ASSERT_TRUE(conn.fillRecvRing());
+    conn.detectProtocol();
+    ASSERT_EQ(conn.protocol(), WireProtocol::JSON);
+
+    auto frames = drain(conn);
+    ASSERT_EQ(frames.size(), 2u);
+    EXPECT_EQ(frames[0], "{\"a\":1}");
+    EXPECT_EQ(frames[1], "{\"b\":2}");
+
+    sp.write(":3}\n");
+    ASSERT_TRUE(conn.fillRecvRing());
+    frames = drain(conn);
+    ASSERT_EQ(frames.size(), 1u);
+    EXPECT_EQ(frames[0], "{\"c\":3}");
+
+    sp.closePeer();
+    EXPECT_FALSE(conn.fillRecvRing());
+}
+
+TEST(TcpConnectionTest, ReassemblesBinaryFramesAcrossWrap) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0], 256);
+
+    DispatchMsg order;
+    order.type   = MsgType::NEW_ORDER;
+    order.symbol = "BYD";
+    char frame[utils::BIN_MAX_FRAME];
+
+    // Enough rounds that frames straddle the end of the 256-byte ring.
+    for (uint32_t round = 0; round < 40; ++round) {
+        std::string stream;
+        for (uint32_t i = 0; i < 3; ++i) {
+            order.qty = round * 3 + i + 1;
+            stream.append(frame, utils::encodeBinaryOrder(order, frame, sizeof(frame)));
+        }
+        sp.write(stream.substr(0, 50));
+        ASSERT_TRUE(conn.fillRecvRing());
+        conn.detectProtocol();
+        ASSERT_EQ(conn.protocol(), WireProtocol::BINARY);
+        auto first = drain(conn);
+
+        sp.write(stream.substr(50));
+        ASSERT_TRUE(conn.fillRecvRing());
+        auto rest = drain(conn);
+
+        first.insert(first.end(), rest.begin(), rest.end());
+        ASSERT_EQ(first.size(), 3u) << "round " << round;
+        for (uint32_t i = 0; i < 3; ++i) {
+            DispatchMsg msg;
+            ASSERT_TRUE(utils::decodeBinaryOrder(first[i].data(), first[i].size(), msg));
+            EXPECT_EQ(msg.qty, round * 3 + i + 1);
+        }
+    }
+}
+
+TEST(TcpConnectionTest, RejectsUnframeableInput) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0], 64);
+    sp.write(std::string(100, 'x'));
+    ASSERT_TRUE(conn.fillRecvRing());
+    conn.detectProtocol();
+
+    bool ok = true;
+    EXPECT_TRUE(drain(conn, &ok).empty());
+    EXPECT_FALSE(ok);
+}
+
+TEST(TcpConnectionTest, BufferedSendFinishesAfterEagain) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0]);
+    std::vector<bool> wantWrite;
+    auto onWant = [&](uint32_t events) { wantWrite.push_back(events & EPOLLOUT); };
+
+    const std::string report(1000, 'r');
+    size_t total = 0;
+    TcpConnection::FlushResult res = TcpConnection::FlushResult::DONE;
+    while (res != TcpConnection::FlushResult::PENDING && total < (8u << 20)) {
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ(conn.queueSend(report.data(), report.size()), TcpConnection::SendResult::QUEUED);
+            total += report.size();
+        }
+        res = conn.flush(onWant);
+    }
+    ASSERT_EQ(res, TcpConnection::FlushResult::PENDING);
+    ASSERT_EQ(wantWrite, std::vector<bool>{true});
+    EXPECT_GT(conn.pendingSendBytes(), 0u);
+
+    size_t received = 0;
+    char buf[65536];
+    while (received < total) {
+        ssize_t n = ::recv(sp.fds[1], buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            received += static_cast<size_t>(n);
+            continue;
+        }
+        conn.flush(onWant);
+    }
+    EXPECT_EQ(received, total);
+    EXPECT_EQ(conn.pendingSendBytes(), 0u);
+    EXPECT_EQ(wantWrite, (std::vector<bool>{true, false}));
+}
+
+TEST(TcpConnectionTest, UntakenFramesStayForNextDrain) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0]);
+
+    sp.write("{\"a\":1}\n{\"b\":2}\n{\"c\":3}\n");
+    ASSERT_TRUE(conn.fillRecvRing());
+    conn.detectProtocol();
+
+    std::vector<std::string> seen;
+    ASSERT_TRUE(conn.drainFrames([&](const std::vector<std::string_view>& frames) {
+        seen.emplace_back(frames[0]);
+        return size_t{1};
+    }));
+    EXPECT_EQ(seen, std::vector<std::string>{"{\"a\":1}"});
+    EXPECT_EQ(drain(conn), (std::vector<std::string>{"{\"b\":2}", "{\"c\":3}"}));
+}
+
+TEST(TcpConnectionTest, PauseDropsReadInterest) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0]);
+    std::vector<uint32_t> applied;
+    auto apply = [&](uint32_t events) { applied.push_back(events); };
+
+    EXPECT_EQ(conn.interest(), static_cast<uint32_t>(EPOLLIN | EPOLLET));
+    EXPECT_TRUE(conn.pauseReading(apply));
+    EXPECT_FALSE(conn.pauseReading(apply));
+    EXPECT_TRUE(conn.readPaused());
+    EXPECT_TRUE(conn.resumeReading(apply));
+    EXPECT_FALSE(conn.resumeReading(apply));
+    EXPECT_EQ(applied, (std::vector<uint32_t>{EPOLLET, EPOLLIN | EPOLLET}));
+}
+
+TEST(TcpConnectionTest, SlowConsumerLimits) {
+    SocketPair sp;
+    TcpConnection conn(sp.fds[0]);
+    conn.setSendLimits(4096, 8192);
+
+    std::string chunk(3000, 'm');
+    EXPECT_EQ(conn.queueSend(chunk.data(), chunk.size(), true), TcpConnection::SendResult::QUEUED);
+    EXPECT_EQ(conn.queueSend(chunk.data(), chunk.size(), true), TcpConnection::SendResult::DROPPED);
+    EXPECT_EQ(conn.queueSend(chunk.data(), chunk.size()), TcpConnection::SendResult::QUEUED);
+    EXPECT_EQ(conn.queueSend(chunk.data(), chunk.size()), TcpConnection::SendResult::OVERFLOW);
+    EXPECT_EQ(conn.queueSend(chunk.data(), chunk.size()), TcpConnection::SendResult::CLOSED);
+    EXPECT_EQ(conn.pendingSendBytes(), 0u);
+
+    char buf[16];
+    EXPECT_EQ(::recv(sp.fds[1], buf, sizeof(buf), 0), 0);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "utils/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace utils;
+
+TEST(ThreadPoolTest, RunsSubmittedTasks) {
+    ThreadPool pool(4);
+    pool.startWorkers();
+    std::atomic<int> done{0};
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(pool.submitTask([&] { done++; }));
+    }
+    pool.shutdown();
+    EXPECT_EQ(done.load(), 1000);
+}
+
+TEST(ThreadPoolTest, SameKeyRunsInOrderOnOneWorker) {
+    constexpr int kKeys = 8;
+    constexpr int kTasks = 2000;
+    ThreadPool pool(4);
+    pool.startWorkers();
+
+    std::vector<std::vector<int>> seen(kKeys);
+    std::vector<std::thread::id> owner(kKeys);
+    std::vector<std::mutex> mtx(kKeys);
+    std::atomic<int> migrated{0};
+
+    for (int i = 0; i < kTasks; ++i) {
+        size_t key = i % kKeys;
+        pool.submitTask(key, [&, key, i] {
+            std::lock_guard<std::mutex> lock(mtx[key]);
+            if (seen[key].empty()) owner[key] = std::this_thread::get_id();
+            else if (owner[key] != std::this_thread::get_id()) migrated++;
+            seen[key].push_back(i);
+        });
+    }
+    pool.shutdown();
+
+    EXPECT_EQ(migrated.load(), 0);
+    for (int k = 0; k < kKeys; ++k) {
+        ASSERT_EQ(seen[k].size(), size_t(kTasks / kKeys));
+        for (size_t j = 1; j < seen[k].size(); ++j) EXPECT_LT(seen[k][j - 1], seen[k][j]);
+    }
+}
+
+TEST(ThreadPoolTest, RejectsAfterShutdown) {
+    ThreadPool pool(2);
+    pool.startWorkers();
+    pool.shutdown();
+    EXPECT_FALSE(pool.submitTask([] {}));
+}
+
+TEST(ThreadPoolTest, IdleWorkerStealsFromBusyOne) {
+    constexpr int kTasks = 100;
+    ThreadPool pool(2);
+    pool.startWorkers();
+
+    std::atomic<int> done{0};
+    std::atomic<bool> sawAll{false};
+    // The first task holds its worker until every other task has run,
+    // including those queued behind it on that worker.
+    pool.submitTask([&] {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (done.load() < kTasks && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        sawAll = done.load() == kTasks;
+    });
+    for (int i = 0; i < kTasks; ++i) pool.submitTask([&] { done++; });
+    pool.shutdown();
+
+    EXPECT_TRUE(sawAll.load());
+    EXPECT_GT(pool.stolenTasks(), 0u);
+}
+
+TEST(ThreadPoolTest, WorkerOverfillingItsOwnQueueSpillsInOrder) {
+    constexpr int kTasks = 100;
+    ThreadPool pool(1, 8);
+    pool.startWorkers();
+
+    // Only the submitting worker can drain its pinned queue; waiting for
+    // room there would never end.
+    std::vector<int> seen;
+    std::atomic<bool> submitted{false};
+    pool.submitTask(0, [&] {
+        for (int i = 0; i < kTasks; ++i) pool.submitTask(0, [&, i] { seen.push_back(i); });
+        submitted = true;
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!submitted.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(submitted.load());
+    pool.shutdown();
+
+    ASSERT_EQ(seen.size(), static_cast<size_t>(kTasks));
+    for (int i = 0; i < kTasks; ++i) EXPECT_EQ(seen[i], i);
+    EXPECT_GT(pool.spilledTasks(), 0u);
+}
+
+TEST(TaskTest, StoresSmallCallablesInlineAndLargeOnHeap) {
+    struct Big { char pad[128]; };
+    auto small = [p = std::make_shared<int>(1)] { ++*p; };
+    auto large = [b = Big{}] { (void)b; };
+    EXPECT_TRUE(Task::fitsInline<decltype(small)>());
+    EXPECT_FALSE(Task::fitsInline<decltype(large)>());
+
+    int runs = 0;
+    Task t([&runs, big = Big{}] { (void)big; ++runs; });
+    Task moved(std::move(t));
+    EXPECT_FALSE(t);
+    moved();
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(TaskTest, AcceptsMoveOnlyCapturesAndReleasesThem) {
+    auto owned = std::make_shared<int>(7);
+    std::weak_ptr<int> watch = owned;
+    int seen = 0;
+    Task t([&seen, p = std::make_unique<std::shared_ptr<int>>(std::move(owned))] { seen = **p; });
+    Task other;
+    other = std::move(t);
+    other();
+    EXPECT_EQ(seen, 7);
+    EXPECT_FALSE(watch.expired());
+    other.reset();
+    EXPECT_TRUE(watch.expired());
+}